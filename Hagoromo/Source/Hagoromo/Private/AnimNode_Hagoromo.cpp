@@ -8,6 +8,8 @@
 #include "HGMPhysics.h"
 #include "HGMCollision.h"
 #include "HGMAnimation.h"
+#include "HGMSolverData.h"
+#include "HGMDistanceFieldData.h"
 
 #include "AnimationRuntime.h"
 #include "Animation/AnimInstanceProxy.h"
@@ -16,6 +18,8 @@
 #include "Algo/Reverse.h"
 #include "PhysicsEngine/PhysicsAsset.h"
 #include "PhysicsEngine/SkeletalBodySetup.h"
+#include "UObject/GarbageCollection.h"
+#include <atomic>
 
 
 #pragma region Internal
@@ -36,13 +40,64 @@ namespace AnimNodeHagoromoInternal
 	static TAutoConsoleVariable<int32> CVarShowVelocities(TEXT("p.Hagoromo.ShowVelocities"), 0, TEXT("Show velocities.\n"));
 	static TAutoConsoleVariable<int32> CVarShowRelativeLimitAngleConstraint(TEXT("p.Hagoromo.ShowRelativeLimitAngleConstraint"), 0, TEXT("Show relative limit angle constraint.\n"));
 
-	static void Initialize(FAnimNode_Hagoromo* AnimNodeHagoromo, const FBoneContainer& BoneContainer)
+	static TAutoConsoleVariable<int32> CVarInitializationMode(TEXT("p.Hagoromo.InitializationMode"), 1, TEXT("0: Initialize solver synchronously. 1: Build solver on background task. 2: Initialize synchronously, limiting number of nodes initialized per frame by p.Hagoromo.InitializationBudgetMs.\n"));
+	static TAutoConsoleVariable<float> CVarInitializationBudgetMs(TEXT("p.Hagoromo.InitializationBudgetMs"), 1.0f, TEXT("Nodes start initializing in p.Hagoromo.InitializationMode 2 while all nodes have spent less than this time in current frame.\nInitialization of single node is not split, so one node may exceed it.\n"));
+	static TAutoConsoleVariable<float> CVarInitializationFadeInTime(TEXT("p.Hagoromo.InitializationFadeInTime"), 0.2f, TEXT("Seconds to fade in physics after deferred initialization.\n"));
+
+	// Time spent by time-sliced initialization of all nodes in current frame.
+	static std::atomic<uint64> InitializationBudgetFrame { 0 };
+	static std::atomic<uint64> InitializationSpentCycles { 0 };
+
+
+	// Budget limits number of nodes initialized per frame. Single initialization is not split across frames,
+	// and at least one node initializes per frame, so nodes always progress even if single initialization exceeds budget.
+	static bool HasInitializationBudget()
+	{
+		const uint64 FrameCounter = GFrameCounter;
+		if (InitializationBudgetFrame.exchange(FrameCounter) != FrameCounter)
+		{
+			InitializationSpentCycles = 0;
+		}
+
+		return FPlatformTime::ToMilliseconds64(InitializationSpentCycles.load()) < CVarInitializationBudgetMs.GetValueOnAnyThread();
+	}
+
+
+	static bool AreSettingsIdentical(const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings, const UHagoromoSolverData& SolverData)
+	{
+		if (ChainSettings.Num() != SolverData.ChainSettings.Num() || !FHGMPhysicsSettings::StaticStruct()->CompareScriptStruct(&PhysicsSettings, &SolverData.PhysicsSettings, PPF_None))
+		{
+			return false;
+		}
+
+		for (int32 ChainIndex = 0; ChainIndex < ChainSettings.Num(); ++ChainIndex)
+		{
+			if (!FHGMChainSetting::StaticStruct()->CompareScriptStruct(&ChainSettings[ChainIndex], &SolverData.ChainSettings[ChainIndex], PPF_None))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	// SolverTemplate is result of background task. When it is not given, template is found or built here.
+	static void Initialize(FAnimNode_Hagoromo* AnimNodeHagoromo, const FBoneContainer& BoneContainer, const TSharedPtr<const FHGMSolverTemplate>& SolverTemplate = nullptr)
 	{
 		AnimNodeHagoromo->PhysicsContext.bIsFirstUpdate = true;
 
-		AnimNodeHagoromo->Solver->Initialize(BoneContainer, AnimNodeHagoromo->ChainSettings, AnimNodeHagoromo->PhysicsSettings, AnimNodeHagoromo->PhysicsContext);
+		if (SolverTemplate.IsValid())
+		{
+			AnimNodeHagoromo->Solver->InitializeWithTemplate(BoneContainer, SolverTemplate, AnimNodeHagoromo->PhysicsSettings, AnimNodeHagoromo->PhysicsContext);
+		}
+		else
+		{
+			const TSharedPtr<const FHGMSolverTemplate> CookedTemplate = AnimNodeHagoromo->SolverData ? AnimNodeHagoromo->SolverData->GetSolverTemplate() : nullptr;
+			AnimNodeHagoromo->Solver->Initialize(BoneContainer, AnimNodeHagoromo->ChainSettings, AnimNodeHagoromo->PhysicsSettings, AnimNodeHagoromo->PhysicsContext, CookedTemplate);
+		}
 
-		FHGMCollisionLibrary::InitializeBodyColliderFromPhysicsAsset(BoneContainer, AnimNodeHagoromo->PhysicsAssetForBodyCollider, AnimNodeHagoromo->BodyCollider);
+		FHGMCollisionLibrary::InitializeBodyColliderFromPhysicsAsset(BoneContainer, AnimNodeHagoromo->PhysicsAssetForBodyCollider, AnimNodeHagoromo->DistanceFieldForBodyCollider, AnimNodeHagoromo->BodyCollider);
 
 		if (AnimNodeHagoromo->AdditionalColliderSettings.PlaneColliders.Num() > 0)
 		{
@@ -73,12 +128,39 @@ void FAnimNode_Hagoromo::Initialize_AnyThread(const FAnimationInitializeContext&
 		bShouldInitialize = true;
 		PhysicsContext.bIsFirstUpdate = true;
 	}
+
+	// Solver data is single source of settings, so that settings of node can not drift from cooked template.
+	// Node settings are reported when they differ, e.g. they were edited before solver data was set.
+	if (SolverData)
+	{
+		if (!AnimNodeHagoromoInternal::AreSettingsIdentical(ChainSettings, PhysicsSettings, *SolverData))
+		{
+			HGM_LOG(Warning, TEXT("Chain settings and physics settings of node differ from solver data %s and are replaced with those of solver data."), *SolverData->GetPathName());
+			ChainSettings = SolverData->ChainSettings;
+			PhysicsSettings = SolverData->PhysicsSettings;
+		}
+	}
 }
 
 
 void FAnimNode_Hagoromo::CacheBones_AnyThread(const FAnimationCacheBonesContext& Context)
 {
 	Super::CacheBones_AnyThread(Context);
+
+	// Required bones change by LOD. Solver only remaps bones, so simulation continues without reinitialization.
+	if (!Solver || !Solver->HasInitialized())
+	{
+		return;
+	}
+
+	const FBoneContainer& RequiredBones = Context.AnimInstanceProxy->GetRequiredBones();
+	Solver->UpdateRequiredBones(RequiredBones, PhysicsContext);
+	FHGMCollisionLibrary::UpdateBodyColliderRequiredBones(RequiredBones, BodyCollider);
+
+	if (AdditionalColliderSettings.PlaneColliders.Num() > 0)
+	{
+		FHGMCollisionLibrary::InitializePlaneColliders(RequiredBones, AdditionalColliderSettings.PlaneColliders, PlaneColliders);
+	}
 }
 
 
@@ -87,18 +169,16 @@ void FAnimNode_Hagoromo::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCo
 	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(EvaluateSkeletalControl_AnyThread)
 	ANIM_MT_SCOPE_CYCLE_COUNTER_VERBOSE(Hagoromo, !IsInGameThread());
 
-	const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
-
 	if (!Solver)
 	{
 		HGM_LOG(Error, TEXT("Solver was nullptr."));
 		return;
 	}
 
-	if (bShouldInitialize)
+	// Animation pose passes through while initialization is deferred.
+	if (!UpdateInitialization(Output))
 	{
-		AnimNodeHagoromoInternal::Initialize(this, BoneContainer);
-		bShouldInitialize = false;
+		return;
 	}
 
 	if (!Solver->HasInitialized())
@@ -107,6 +187,12 @@ void FAnimNode_Hagoromo::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCo
 		return;
 	}
 
+	if (PhysicsContext.FadeInAlpha < 1.0)
+	{
+		const FHGMReal FadeInTime = AnimNodeHagoromoInternal::CVarInitializationFadeInTime.GetValueOnAnyThread();
+		PhysicsContext.FadeInAlpha = FadeInTime > 0.0 ? FMath::Min<FHGMReal>(PhysicsContext.FadeInAlpha + Output.AnimInstanceProxy->GetDeltaSeconds() / FadeInTime, 1.0) : 1.0;
+	}
+
 	FHGMCollisionLibrary::UpdateBodyCollider(Output, PhysicsContext, BodyCollider, PrevBodyCollider);
 
 	if (AdditionalColliderSettings.PlaneColliders.Num() > 0)
@@ -116,7 +202,7 @@ void FAnimNode_Hagoromo::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCo
 
 	Solver->PreSimulate(Output, PhysicsSettings, PhysicsContext, AnimationCurveNumber);
 
-	Solver->Simulate(Output, PhysicsContext, BodyCollider, PrevBodyCollider, PlaneColliders);
+	Solver->Simulate(Output, PhysicsContext, BodyCollider, PlaneColliders);
 
 	Solver->OutputSimulateResult(PhysicsContext, Output, OutBoneTransforms);
 
@@ -128,6 +214,105 @@ void FAnimNode_Hagoromo::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCo
 }
 
 
+bool FAnimNode_Hagoromo::UpdateInitialization(FComponentSpacePoseContext& Output)
+{
+	const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
+
+	// Result of task launched before reinitialization was requested is stale, so it is discarded and task is launched again.
+	// Task does not touch node, so it is left to complete on its own.
+	if (SolverTemplateTask.IsValid() && bShouldInitialize)
+	{
+		SolverTemplateTask = {};
+	}
+
+	// Hand template built on background task to solver.
+	if (SolverTemplateTask.IsValid())
+	{
+		if (!SolverTemplateTask.IsCompleted())
+		{
+			return false;
+		}
+
+		const TSharedPtr<const FHGMSolverTemplate> SolverTemplate = SolverTemplateTask.GetResult();
+		SolverTemplateTask = {};
+
+		if (!SolverTemplate.IsValid())
+		{
+			HGM_LOG(Error, TEXT("Solver template could not be built."));
+			return false;
+		}
+
+		// Mesh or settings may be changed while task was running. ( e.g. Reimport of mesh )
+		if (SolverTemplate->Key != FHGMSolverTemplate::MakeKey(BoneContainer, ChainSettings, PhysicsSettings))
+		{
+			bShouldInitialize = true;
+			return false;
+		}
+
+		AnimNodeHagoromoInternal::Initialize(this, BoneContainer, SolverTemplate);
+		PhysicsContext.FadeInAlpha = 0.0;
+		return true;
+	}
+
+	if (!bShouldInitialize)
+	{
+		return true;
+	}
+
+	const int32 InitializationMode = AnimNodeHagoromoInternal::CVarInitializationMode.GetValueOnAnyThread();
+	const bool bHasCookedTemplate = SolverData && SolverData->GetSolverTemplate().IsValid();
+
+	// Cooked template needs no building, so it is always initialized immediately.
+	if (InitializationMode == 1 && !bHasCookedTemplate)
+	{
+		bShouldInitialize = false;
+
+		// Key and reference skeleton cache read UObject, so they are resolved here instead of on task.
+		// Settings are copied so that task does not touch node, which may be destroyed before task completes.
+		const uint64 Key = FHGMSolverTemplate::MakeKey(BoneContainer, ChainSettings, PhysicsSettings);
+		TSharedPtr<const FHGMReferenceSkeletonCache> RefSkeletonCache = FHGMAnimationLibrary::FindOrCreateReferenceSkeletonCache(BoneContainer);
+		SolverTemplateTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [BoneContainer, Key, RefSkeletonCache = MoveTemp(RefSkeletonCache), ChainSettings = ChainSettings, PhysicsSettings = PhysicsSettings]()
+		{
+			// Reference skeleton is owned by mesh, so mesh must not be collected while chains are gathered from it.
+			// Rest of building reads only gathered chains, so garbage collection is not blocked meanwhile.
+			FHGMGatheredChains GatheredChains {};
+			{
+				FGCScopeGuard GCScopeGuard {};
+				if (!BoneContainer.GetAsset() || !FHGMSolverTemplate::GatherChains(BoneContainer, *RefSkeletonCache, ChainSettings, GatheredChains))
+				{
+					return TSharedPtr<const FHGMSolverTemplate>();
+				}
+			}
+
+			return FHGMSolverTemplate::FindOrCreate(Key, GatheredChains, RefSkeletonCache, ChainSettings, PhysicsSettings);
+		});
+
+		return false;
+	}
+
+	if (InitializationMode == 2 && !bHasCookedTemplate)
+	{
+		if (!AnimNodeHagoromoInternal::HasInitializationBudget())
+		{
+			return false;
+		}
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		AnimNodeHagoromoInternal::Initialize(this, BoneContainer);
+		AnimNodeHagoromoInternal::InitializationSpentCycles += FPlatformTime::Cycles64() - StartCycles;
+
+		bShouldInitialize = false;
+		PhysicsContext.FadeInAlpha = 0.0;
+		return true;
+	}
+
+	AnimNodeHagoromoInternal::Initialize(this, BoneContainer);
+	bShouldInitialize = false;
+
+	return true;
+}
+
+
 bool FAnimNode_Hagoromo::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones)
 {
 	return Solver != nullptr;
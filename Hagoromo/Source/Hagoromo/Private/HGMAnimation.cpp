@@ -1 +1,147 @@
-// Hagoromo : Copyright (c) 2025 nozoxa_0131, MIT License
\ No newline at end of file
+// Hagoromo : Copyright (c) 2025 nozoxa_0131, MIT License
+
+#include "HGMAnimation.h"
+
+#include "Hash/CityHash.h"
+#include "UObject/ObjectKey.h"
+
+
+namespace AnimationInternal
+{
+	// Asset is kept only to remove cache after asset is unloaded or reimported.
+	struct FReferenceSkeletonCacheEntry
+	{
+		TSharedPtr<const FHGMReferenceSkeletonCache> Cache {};
+		TObjectKey<UObject> AssetKey {};
+	};
+
+	// Keyed by content hash, so that reimported skeleton is never matched with cache of previous one.
+	static FCriticalSection ReferenceSkeletonCachesCriticalSection {};
+	static TMap<uint64, FReferenceSkeletonCacheEntry> ReferenceSkeletonCaches {};
+
+
+	template<typename T>
+	FORCEINLINE static uint64 HashValue(const T& Value, uint64 Hash)
+	{
+		return CityHash64WithSeed(reinterpret_cast<const char*>(&Value), sizeof(T), Hash);
+	}
+
+
+	static TSharedPtr<const FHGMReferenceSkeletonCache> BuildReferenceSkeletonCache(const FReferenceSkeleton& RefSkeleton, uint64 RefSkeletonHash)
+	{
+		TSharedPtr<FHGMReferenceSkeletonCache> Cache = MakeShared<FHGMReferenceSkeletonCache>();
+
+		const TArray<FTransform>& RefBonePose = RefSkeleton.GetRefBonePose();
+		const int32 BoneNum = RefSkeleton.GetNum();
+		Cache->RefSkeletonHash = RefSkeletonHash;
+
+		// Count children first so that children of each bone are stored contiguously.
+		Cache->ChildBoneIndexOffsets.Init(0, BoneNum + 1);
+		for (int32 BoneIndex = 0; BoneIndex < BoneNum; ++BoneIndex)
+		{
+			const int32 ParentBoneIndex = RefSkeleton.GetParentIndex(BoneIndex);
+			if (ParentBoneIndex != INDEX_NONE)
+			{
+				++Cache->ChildBoneIndexOffsets[ParentBoneIndex + 1];
+			}
+		}
+
+		for (int32 BoneIndex = 0; BoneIndex < BoneNum; ++BoneIndex)
+		{
+			Cache->ChildBoneIndexOffsets[BoneIndex + 1] += Cache->ChildBoneIndexOffsets[BoneIndex];
+		}
+
+		// Parents always precede children in reference skeleton, so children are appended in ascending order
+		// and component space transform of parent is already available.
+		TArray<int32> ChildBoneCounts {};
+		ChildBoneCounts.Init(0, BoneNum);
+		Cache->ChildBoneIndexes.SetNumUninitialized(Cache->ChildBoneIndexOffsets[BoneNum]);
+		Cache->ComponentSpaceRefTransforms.SetNumUninitialized(BoneNum);
+		for (int32 BoneIndex = 0; BoneIndex < BoneNum; ++BoneIndex)
+		{
+			const int32 ParentBoneIndex = RefSkeleton.GetParentIndex(BoneIndex);
+			if (ParentBoneIndex == INDEX_NONE)
+			{
+				Cache->ComponentSpaceRefTransforms[BoneIndex] = RefBonePose[BoneIndex];
+				continue;
+			}
+
+			Cache->ChildBoneIndexes[Cache->ChildBoneIndexOffsets[ParentBoneIndex] + ChildBoneCounts[ParentBoneIndex]++] = BoneIndex;
+			Cache->ComponentSpaceRefTransforms[BoneIndex] = RefBonePose[BoneIndex] * Cache->ComponentSpaceRefTransforms[ParentBoneIndex];
+		}
+
+		return Cache;
+	}
+}
+
+
+TSharedPtr<const FHGMReferenceSkeletonCache> FHGMAnimationLibrary::FindOrCreateReferenceSkeletonCache(const FBoneContainer& BoneContainer)
+{
+	const FReferenceSkeleton& RefSkeleton = BoneContainer.GetReferenceSkeleton();
+	const uint64 RefSkeletonHash = FHGMAnimationLibrary::HashReferenceSkeleton(RefSkeleton);
+	const TObjectKey<UObject> AssetKey(BoneContainer.GetAsset());
+
+	FScopeLock Lock(&AnimationInternal::ReferenceSkeletonCachesCriticalSection);
+
+	if (const AnimationInternal::FReferenceSkeletonCacheEntry* CachedEntry = AnimationInternal::ReferenceSkeletonCaches.Find(RefSkeletonHash))
+	{
+		return CachedEntry->Cache;
+	}
+
+	// Skeleton of asset was changed by reimport, so cache of previous skeleton is no longer used by the asset.
+	// Note: Only keys are compared here. Objects are not resolved outside game thread.
+	for (auto It = AnimationInternal::ReferenceSkeletonCaches.CreateIterator(); It; ++It)
+	{
+		if (It.Value().AssetKey == AssetKey)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TSharedPtr<const FHGMReferenceSkeletonCache> NewCache = AnimationInternal::BuildReferenceSkeletonCache(RefSkeleton, RefSkeletonHash);
+	AnimationInternal::ReferenceSkeletonCaches.Add(RefSkeletonHash, AnimationInternal::FReferenceSkeletonCacheEntry { NewCache, AssetKey });
+
+	return NewCache;
+}
+
+
+void FHGMAnimationLibrary::PruneReferenceSkeletonCaches()
+{
+	check(IsInGameThread());
+
+	FScopeLock Lock(&AnimationInternal::ReferenceSkeletonCachesCriticalSection);
+
+	for (auto It = AnimationInternal::ReferenceSkeletonCaches.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().AssetKey.ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+
+uint64 FHGMAnimationLibrary::HashReferenceSkeleton(const FReferenceSkeleton& RefSkeleton)
+{
+	const TArray<FMeshBoneInfo>& RefBoneInfos = RefSkeleton.GetRefBoneInfo();
+	const TArray<FTransform>& RefBonePose = RefSkeleton.GetRefBonePose();
+
+	// Name is hashed as string, since index of FName differs per session.
+	uint64 Hash = AnimationInternal::HashValue(RefBoneInfos.Num(), 0);
+	TStringBuilder<FName::StringBufferSize> BoneName {};
+	for (int32 BoneIndex = 0; BoneIndex < RefBoneInfos.Num(); ++BoneIndex)
+	{
+		const FMeshBoneInfo& RefBoneInfo = RefBoneInfos[BoneIndex];
+		BoneName.Reset();
+		RefBoneInfo.Name.AppendString(BoneName);
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(BoneName.ToString()), BoneName.Len() * sizeof(TCHAR), Hash);
+		Hash = AnimationInternal::HashValue(RefBoneInfo.ParentIndex, Hash);
+
+		const FTransform& RefBoneTransform = RefBonePose[BoneIndex];
+		Hash = AnimationInternal::HashValue(RefBoneTransform.GetTranslation(), Hash);
+		Hash = AnimationInternal::HashValue(RefBoneTransform.GetRotation(), Hash);
+		Hash = AnimationInternal::HashValue(RefBoneTransform.GetScale3D(), Hash);
+	}
+
+	return Hash;
+}
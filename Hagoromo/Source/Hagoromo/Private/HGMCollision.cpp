@@ -5,6 +5,8 @@
 #include "HGMMath.h"
 #include "HGMDebug.h"
 #include "HGMSolvers.h"
+#include "HGMConstraints.h"
+#include "HGMDistanceFieldData.h"
 
 #include "PhysicsEngine/PhysicsAsset.h"
 #include "PhysicsEngine/SkeletalBodySetup.h"
@@ -223,8 +225,9 @@ namespace
 	/**
 	* Collision detection between static sphere and capsule.
 	* OutColliderContact contains parameters to separate sSphere from sCapsule.
+	* Contact is also made within sContactMargin from surface and is returned as mask, while sHitMask is set only for penetrating components.
 	*/
-	FHGMSIMDReal IntersectStaticSphereCapsule(const FHGMSIMDSphereCollider& sSphere, const FHGMSIMDCapsuleCollider& sCapsule, FHGMSIMDColliderContact& sOutColliderContact)
+	FHGMSIMDReal IntersectStaticSphereCapsule(const FHGMSIMDSphereCollider& sSphere, const FHGMSIMDCapsuleCollider& sCapsule, const FHGMSIMDReal& sContactMargin, FHGMSIMDColliderContact& sOutColliderContact)
 	{
 		// Converted "ゲームプログラミングのためのリアルタイム衝突判定 > P115" to SIMD.
 		FHGMSIMDReal sT {};
@@ -232,16 +235,18 @@ namespace
 		const FHGMSIMDReal sDistanceSquared = ClosestPointPointSegment(sSphere.sCenter, sCapsule.sStartPoint, sCapsule.sEndPoint, sT, sProjectedPoint);
 		const FHGMSIMDReal sSumRadius = sSphere.sRadius + sCapsule.sRadius;
 		const FHGMSIMDReal sSumRadiusSquared = sSumRadius * sSumRadius;
+		const FHGMSIMDReal sContactRadius = sSumRadius + sContactMargin;
 		const FHGMSIMDReal sHitMask = sDistanceSquared < sSumRadiusSquared;
+		const FHGMSIMDReal sContactMask = sDistanceSquared < sContactRadius * sContactRadius;
 
-		sOutColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sHitMask, FHGMMathLibrary::MakeSafeNormal(sSphere.sCenter - sProjectedPoint), FHGMSIMDVector3::ZeroVector);
+		sOutColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sContactMask, FHGMMathLibrary::MakeSafeNormal(sSphere.sCenter - sProjectedPoint), FHGMSIMDVector3::ZeroVector);
 
 		const FHGMSIMDVector3 sSeparatedPosition = sProjectedPoint + (sSumRadius * sOutColliderContact.sSeparatingNormal);
 		sOutColliderContact.sSeparatingOffset = FHGMMathLibrary::DotProduct(sOutColliderContact.sSeparatingNormal, sSeparatedPosition);
 
 		sOutColliderContact.sHitMask = sHitMask;
 
-		return sHitMask;
+		return sContactMask;
 	}
 
 
@@ -274,16 +279,19 @@ namespace
 	* Collision detection between sphere and capsule.
 	* OutColliderContact contains parameters to separate sSphere from sCapsule.
 	*/
-	bool IntersectSphereCapsule(const FHGMSIMDSphereCollider& sSphere, const FHGMSIMDSphereCollider& sPrevSphere, const FHGMSIMDCapsuleCollider& sCapsule, const FHGMSIMDCapsuleCollider& sPrevCapsule, FHGMSIMDColliderContact& sOutColliderContact)
+	bool IntersectSphereCapsule(const FHGMSIMDSphereCollider& sSphere, const FHGMSIMDSphereCollider& sPrevSphere, const FHGMSIMDCapsuleCollider& sCapsule, const FHGMSIMDCapsuleCollider& sPrevCapsule, const FHGMSIMDReal& sContactMargin, FHGMSIMDColliderContact& sOutColliderContact)
 	{
 		FHGMSIMDReal sHitMask = ~HGMSIMDConstants::AllBitMask;
-		sOutColliderContact.sSeparatingNormal = FHGMSIMDVector3::ZeroVector;
-		sOutColliderContact.sSeparatingOffset = HGMSIMDConstants::ZeroReal;
 
 		FHGMSIMDColliderContact sStaticContact {};
-		const FHGMSIMDReal sStaticHitMask = IntersectStaticSphereCapsule(sSphere, sCapsule, sStaticContact);
+		const FHGMSIMDReal sStaticContactMask = IntersectStaticSphereCapsule(sSphere, sCapsule, sContactMargin, sStaticContact);
+		const FHGMSIMDReal sStaticHitMask = sStaticContact.sHitMask;
 		sHitMask |= sStaticHitMask;
 
+		// Contacts within margin are overridden by swept hit, so that sphere passed through capsule is pushed back to side it came from.
+		sOutColliderContact.sSeparatingNormal = sStaticContact.sSeparatingNormal;
+		sOutColliderContact.sSeparatingOffset = sStaticContact.sSeparatingOffset;
+
 		const FHGMSIMDVector3 sSphereVelocity = sSphere.sCenter - sPrevSphere.sCenter;
 		const FHGMSIMDVector3 sCapsuleCenter(FHGMMathLibrary::Lerp(sCapsule.sStartPoint, sCapsule.sEndPoint, HGMSIMDConstants::OneHalfReal));
 		const FHGMSIMDVector3 sPrevCapsuleCenter(FHGMMathLibrary::Lerp(sPrevCapsule.sStartPoint, sPrevCapsule.sEndPoint, HGMSIMDConstants::OneHalfReal));
@@ -300,31 +308,34 @@ namespace
 
 		sOutColliderContact.sHitMask = sHitMask;
 
-		return FHGMSIMDLibrary::IsAnyMaskSet(sHitMask);
+		return FHGMSIMDLibrary::IsAnyMaskSet(sHitMask | sStaticContactMask);
 	}
 
 
 	/**
 	 * Collision detection between stopped spheres.
 	 * OutColliderContact contains parameters to separate sSphereA from sSphereB.
+	 * Contact is also made within sContactMargin from surface and is returned as mask, while sHitMask is set only for penetrating components.
 	 */
-	FHGMSIMDReal IntersectStaticSphereSphere(const FHGMSIMDSphereCollider& sSphereA, const FHGMSIMDSphereCollider& sSphereB, FHGMSIMDColliderContact& sOutColliderContact)
+	FHGMSIMDReal IntersectStaticSphereSphere(const FHGMSIMDSphereCollider& sSphereA, const FHGMSIMDSphereCollider& sSphereB, const FHGMSIMDReal& sContactMargin, FHGMSIMDColliderContact& sOutColliderContact)
 	{
 		const FHGMSIMDVector3 sDistanceVector = sSphereA.sCenter - sSphereB.sCenter;
 		const FHGMSIMDReal sDistanceSquared = FHGMMathLibrary::LengthSquared(sDistanceVector);
 		const FHGMSIMDReal sRadiusSummed = sSphereA.sRadius + sSphereB.sRadius;
 		const FHGMSIMDReal sRadiusSummedSquared = sRadiusSummed * sRadiusSummed;
+		const FHGMSIMDReal sContactRadius = sRadiusSummed + sContactMargin;
 
 		const FHGMSIMDReal sHitMask = sDistanceSquared < sRadiusSummedSquared;
+		const FHGMSIMDReal sContactMask = sDistanceSquared < sContactRadius * sContactRadius;
 
 		const FHGMSIMDVector3 sSeparatingNormal = FHGMMathLibrary::MakeSafeNormal(sDistanceVector);
 		const FHGMSIMDVector3 sSeparatedPosition = sSphereB.sCenter + sSeparatingNormal * sRadiusSummed;
 
-		sOutColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sHitMask, sSeparatingNormal, FHGMSIMDVector3::ZeroVector);
+		sOutColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sContactMask, sSeparatingNormal, FHGMSIMDVector3::ZeroVector);
 		sOutColliderContact.sSeparatingOffset = FHGMMathLibrary::DotProduct(sSeparatedPosition, sOutColliderContact.sSeparatingNormal);
 		sOutColliderContact.sHitMask = sHitMask;
 
-		return sHitMask;
+		return sContactMask;
 	}
 
 
@@ -356,16 +367,19 @@ namespace
 	 * Collision detection between spheres.
 	 * OutColliderContact contains parameters to separate sSphereA from sSphereB.
 	 */
-	bool IntersectSphereSphere(const FHGMSIMDSphereCollider& sSphereA, const FHGMSIMDSphereCollider& sPrevSphereA, const FHGMSIMDSphereCollider& sSphereB, const FHGMSIMDSphereCollider& sPrevSphereB, FHGMSIMDColliderContact& sOutColliderContact)
+	bool IntersectSphereSphere(const FHGMSIMDSphereCollider& sSphereA, const FHGMSIMDSphereCollider& sPrevSphereA, const FHGMSIMDSphereCollider& sSphereB, const FHGMSIMDSphereCollider& sPrevSphereB, const FHGMSIMDReal& sContactMargin, FHGMSIMDColliderContact& sOutColliderContact)
 	{
 		FHGMSIMDReal sHitMask = ~HGMSIMDConstants::AllBitMask;
-		sOutColliderContact.sSeparatingNormal = FHGMSIMDVector3::ZeroVector;
-		sOutColliderContact.sSeparatingOffset = HGMSIMDConstants::ZeroReal;
 
 		FHGMSIMDColliderContact sStaticContact {};
-		const FHGMSIMDReal sStaticHitMask = IntersectStaticSphereSphere(sSphereA, sSphereB, sStaticContact);
+		const FHGMSIMDReal sStaticContactMask = IntersectStaticSphereSphere(sSphereA, sSphereB, sContactMargin, sStaticContact);
+		const FHGMSIMDReal sStaticHitMask = sStaticContact.sHitMask;
 		sHitMask |= sStaticHitMask;
 
+		// Contacts within margin are overridden by swept hit, so that sphere passed through sphere is pushed back to side it came from.
+		sOutColliderContact.sSeparatingNormal = sStaticContact.sSeparatingNormal;
+		sOutColliderContact.sSeparatingOffset = sStaticContact.sSeparatingOffset;
+
 		const FHGMSIMDVector3 sVelocityA = sSphereA.sCenter - sPrevSphereA.sCenter;
 		const FHGMSIMDVector3 sVelocityB = sSphereB.sCenter - sPrevSphereB.sCenter;
 		FHGMSIMDColliderContact sDynamicContact {};
@@ -380,7 +394,7 @@ namespace
 
 		sOutColliderContact.sHitMask = sHitMask;
 
-		return FHGMSIMDLibrary::IsAnyMaskSet(sHitMask);
+		return FHGMSIMDLibrary::IsAnyMaskSet(sHitMask | sStaticContactMask);
 	}
 
 
@@ -393,45 +407,152 @@ namespace
 	};
 
 
-	bool IntersectEdgeCapsule(const FHGMSIMDVector3& sEdgeStart, const FHGMSIMDVector3& sEdgeEnd, const FHGMSIMDCapsuleCollider& sCapsule, FHGMSIMDEdgeColliderContact& sOutEdgeColliderContact)
+	bool IntersectEdgeCapsule(const FHGMSIMDVector3& sEdgeStart, const FHGMSIMDVector3& sEdgeEnd, const FHGMSIMDCapsuleCollider& sCapsule, const FHGMSIMDReal& sContactMargin, FHGMSIMDEdgeColliderContact& sOutEdgeColliderContact)
 	{
 		FHGMSIMDReal sT0, sT1 {};
 		FHGMSIMDVector3 sProjectedPoint0, sProjectedPoint1 {};
 		const FHGMSIMDReal sDistanceSquared = ClosestPointSegmentSegment(sEdgeStart, sEdgeEnd, sCapsule.sStartPoint, sCapsule.sEndPoint, sT0, sT1, sProjectedPoint0, sProjectedPoint1);
 		const FHGMSIMDReal sRadiusSquared = sCapsule.sRadius * sCapsule.sRadius;
+		const FHGMSIMDReal sContactRadius = sCapsule.sRadius + sContactMargin;
 		const FHGMSIMDReal sHitMask = sDistanceSquared < sRadiusSquared;
+		const FHGMSIMDReal sContactMask = sDistanceSquared < sContactRadius * sContactRadius;
 
-		sOutEdgeColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sHitMask, FHGMMathLibrary::MakeSafeNormal(sProjectedPoint0 - sProjectedPoint1), FHGMSIMDVector3::ZeroVector);
+		sOutEdgeColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sContactMask, FHGMMathLibrary::MakeSafeNormal(sProjectedPoint0 - sProjectedPoint1), FHGMSIMDVector3::ZeroVector);
 		const FHGMSIMDVector3 sSeparatedPoint = sCapsule.sRadius * sOutEdgeColliderContact.sSeparatingNormal + sProjectedPoint1;
 		const FHGMSIMDReal sSeparatingOffset = FHGMMathLibrary::DotProduct(sSeparatedPoint, sOutEdgeColliderContact.sSeparatingNormal);
 
 		sOutEdgeColliderContact.sEdgeStartSeparatingOffset = sSeparatingOffset;
 		sOutEdgeColliderContact.sEdgeEndSeparatingOffset = sSeparatingOffset;
-		sOutEdgeColliderContact.sHitMask;
+		sOutEdgeColliderContact.sHitMask = sHitMask;
 
-		return FHGMSIMDLibrary::IsAnyMaskSet(sHitMask);
+		return FHGMSIMDLibrary::IsAnyMaskSet(sContactMask);
 	}
 
 
-	bool IntersectEdgeSphere(const FHGMSIMDVector3& sEdgeStart, const FHGMSIMDVector3& sEdgeEnd, const FHGMSIMDSphereCollider& sSphere, FHGMSIMDEdgeColliderContact& sOutEdgeColliderContact)
+	bool IntersectEdgeSphere(const FHGMSIMDVector3& sEdgeStart, const FHGMSIMDVector3& sEdgeEnd, const FHGMSIMDSphereCollider& sSphere, const FHGMSIMDReal& sContactMargin, FHGMSIMDEdgeColliderContact& sOutEdgeColliderContact)
 	{
 		FHGMSIMDReal sT {};
 		FHGMSIMDVector3 sProjectedPoint {};
 		const FHGMSIMDReal sDistanceSquared = ClosestPointPointSegment(sSphere.sCenter, sEdgeStart, sEdgeEnd, sT, sProjectedPoint);
 		const FHGMSIMDReal sRadiusSquared = sSphere.sRadius * sSphere.sRadius;
+		const FHGMSIMDReal sContactRadius = sSphere.sRadius + sContactMargin;
 		const FHGMSIMDReal sHitMask = sDistanceSquared < sRadiusSquared;
+		const FHGMSIMDReal sContactMask = sDistanceSquared < sContactRadius * sContactRadius;
 
-		sOutEdgeColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sHitMask, FHGMMathLibrary::MakeSafeNormal(sProjectedPoint - sSphere.sCenter), FHGMSIMDVector3::ZeroVector);
+		sOutEdgeColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sContactMask, FHGMMathLibrary::MakeSafeNormal(sProjectedPoint - sSphere.sCenter), FHGMSIMDVector3::ZeroVector);
 		const FHGMSIMDVector3 sSeparatedPoint = sSphere.sRadius * sOutEdgeColliderContact.sSeparatingNormal + sSphere.sCenter;
 		sOutEdgeColliderContact.sEdgeStartSeparatingOffset = FHGMMathLibrary::DotProduct(sSeparatedPoint, sOutEdgeColliderContact.sSeparatingNormal);
 		sOutEdgeColliderContact.sEdgeEndSeparatingOffset = FHGMMathLibrary::DotProduct(sSeparatedPoint, sOutEdgeColliderContact.sSeparatingNormal);
 		sOutEdgeColliderContact.sHitMask = sHitMask;
 
-		return FHGMSIMDLibrary::IsAnyMaskSet(sHitMask);
+		return FHGMSIMDLibrary::IsAnyMaskSet(sContactMask);
+	}
+
+
+	/**
+	* Collision detection between sphere and distance field.
+	* Distance and its gradient are trilinearly interpolated from 8 voxels around center of sSphere in bone space.
+	* Contact is also made within sContactMargin from surface, while sHitMask is set only for penetrating components.
+	*/
+	bool IntersectSphereDistanceField(const FHGMSIMDSphereCollider& sSphere, const FHGMSIMDDistanceFieldCollider& sDistanceField, const FHGMSIMDReal& sContactMargin, FHGMSIMDColliderContact& sOutColliderContact)
+	{
+		const FHGMDistanceField& DistanceField = *sDistanceField.DistanceField;
+
+		// Position in voxel units. Components outside of grid have no contact, since grid covers shapes with padding.
+		const FHGMSIMDVector3 sBoneSpaceCenter = FHGMMathLibrary::InverseTransformPosition(sDistanceField.sTransform, sSphere.sCenter);
+		const FHGMSIMDVector3 sGridPosition = (sBoneSpaceCenter - sDistanceField.sOrigin) * sDistanceField.sInverseVoxelSize;
+		const FHGMSIMDReal sInsideMask = (sGridPosition.X >= HGMSIMDConstants::ZeroReal) & (sGridPosition.X <= sDistanceField.sMaxGridPosition.X)
+									   & (sGridPosition.Y >= HGMSIMDConstants::ZeroReal) & (sGridPosition.Y <= sDistanceField.sMaxGridPosition.Y)
+									   & (sGridPosition.Z >= HGMSIMDConstants::ZeroReal) & (sGridPosition.Z <= sDistanceField.sMaxGridPosition.Z);
+		if (!FHGMSIMDLibrary::IsAnyMaskSet(sInsideMask))
+		{
+			return false;
+		}
+
+		FHGMSIMDVector3 sClampedGridPosition {};
+		sClampedGridPosition.X = FHGMMathLibrary::Clamp(sGridPosition.X, HGMSIMDConstants::ZeroReal, sDistanceField.sMaxGridPosition.X);
+		sClampedGridPosition.Y = FHGMMathLibrary::Clamp(sGridPosition.Y, HGMSIMDConstants::ZeroReal, sDistanceField.sMaxGridPosition.Y);
+		sClampedGridPosition.Z = FHGMMathLibrary::Clamp(sGridPosition.Z, HGMSIMDConstants::ZeroReal, sDistanceField.sMaxGridPosition.Z);
+
+		TStaticArray<FHGMReal, 4> GridPositionX {};
+		TStaticArray<FHGMReal, 4> GridPositionY {};
+		TStaticArray<FHGMReal, 4> GridPositionZ {};
+		FHGMSIMDLibrary::Store(sClampedGridPosition.X, GridPositionX);
+		FHGMSIMDLibrary::Store(sClampedGridPosition.Y, GridPositionY);
+		FHGMSIMDLibrary::Store(sClampedGridPosition.Z, GridPositionZ);
+
+		// Voxels differ per component, so only gather is done per component.
+		// Base voxel of cell is clamped so that 8 voxels of cell are always in grid.
+		// Note: Bit 0, 1 and 2 of corner index are offsets in X, Y and Z.
+		const FIntVector& Resolution = DistanceField.Resolution;
+		const int32 StrideY = Resolution.X;
+		const int32 StrideZ = Resolution.X * Resolution.Y;
+		TStaticArray<FHGMReal, 4> CellX {};
+		TStaticArray<FHGMReal, 4> CellY {};
+		TStaticArray<FHGMReal, 4> CellZ {};
+		TStaticArray<TStaticArray<FHGMReal, 4>, 8> CornerDistances {};
+		for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
+		{
+			const int32 X = FMath::Min(FMath::FloorToInt32(GridPositionX[ComponentIndex]), Resolution.X - 2);
+			const int32 Y = FMath::Min(FMath::FloorToInt32(GridPositionY[ComponentIndex]), Resolution.Y - 2);
+			const int32 Z = FMath::Min(FMath::FloorToInt32(GridPositionZ[ComponentIndex]), Resolution.Z - 2);
+			CellX[ComponentIndex] = StaticCast<FHGMReal>(X);
+			CellY[ComponentIndex] = StaticCast<FHGMReal>(Y);
+			CellZ[ComponentIndex] = StaticCast<FHGMReal>(Z);
+
+			const int32 BaseIndex = Z * StrideZ + Y * StrideY + X;
+			for (int32 CornerIndex = 0; CornerIndex < 8; ++CornerIndex)
+			{
+				const int32 CornerOffset = ((CornerIndex & 1) ? 1 : 0) + ((CornerIndex & 2) ? StrideY : 0) + ((CornerIndex & 4) ? StrideZ : 0);
+				CornerDistances[CornerIndex][ComponentIndex] = DistanceField.Distances[BaseIndex + CornerOffset];
+			}
+		}
+
+		TStaticArray<FHGMSIMDReal, 8> sCornerDistances {};
+		for (int32 CornerIndex = 0; CornerIndex < 8; ++CornerIndex)
+		{
+			FHGMSIMDLibrary::Load(sCornerDistances[CornerIndex], CornerDistances[CornerIndex]);
+		}
+
+		FHGMSIMDVector3 sCell {};
+		FHGMSIMDLibrary::Load(sCell.X, CellX);
+		FHGMSIMDLibrary::Load(sCell.Y, CellY);
+		FHGMSIMDLibrary::Load(sCell.Z, CellZ);
+		const FHGMSIMDReal sFractionX = FHGMMathLibrary::Clamp(sClampedGridPosition.X - sCell.X, HGMSIMDConstants::ZeroReal, HGMSIMDConstants::OneReal);
+		const FHGMSIMDReal sFractionY = FHGMMathLibrary::Clamp(sClampedGridPosition.Y - sCell.Y, HGMSIMDConstants::ZeroReal, HGMSIMDConstants::OneReal);
+		const FHGMSIMDReal sFractionZ = FHGMMathLibrary::Clamp(sClampedGridPosition.Z - sCell.Z, HGMSIMDConstants::ZeroReal, HGMSIMDConstants::OneReal);
+
+		const FHGMSIMDReal sDistance00 = FHGMMathLibrary::Lerp(sCornerDistances[0], sCornerDistances[1], sFractionX);
+		const FHGMSIMDReal sDistance10 = FHGMMathLibrary::Lerp(sCornerDistances[2], sCornerDistances[3], sFractionX);
+		const FHGMSIMDReal sDistance01 = FHGMMathLibrary::Lerp(sCornerDistances[4], sCornerDistances[5], sFractionX);
+		const FHGMSIMDReal sDistance11 = FHGMMathLibrary::Lerp(sCornerDistances[6], sCornerDistances[7], sFractionX);
+		const FHGMSIMDReal sDistance0 = FHGMMathLibrary::Lerp(sDistance00, sDistance10, sFractionY);
+		const FHGMSIMDReal sDistance1 = FHGMMathLibrary::Lerp(sDistance01, sDistance11, sFractionY);
+		const FHGMSIMDReal sDistance = FHGMMathLibrary::Lerp(sDistance0, sDistance1, sFractionZ);
+
+		// Gradient of interpolated distance is used as normal. It is normalized, so it is left in voxel units.
+		FHGMSIMDVector3 sGradient {};
+		sGradient.X = FHGMMathLibrary::Lerp(FHGMMathLibrary::Lerp(sCornerDistances[1] - sCornerDistances[0], sCornerDistances[3] - sCornerDistances[2], sFractionY),
+											FHGMMathLibrary::Lerp(sCornerDistances[5] - sCornerDistances[4], sCornerDistances[7] - sCornerDistances[6], sFractionY), sFractionZ);
+		sGradient.Y = FHGMMathLibrary::Lerp(sDistance10 - sDistance00, sDistance11 - sDistance01, sFractionZ);
+		sGradient.Z = sDistance1 - sDistance0;
+		const FHGMSIMDVector3 sNormal = FHGMMathLibrary::MakeSafeNormal(FHGMMathLibrary::TransformVector(sDistanceField.sTransform, sGradient));
+
+		const FHGMSIMDReal sHitMask = sInsideMask & (sDistance < sSphere.sRadius);
+		const FHGMSIMDReal sContactMask = sInsideMask & (sDistance < sSphere.sRadius + sContactMargin);
+
+		// Separating plane is surface offset by radius along normal, which is linearized at center of sSphere.
+		sOutColliderContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sContactMask, sNormal, FHGMSIMDVector3::ZeroVector);
+		sOutColliderContact.sSeparatingOffset = FHGMMathLibrary::DotProduct(sOutColliderContact.sSeparatingNormal, sSphere.sCenter)
+											  + FHGMSIMDLibrary::Select(sContactMask, sSphere.sRadius - sDistance, HGMSIMDConstants::ZeroReal);
+		sOutColliderContact.sHitMask = sHitMask;
+
+		return FHGMSIMDLibrary::IsAnyMaskSet(sContactMask);
 	}
 
 
-	bool IntersectPlaneSphere(const FHGMSIMDPlaneCollider& sPlaneCollider, const FHGMSIMDSphereCollider& sSphereCollider, FHGMSIMDColliderContact& sOutColliderContact)
+	// Plane is infinite, so contact holds for all components once any component is within sContactMargin.
+	bool IntersectPlaneSphere(const FHGMSIMDPlaneCollider& sPlaneCollider, const FHGMSIMDSphereCollider& sSphereCollider, const FHGMSIMDReal& sContactMargin, FHGMSIMDColliderContact& sOutColliderContact)
 	{
 		const FHGMSIMDVector3& sPlaneNormal = FHGMMathLibrary::GetUpVector(sPlaneCollider.sRotation);
 		const FHGMSIMDReal sPlaneProjection = FHGMMathLibrary::DotProduct(sPlaneNormal, sPlaneCollider.sOrigin) + sSphereCollider.sRadius;
@@ -442,24 +563,269 @@ namespace
 		sOutColliderContact.sSeparatingNormal = sPlaneNormal;
 		sOutColliderContact.sSeparatingOffset = sPlaneProjection + sOffset;
 
-		return FHGMSIMDLibrary::IsAnyMaskSet(sOutColliderContact.sHitMask);
+		return FHGMSIMDLibrary::IsAnyMaskSet((sPlaneProjection + sContactMargin - sSphereColliderProjection) > HGMSIMDConstants::ZeroReal);
+	}
+
+
+	// Dummy bones have no bone sphere, so their radius is zero.
+	FORCEINLINE FHGMSIMDReal GetBoneSphereColliderRadius(const FHGMSIMDBoneParameter& BoneSphereColliderRadiuses, const FHGMSIMDReal& sDummyBoneMask, int32 PackedIndex)
+	{
+		return FHGMSIMDLibrary::Select(sDummyBoneMask, HGMSIMDConstants::ZeroReal, BoneSphereColliderRadiuses[PackedIndex]);
+	}
+
+
+	// Dummy bones do not collide, so their components are cleared from contact.
+	FORCEINLINE void ClearDummyBoneContact(const FHGMSIMDReal& sDummyBoneMask, FHGMSIMDColliderContact& sContact)
+	{
+		sContact.sHitMask &= ~sDummyBoneMask;
+		sContact.sSeparatingNormal = FHGMSIMDLibrary::Select(sDummyBoneMask, FHGMSIMDVector3::ZeroVector, sContact.sSeparatingNormal);
+		sContact.sSeparatingOffset = FHGMSIMDLibrary::Select(sDummyBoneMask, HGMSIMDConstants::ZeroReal, sContact.sSeparatingOffset);
+	}
+
+
+	static TAutoConsoleVariable<int32> CVarColliderBroadphase(TEXT("p.Hagoromo.ColliderBroadphase"), 1, TEXT("Cull body colliders by bounds of each 4 chains before narrowphase. 0 tests all colliders against all bones.\n"));
+
+
+	// Bounds of 4 chains of packed column. Each lane holds bounds of one chain.
+	struct FHGMSIMDBounds
+	{
+		FHGMSIMDVector3 sMin {};
+		FHGMSIMDVector3 sMax {};
+	};
+
+
+	// Colliders that passed broadphase per packed column.
+	// Note: Candidates of column are stored in [Offsets[Column], Offsets[Column + 1]) in order of collider index.
+	struct FHGMColliderCandidates
+	{
+		FORCEINLINE TConstArrayView<int32> GetColliderIndexes(int32 PackedHorizontalIndex) const
+		{
+			return TConstArrayView<int32>(ColliderIndexes.GetData() + Offsets[PackedHorizontalIndex], Offsets[PackedHorizontalIndex + 1] - Offsets[PackedHorizontalIndex]);
+		}
+
+		TArray<int32, TMemStackAllocator<>> Offsets {};
+		TArray<int32, TMemStackAllocator<>> ColliderIndexes {};
+	};
+
+
+	// Sweeps bones from previous position and extrapolates them by one step, since dynamic tests look ahead by velocity.
+	// Bones are expanded by contact margin so that colliders within margin are not culled.
+	void CalculatePackedColumnBounds(const FHGMSimulationPlane& SimulationPlane, const FHGMSIMDBoneParameter& BoneSphereColliderRadiuses, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, TConstArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDVector3> PrevPositions,
+									 const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDBounds, TMemStackAllocator<>>& OutBounds)
+	{
+		const int32 PackedHorizontalBoneNum = SimulationPlane.PackedHorizontalBoneNum;
+		OutBounds.SetNumUninitialized(PackedHorizontalBoneNum);
+
+		for (int32 PackedHorizontalIndex = 0; PackedHorizontalIndex < PackedHorizontalBoneNum; ++PackedHorizontalIndex)
+		{
+			FHGMSIMDBounds& sBounds = OutBounds[PackedHorizontalIndex];
+			sBounds.sMin = Positions[PackedHorizontalIndex];
+			sBounds.sMax = Positions[PackedHorizontalIndex];
+
+			for (int32 PackedIndex = PackedHorizontalIndex; PackedIndex < Positions.Num(); PackedIndex += PackedHorizontalBoneNum)
+			{
+				const FHGMSIMDVector3& sPosition = Positions[PackedIndex];
+				const FHGMSIMDVector3& sPrevPosition = PrevPositions[PackedIndex];
+				const FHGMSIMDVector3 sExtrapolatedPosition = sPosition + (sPosition - sPrevPosition);
+				const FHGMSIMDReal sDummyBoneMask = ParticleParameters[PackedIndex].sDummyBoneMask > HGMSIMDConstants::ZeroReal;
+				const FHGMSIMDReal sRadius = GetBoneSphereColliderRadius(BoneSphereColliderRadiuses, sDummyBoneMask, PackedIndex) + sContactMargin;
+
+				sBounds.sMin.X = FHGMMathLibrary::Min(sBounds.sMin.X, FHGMMathLibrary::Min(FHGMMathLibrary::Min(sPosition.X, sPrevPosition.X), sExtrapolatedPosition.X) - sRadius);
+				sBounds.sMin.Y = FHGMMathLibrary::Min(sBounds.sMin.Y, FHGMMathLibrary::Min(FHGMMathLibrary::Min(sPosition.Y, sPrevPosition.Y), sExtrapolatedPosition.Y) - sRadius);
+				sBounds.sMin.Z = FHGMMathLibrary::Min(sBounds.sMin.Z, FHGMMathLibrary::Min(FHGMMathLibrary::Min(sPosition.Z, sPrevPosition.Z), sExtrapolatedPosition.Z) - sRadius);
+				sBounds.sMax.X = FHGMMathLibrary::Max(sBounds.sMax.X, FHGMMathLibrary::Max(FHGMMathLibrary::Max(sPosition.X, sPrevPosition.X), sExtrapolatedPosition.X) + sRadius);
+				sBounds.sMax.Y = FHGMMathLibrary::Max(sBounds.sMax.Y, FHGMMathLibrary::Max(FHGMMathLibrary::Max(sPosition.Y, sPrevPosition.Y), sExtrapolatedPosition.Y) + sRadius);
+				sBounds.sMax.Z = FHGMMathLibrary::Max(sBounds.sMax.Z, FHGMMathLibrary::Max(FHGMMathLibrary::Max(sPosition.Z, sPrevPosition.Z), sExtrapolatedPosition.Z) + sRadius);
+			}
+		}
+	}
+
+
+	// Collider is also swept from previous frame and extrapolated by one step.
+	FHGMColliderBounds CalculateSweptBounds(const FHGMVector3& Min, const FHGMVector3& Max, const FHGMVector3& PrevMin, const FHGMVector3& PrevMax)
+	{
+		FHGMColliderBounds Bounds {};
+		Bounds.Min = Min.ComponentMin(PrevMin).ComponentMin(Min + (Min - PrevMin));
+		Bounds.Max = Max.ComponentMax(PrevMax).ComponentMax(Max + (Max - PrevMax));
+
+		return Bounds;
+	}
+
+
+	FHGMColliderBounds CalculateSphereColliderBounds(const FHGMSphereCollider& SphereCollider, const FHGMSphereCollider& PrevSphereCollider)
+	{
+		const FHGMVector3 Extent(SphereCollider.Radius);
+		const FHGMVector3 PrevExtent(PrevSphereCollider.Radius);
+
+		return CalculateSweptBounds(SphereCollider.Center - Extent, SphereCollider.Center + Extent, PrevSphereCollider.Center - PrevExtent, PrevSphereCollider.Center + PrevExtent);
+	}
+
+
+	FHGMColliderBounds CalculateCapsuleColliderBounds(const FHGMCapsuleCollider& CapsuleCollider, const FHGMCapsuleCollider& PrevCapsuleCollider)
+	{
+		const FHGMVector3 Extent(CapsuleCollider.Radius);
+		const FHGMVector3 PrevExtent(PrevCapsuleCollider.Radius);
+
+		return CalculateSweptBounds(CapsuleCollider.StartPoint.ComponentMin(CapsuleCollider.EndPoint) - Extent, CapsuleCollider.StartPoint.ComponentMax(CapsuleCollider.EndPoint) + Extent,
+									PrevCapsuleCollider.StartPoint.ComponentMin(PrevCapsuleCollider.EndPoint) - PrevExtent, PrevCapsuleCollider.StartPoint.ComponentMax(PrevCapsuleCollider.EndPoint) + PrevExtent);
+	}
+
+
+	// Distance field is tested only at current position, so bounds are not swept.
+	FHGMColliderBounds CalculateDistanceFieldColliderBounds(const FHGMDistanceFieldCollider& DistanceFieldCollider, const FHGMDistanceField& DistanceField)
+	{
+		const FHGMVector3 GridSize = FHGMVector3(DistanceField.Resolution - FIntVector(1)) * DistanceField.VoxelSize;
+		const FBox ComponentSpaceGridBox = FBox(DistanceField.Origin, DistanceField.Origin + GridSize).TransformBy(DistanceFieldCollider.Transform);
+
+		FHGMColliderBounds Bounds {};
+		Bounds.Min = ComponentSpaceGridBox.Min;
+		Bounds.Max = ComponentSpaceGridBox.Max;
+
+		return Bounds;
+	}
+
+
+	// Tests bounds of collider against bounds of 4 chains at once.
+	bool IntersectBounds(const FHGMSIMDBounds& sColumnBounds, const FHGMColliderBounds& ColliderBounds)
+	{
+		FHGMSIMDVector3 sColliderMin {};
+		FHGMSIMDVector3 sColliderMax {};
+		FHGMSIMDLibrary::Load(sColliderMin, ColliderBounds.Min);
+		FHGMSIMDLibrary::Load(sColliderMax, ColliderBounds.Max);
+
+		const FHGMSIMDReal sOverlapMask = (sColumnBounds.sMin.X <= sColliderMax.X) & (sColumnBounds.sMax.X >= sColliderMin.X)
+										& (sColumnBounds.sMin.Y <= sColliderMax.Y) & (sColumnBounds.sMax.Y >= sColliderMin.Y)
+										& (sColumnBounds.sMin.Z <= sColliderMax.Z) & (sColumnBounds.sMax.Z >= sColliderMin.Z);
+
+		return FHGMSIMDLibrary::IsAnyMaskSet(sOverlapMask);
+	}
+
+
+	void GatherColliderCandidates(TConstArrayView<FHGMSIMDBounds> ColumnBounds, TConstArrayView<FHGMColliderBounds> ColliderBounds, bool bUseBroadphase, FHGMColliderCandidates& OutCandidates)
+	{
+		OutCandidates.Offsets.SetNumUninitialized(ColumnBounds.Num() + 1);
+		OutCandidates.ColliderIndexes.Reset();
+		for (int32 PackedHorizontalIndex = 0; PackedHorizontalIndex < ColumnBounds.Num(); ++PackedHorizontalIndex)
+		{
+			OutCandidates.Offsets[PackedHorizontalIndex] = OutCandidates.ColliderIndexes.Num();
+
+			for (int32 ColliderIndex = 0; ColliderIndex < ColliderBounds.Num(); ++ColliderIndex)
+			{
+				if (bUseBroadphase && !IntersectBounds(ColumnBounds[PackedHorizontalIndex], ColliderBounds[ColliderIndex]))
+				{
+					continue;
+				}
+
+				OutCandidates.ColliderIndexes.Emplace(ColliderIndex);
+			}
+		}
+
+		OutCandidates.Offsets[ColumnBounds.Num()] = OutCandidates.ColliderIndexes.Num();
+	}
+
+
+	// Enabled colliders are broadcast with previous state of same collider, so that narrowphase does not branch or load per bone.
+	void UpdateSIMDColliders(FHGMBodyCollider& BodyCollider, const FHGMBodyCollider& PrevBodyCollider)
+	{
+		BodyCollider.SIMDSphereColliders.Reset();
+		BodyCollider.PrevSIMDSphereColliders.Reset();
+		BodyCollider.SphereColliderBounds.Reset();
+		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.SphereColliders.Num(); ++ColliderIndex)
+		{
+			const FHGMSphereCollider& SphereCollider = BodyCollider.SphereColliders[ColliderIndex];
+			if (!SphereCollider.bEnabled || BodyCollider.BoneSpaceSphereColliders[ColliderIndex].bEdgeOnly)
+			{
+				continue;
+			}
+
+			const FHGMSphereCollider& PrevSphereCollider = PrevBodyCollider.SphereColliders[ColliderIndex];
+			BodyCollider.SIMDSphereColliders.Emplace(SphereCollider);
+			BodyCollider.PrevSIMDSphereColliders.Emplace(PrevSphereCollider);
+			BodyCollider.SphereColliderBounds.Emplace(CalculateSphereColliderBounds(SphereCollider, PrevSphereCollider));
+		}
+
+		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.SphereColliders.Num(); ++ColliderIndex)
+		{
+			const FHGMSphereCollider& SphereCollider = BodyCollider.SphereColliders[ColliderIndex];
+			if (SphereCollider.bEnabled && BodyCollider.BoneSpaceSphereColliders[ColliderIndex].bEdgeOnly)
+			{
+				BodyCollider.SIMDSphereColliders.Emplace(SphereCollider);
+			}
+		}
+
+		BodyCollider.SIMDCapsuleColliders.Reset();
+		BodyCollider.PrevSIMDCapsuleColliders.Reset();
+		BodyCollider.CapsuleColliderBounds.Reset();
+		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.CapsuleColliders.Num(); ++ColliderIndex)
+		{
+			const FHGMCapsuleCollider& CapsuleCollider = BodyCollider.CapsuleColliders[ColliderIndex];
+			if (!CapsuleCollider.bEnabled || BodyCollider.BoneSpaceCapsuleColliders[ColliderIndex].bEdgeOnly)
+			{
+				continue;
+			}
+
+			const FHGMCapsuleCollider& PrevCapsuleCollider = PrevBodyCollider.CapsuleColliders[ColliderIndex];
+			BodyCollider.SIMDCapsuleColliders.Emplace(CapsuleCollider);
+			BodyCollider.PrevSIMDCapsuleColliders.Emplace(PrevCapsuleCollider);
+			BodyCollider.CapsuleColliderBounds.Emplace(CalculateCapsuleColliderBounds(CapsuleCollider, PrevCapsuleCollider));
+		}
+
+		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.CapsuleColliders.Num(); ++ColliderIndex)
+		{
+			const FHGMCapsuleCollider& CapsuleCollider = BodyCollider.CapsuleColliders[ColliderIndex];
+			if (CapsuleCollider.bEnabled && BodyCollider.BoneSpaceCapsuleColliders[ColliderIndex].bEdgeOnly)
+			{
+				BodyCollider.SIMDCapsuleColliders.Emplace(CapsuleCollider);
+			}
+		}
+
+		BodyCollider.SIMDDistanceFieldColliders.Reset();
+		BodyCollider.DistanceFieldColliderBounds.Reset();
+		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.DistanceFieldColliders.Num(); ++ColliderIndex)
+		{
+			const FHGMDistanceFieldCollider& DistanceFieldCollider = BodyCollider.DistanceFieldColliders[ColliderIndex];
+			if (!DistanceFieldCollider.bEnabled)
+			{
+				continue;
+			}
+
+			const FHGMDistanceField& DistanceField = *BodyCollider.BoneSpaceDistanceFieldColliders[ColliderIndex].DistanceField;
+			BodyCollider.SIMDDistanceFieldColliders.Emplace(DistanceFieldCollider, DistanceField);
+			BodyCollider.DistanceFieldColliderBounds.Emplace(CalculateDistanceFieldColliderBounds(DistanceFieldCollider, DistanceField));
+		}
 	}
 } // End of namespace
 
 
+  // ---------------------------------------------------------------------------------------
+  // DistanceField
+  // ---------------------------------------------------------------------------------------
+void FHGMDistanceField::Serialize(FArchive& Ar)
+{
+	Ar << BoneName;
+	Ar << Origin;
+	Ar << VoxelSize;
+	Ar << Resolution;
+	Ar << Distances;
+}
+
+
   // ---------------------------------------------------------------------------------------
   // CollisionLibrary
   // ---------------------------------------------------------------------------------------
-void FHGMCollisionLibrary::InitializeBodyColliderFromPhysicsAsset(const FBoneContainer& RequiredBones, UPhysicsAsset* PhysicsAsset, FHGMBodyCollider& OutBodyCollider)
+void FHGMCollisionLibrary::InitializeBodyColliderFromPhysicsAsset(const FBoneContainer& RequiredBones, UPhysicsAsset* PhysicsAsset, const UHagoromoDistanceFieldData* DistanceFieldData, FHGMBodyCollider& OutBodyCollider)
 {
 	if (!PhysicsAsset)
 	{
 		return;
 	}
 
+	HGM_CLOG(DistanceFieldData && DistanceFieldData->PhysicsAsset != PhysicsAsset, Warning, TEXT("Distance field data %s was built from different physics asset. Distance fields are matched to bodies by bone name."), *GetPathNameSafe(DistanceFieldData));
+
 	// Gather and initialize body collider from the physical asset.
 	OutBodyCollider.BoneSpaceSphereColliders.Reset();
 	OutBodyCollider.BoneSpaceCapsuleColliders.Reset();
+	OutBodyCollider.BoneSpaceDistanceFieldColliders.Reset();
 	for (const TObjectPtr<USkeletalBodySetup> SkeletalBodySetup : PhysicsAsset->SkeletalBodySetups)
 	{
 		FBoneReference DriverBone = SkeletalBodySetup->BoneName;
@@ -470,11 +836,20 @@ void FHGMCollisionLibrary::InitializeBodyColliderFromPhysicsAsset(const FBoneCon
 			continue;
 		}
 
+		// Bone spheres collide with body that has baked distance field by it instead of its shapes, so that cost does not depend on number of shapes.
+		// Its shapes are still kept for edges, which are only tested against spheres and capsules.
+		TSharedPtr<const FHGMDistanceField> DistanceField = DistanceFieldData ? DistanceFieldData->FindDistanceField(SkeletalBodySetup->BoneName) : nullptr;
+		const bool bEdgeOnly = DistanceField.IsValid();
+		if (DistanceField.IsValid())
+		{
+			OutBodyCollider.BoneSpaceDistanceFieldColliders.Emplace(DriverBone, MoveTemp(DistanceField));
+		}
+
 		// Sphere:
 		const FKAggregateGeom& AggGeom = SkeletalBodySetup->AggGeom;
 		for (const auto& SphereElem : AggGeom.SphereElems)
 		{
-			OutBodyCollider.BoneSpaceSphereColliders.Emplace(DriverBone, SphereElem.Center, SphereElem.Radius);
+			OutBodyCollider.BoneSpaceSphereColliders.Emplace(DriverBone, SphereElem.Center, SphereElem.Radius, bEdgeOnly);
 		}
 
 		// Capsule:
@@ -484,33 +859,142 @@ void FHGMCollisionLibrary::InitializeBodyColliderFromPhysicsAsset(const FBoneCon
 			HalfCapsuleDirection = CapsuleElem.Rotation.RotateVector(HalfCapsuleDirection);
 			const FHGMVector3 StartPoint = CapsuleElem.Center - HalfCapsuleDirection;
 			const FHGMVector3 EndPoint = CapsuleElem.Center + HalfCapsuleDirection;
-			OutBodyCollider.BoneSpaceCapsuleColliders.Emplace(DriverBone, StartPoint, EndPoint, CapsuleElem.Radius);
+			OutBodyCollider.BoneSpaceCapsuleColliders.Emplace(DriverBone, StartPoint, EndPoint, CapsuleElem.Radius, bEdgeOnly);
 		}
 	}
 
 	OutBodyCollider.SphereColliders.Init(FHGMSphereCollider(), OutBodyCollider.BoneSpaceSphereColliders.Num());
 	OutBodyCollider.CapsuleColliders.Init(FHGMCapsuleCollider(), OutBodyCollider.BoneSpaceCapsuleColliders.Num());
+	OutBodyCollider.DistanceFieldColliders.Init(FHGMDistanceFieldCollider(), OutBodyCollider.BoneSpaceDistanceFieldColliders.Num());
 
-	HGM_CLOG(OutBodyCollider.BoneSpaceSphereColliders.Num() + OutBodyCollider.BoneSpaceCapsuleColliders.Num() <= 0, Log, TEXT("No collider is included in body collider."));
+	HGM_CLOG(OutBodyCollider.BoneSpaceSphereColliders.Num() + OutBodyCollider.BoneSpaceCapsuleColliders.Num() + OutBodyCollider.BoneSpaceDistanceFieldColliders.Num() <= 0, Log, TEXT("No collider is included in body collider."));
+}
+
+
+bool FHGMCollisionLibrary::BuildDistanceField(FName BoneName, const FKAggregateGeom& AggGeom, FHGMReal VoxelSize, FHGMReal Padding, int32 MaxResolution, FHGMDistanceField& OutDistanceField)
+{
+	// Grid covers shapes of body with padding, so that bones approaching surface are inside of grid.
+	FBox Bounds(ForceInit);
+	for (const FKSphereElem& SphereElem : AggGeom.SphereElems)
+	{
+		Bounds += SphereElem.CalcAABB(FTransform::Identity, 1.0f);
+	}
+
+	for (const FKSphylElem& CapsuleElem : AggGeom.SphylElems)
+	{
+		Bounds += CapsuleElem.CalcAABB(FTransform::Identity, 1.0f);
+	}
+
+	for (const FKBoxElem& BoxElem : AggGeom.BoxElems)
+	{
+		Bounds += BoxElem.CalcAABB(FTransform::Identity, 1.0f);
+	}
+
+	if (!Bounds.IsValid)
+	{
+		return false;
+	}
+
+	Bounds = Bounds.ExpandBy(FHGMMathLibrary::Max<FHGMReal>(Padding, 0.0));
+
+	// Voxel is enlarged when grid would exceed MaxResolution on any axis.
+	const FHGMVector3 BoundsSize = Bounds.GetSize();
+	const int32 ClampedMaxResolution = FHGMMathLibrary::Max(MaxResolution, 2);
+	VoxelSize = FHGMMathLibrary::Max(VoxelSize, BoundsSize.GetMax() / StaticCast<FHGMReal>(ClampedMaxResolution - 1));
+	if (VoxelSize <= UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	OutDistanceField.BoneName = BoneName;
+	OutDistanceField.Origin = Bounds.Min;
+	OutDistanceField.VoxelSize = VoxelSize;
+	OutDistanceField.Resolution.X = FMath::Clamp(FMath::CeilToInt32(BoundsSize.X / VoxelSize) + 1, 2, ClampedMaxResolution);
+	OutDistanceField.Resolution.Y = FMath::Clamp(FMath::CeilToInt32(BoundsSize.Y / VoxelSize) + 1, 2, ClampedMaxResolution);
+	OutDistanceField.Resolution.Z = FMath::Clamp(FMath::CeilToInt32(BoundsSize.Z / VoxelSize) + 1, 2, ClampedMaxResolution);
+	OutDistanceField.Distances.SetNumUninitialized(OutDistanceField.Resolution.X * OutDistanceField.Resolution.Y * OutDistanceField.Resolution.Z);
+
+	// Distance to union of shapes is minimum of signed distances to each shape.
+	int32 VoxelIndex = 0;
+	for (int32 Z = 0; Z < OutDistanceField.Resolution.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < OutDistanceField.Resolution.Y; ++Y)
+		{
+			for (int32 X = 0; X < OutDistanceField.Resolution.X; ++X)
+			{
+				const FHGMVector3 Position = OutDistanceField.Origin + FHGMVector3(X, Y, Z) * VoxelSize;
+				FHGMReal Distance = TNumericLimits<FHGMReal>::Max();
+
+				for (const FKSphereElem& SphereElem : AggGeom.SphereElems)
+				{
+					Distance = FHGMMathLibrary::Min(Distance, FHGMVector3::Distance(Position, SphereElem.Center) - SphereElem.Radius);
+				}
+
+				for (const FKSphylElem& CapsuleElem : AggGeom.SphylElems)
+				{
+					const FHGMVector3 HalfCapsuleDirection = CapsuleElem.Rotation.RotateVector(FHGMVector3(0.0, 0.0, CapsuleElem.Length * 0.5));
+					const FHGMVector3 ClosestPoint = FMath::ClosestPointOnSegment(Position, CapsuleElem.Center - HalfCapsuleDirection, CapsuleElem.Center + HalfCapsuleDirection);
+					Distance = FHGMMathLibrary::Min(Distance, FHGMVector3::Distance(Position, ClosestPoint) - CapsuleElem.Radius);
+				}
+
+				for (const FKBoxElem& BoxElem : AggGeom.BoxElems)
+				{
+					const FHGMVector3 LocalPosition = BoxElem.Rotation.UnrotateVector(Position - BoxElem.Center);
+					const FHGMVector3 Excess = LocalPosition.GetAbs() - FHGMVector3(BoxElem.X, BoxElem.Y, BoxElem.Z) * 0.5;
+					const FHGMReal OutsideDistance = Excess.ComponentMax(FHGMVector3::ZeroVector).Size();
+					const FHGMReal InsideDistance = FHGMMathLibrary::Min<FHGMReal>(Excess.GetMax(), 0.0);
+					Distance = FHGMMathLibrary::Min(Distance, OutsideDistance + InsideDistance);
+				}
+
+				OutDistanceField.Distances[VoxelIndex++] = StaticCast<float>(Distance);
+			}
+		}
+	}
+
+	return true;
+}
+
+
+void FHGMCollisionLibrary::UpdateBodyColliderRequiredBones(const FBoneContainer& RequiredBones, FHGMBodyCollider& BodyCollider)
+{
+	// Only driver bones are remapped, so that colliders and their previous state are kept across LOD change.
+	for (FHGMBoneSpaceSphereCollider& BoneSpaceSphereCollider : BodyCollider.BoneSpaceSphereColliders)
+	{
+		BoneSpaceSphereCollider.DriverBone.Initialize(RequiredBones);
+	}
+
+	for (FHGMBoneSpaceCapsuleCollider& BoneSpaceCapsuleCollider : BodyCollider.BoneSpaceCapsuleColliders)
+	{
+		BoneSpaceCapsuleCollider.DriverBone.Initialize(RequiredBones);
+	}
+
+	for (FHGMBoneSpaceDistanceFieldCollider& BoneSpaceDistanceFieldCollider : BodyCollider.BoneSpaceDistanceFieldColliders)
+	{
+		BoneSpaceDistanceFieldCollider.DriverBone.Initialize(RequiredBones);
+	}
 }
 
 
 void FHGMCollisionLibrary::UpdateBodyCollider(FComponentSpacePoseContext& Output, const FHGMPhysicsContext& PhysicsContext, FHGMBodyCollider& BodyCollider, FHGMBodyCollider& PrevBodyCollider)
 {
-	PrevBodyCollider = BodyCollider;
+	const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
+
+	// Only component space colliders are referred as previous state.
+	PrevBodyCollider.SphereColliders = BodyCollider.SphereColliders;
+	PrevBodyCollider.CapsuleColliders = BodyCollider.CapsuleColliders;
 
 	for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.BoneSpaceSphereColliders.Num(); ++ColliderIndex)
 	{
 		FHGMSphereCollider& UpdatingSphereCollider = BodyCollider.SphereColliders[ColliderIndex];
 		const FHGMBoneSpaceSphereCollider& BoneSpaceSphereCollider = BodyCollider.BoneSpaceSphereColliders[ColliderIndex];
-		if (!BoneSpaceSphereCollider.DriverBone.IsValidToEvaluate())
+		if (!BoneSpaceSphereCollider.DriverBone.IsValidToEvaluate(BoneContainer))
 		{
 			UpdatingSphereCollider.bEnabled = false;
 			continue;
 		}
 		UpdatingSphereCollider.bEnabled = true;
 
-		const FCompactPoseBoneIndex BoneIndex(BoneSpaceSphereCollider.DriverBone.BoneIndex);
+		const FCompactPoseBoneIndex BoneIndex = BoneSpaceSphereCollider.DriverBone.GetCompactPoseIndex(BoneContainer);
 		const FHGMTransform& ComponentSpaceBoneTransform = Output.Pose.GetComponentSpaceTransform(BoneIndex);
 
 		UpdatingSphereCollider.Center = ComponentSpaceBoneTransform.TransformPosition(BoneSpaceSphereCollider.Center);
@@ -521,14 +1005,14 @@ void FHGMCollisionLibrary::UpdateBodyCollider(FComponentSpacePoseContext& Output
 	{
 		FHGMCapsuleCollider& UpdatingCapsuleCollider = BodyCollider.CapsuleColliders[ColliderIndex];
 		const FHGMBoneSpaceCapsuleCollider& BoneSpaceCapsuleCollider = BodyCollider.BoneSpaceCapsuleColliders[ColliderIndex];
-		if (!BoneSpaceCapsuleCollider.DriverBone.IsValidToEvaluate())
+		if (!BoneSpaceCapsuleCollider.DriverBone.IsValidToEvaluate(BoneContainer))
 		{
 			UpdatingCapsuleCollider.bEnabled = false;
 			continue;
 		}
 		UpdatingCapsuleCollider.bEnabled = true;
 
-		const FCompactPoseBoneIndex BoneIndex(BoneSpaceCapsuleCollider.DriverBone.BoneIndex);
+		const FCompactPoseBoneIndex BoneIndex = BoneSpaceCapsuleCollider.DriverBone.GetCompactPoseIndex(BoneContainer);
 		const FHGMTransform& ComponentSpaceBoneTransform = Output.Pose.GetComponentSpaceTransform(BoneIndex);
 
 		UpdatingCapsuleCollider.StartPoint = ComponentSpaceBoneTransform.TransformPosition(BoneSpaceCapsuleCollider.StartPoint);
@@ -536,60 +1020,120 @@ void FHGMCollisionLibrary::UpdateBodyCollider(FComponentSpacePoseContext& Output
 		UpdatingCapsuleCollider.Radius = BoneSpaceCapsuleCollider.Radius;
 	}
 
+	for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.BoneSpaceDistanceFieldColliders.Num(); ++ColliderIndex)
+	{
+		FHGMDistanceFieldCollider& UpdatingDistanceFieldCollider = BodyCollider.DistanceFieldColliders[ColliderIndex];
+		const FHGMBoneSpaceDistanceFieldCollider& BoneSpaceDistanceFieldCollider = BodyCollider.BoneSpaceDistanceFieldColliders[ColliderIndex];
+		if (!BoneSpaceDistanceFieldCollider.DriverBone.IsValidToEvaluate(BoneContainer))
+		{
+			UpdatingDistanceFieldCollider.bEnabled = false;
+			continue;
+		}
+		UpdatingDistanceFieldCollider.bEnabled = true;
+
+		const FCompactPoseBoneIndex BoneIndex = BoneSpaceDistanceFieldCollider.DriverBone.GetCompactPoseIndex(BoneContainer);
+		UpdatingDistanceFieldCollider.Transform = Output.Pose.GetComponentSpaceTransform(BoneIndex);
+	}
+
 	if (PhysicsContext.bIsFirstUpdate)
 	{
-		PrevBodyCollider = BodyCollider;
+		PrevBodyCollider.SphereColliders = BodyCollider.SphereColliders;
+		PrevBodyCollider.CapsuleColliders = BodyCollider.CapsuleColliders;
 	}
+
+	UpdateSIMDColliders(BodyCollider, PrevBodyCollider);
 }
 
 
-void FHGMCollisionLibrary::CalculateBodyColliderContacts(TConstArrayView<FHGMSIMDReal> BoneSphereColliderRadiuses, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, const FHGMBodyCollider& BodyCollider, const FHGMBodyCollider& PrevBodyCollider, TArray<FHGMSIMDColliderContact>& OutContacts)
+void FHGMCollisionLibrary::CalculateBodyColliderContacts(const FHGMSimulationPlane& SimulationPlane, const FHGMSIMDBoneParameter& BoneSphereColliderRadiuses, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, const FHGMBodyCollider& BodyCollider, const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDColliderContact>& OutContacts)
 {
 	SCOPE_CYCLE_COUNTER(STAT_CollisionCalculateBodyColliderContacts);
 
+	if (BodyCollider.SIMDSphereColliders.IsEmpty() && BodyCollider.SIMDCapsuleColliders.IsEmpty() && BodyCollider.SIMDDistanceFieldColliders.IsEmpty())
+	{
+		return;
+	}
+
+	FHGMScopedScratchMemory ScratchMemory {};
+
+	// Broadphase :
+	FHGMColliderCandidates SphereCandidates {};
+	FHGMColliderCandidates CapsuleCandidates {};
+	FHGMColliderCandidates DistanceFieldCandidates {};
+	{
+		SCOPE_CYCLE_COUNTER(STAT_CollisionBroadphase);
+
+		const bool bUseBroadphase = CVarColliderBroadphase.GetValueOnAnyThread() != 0;
+
+		TArray<FHGMSIMDBounds, TMemStackAllocator<>> ColumnBounds {};
+		CalculatePackedColumnBounds(SimulationPlane, BoneSphereColliderRadiuses, ParticleParameters, Positions, PrevPositions, sContactMargin, ColumnBounds);
+
+		GatherColliderCandidates(ColumnBounds, BodyCollider.SphereColliderBounds, bUseBroadphase, SphereCandidates);
+		GatherColliderCandidates(ColumnBounds, BodyCollider.CapsuleColliderBounds, bUseBroadphase, CapsuleCandidates);
+		GatherColliderCandidates(ColumnBounds, BodyCollider.DistanceFieldColliderBounds, bUseBroadphase, DistanceFieldCandidates);
+	}
+
+	// Narrowphase :
+	// Bones are visited in same order as without broadphase, so that contacts are solved in same order.
 	for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
 	{
+		const int32 PackedHorizontalIndex = PackedIndex % SimulationPlane.PackedHorizontalBoneNum;
+		const TConstArrayView<int32> SphereColliderIndexes = SphereCandidates.GetColliderIndexes(PackedHorizontalIndex);
+		const TConstArrayView<int32> CapsuleColliderIndexes = CapsuleCandidates.GetColliderIndexes(PackedHorizontalIndex);
+		const TConstArrayView<int32> DistanceFieldColliderIndexes = DistanceFieldCandidates.GetColliderIndexes(PackedHorizontalIndex);
+		if (SphereColliderIndexes.IsEmpty() && CapsuleColliderIndexes.IsEmpty() && DistanceFieldColliderIndexes.IsEmpty())
+		{
+			continue;
+		}
+
+		// Packed bone made of only dummy bones has nothing to collide.
+		const FHGMSIMDReal sDummyBoneMask = ParticleParameters[PackedIndex].sDummyBoneMask > HGMSIMDConstants::ZeroReal;
+		if (!FHGMSIMDLibrary::IsAnyMaskSet(~sDummyBoneMask))
+		{
+			continue;
+		}
+
 		const FHGMSIMDVector3& sPosition = Positions[PackedIndex];
 		const FHGMSIMDVector3& sPrevPosition = PrevPositions[PackedIndex];
-		const FHGMSIMDReal& sBoneSphereColliderRadius = BoneSphereColliderRadiuses[PackedIndex];
+		const FHGMSIMDReal sBoneSphereColliderRadius = GetBoneSphereColliderRadius(BoneSphereColliderRadiuses, sDummyBoneMask, PackedIndex);
 		const FHGMSIMDSphereCollider sBoneSphereCollider(sPosition, sBoneSphereColliderRadius);
 		const FHGMSIMDSphereCollider sPrevBoneSphereCollider(sPrevPosition, sBoneSphereColliderRadius);
 
 		// BoneSphere vs Sphere :
-		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.SphereColliders.Num(); ++ColliderIndex)
+		for (const int32 ColliderIndex : SphereColliderIndexes)
 		{
-			const FHGMSphereCollider& SphereCollider = BodyCollider.SphereColliders[ColliderIndex];
-			if (!SphereCollider.bEnabled)
-			{
-				continue;
-			}
-
-			const FHGMSphereCollider& PrevSphereCollider = PrevBodyCollider.SphereColliders[ColliderIndex];
-			FHGMSIMDSphereCollider sSphereCollider(SphereCollider);
-			FHGMSIMDSphereCollider sPrevSphereCollider(PrevSphereCollider);
+			const FHGMSIMDSphereCollider& sSphereCollider = BodyCollider.SIMDSphereColliders[ColliderIndex];
+			const FHGMSIMDSphereCollider& sPrevSphereCollider = BodyCollider.PrevSIMDSphereColliders[ColliderIndex];
 			FHGMSIMDColliderContact sContact {};
-			if (IntersectSphereSphere(sBoneSphereCollider, sPrevBoneSphereCollider, sSphereCollider, sPrevSphereCollider, sContact))
+			if (IntersectSphereSphere(sBoneSphereCollider, sPrevBoneSphereCollider, sSphereCollider, sPrevSphereCollider, sContactMargin, sContact))
 			{
+				ClearDummyBoneContact(sDummyBoneMask, sContact);
 				sContact.PackedIndex = PackedIndex;
 				OutContacts.Emplace(sContact);
 			}
 		}
 
 		// BoneSphere vs Capsule :
-		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.CapsuleColliders.Num(); ++ColliderIndex)
+		for (const int32 ColliderIndex : CapsuleColliderIndexes)
 		{
-			const FHGMCapsuleCollider& CapsuleCollider = BodyCollider.CapsuleColliders[ColliderIndex];
-			if (!CapsuleCollider.bEnabled)
+			const FHGMSIMDCapsuleCollider& sCapsuleCollider = BodyCollider.SIMDCapsuleColliders[ColliderIndex];
+			const FHGMSIMDCapsuleCollider& sPrevCapsuleCollider = BodyCollider.PrevSIMDCapsuleColliders[ColliderIndex];
+			FHGMSIMDColliderContact sContact {};
+			if (IntersectSphereCapsule(sBoneSphereCollider, sPrevBoneSphereCollider, sCapsuleCollider, sPrevCapsuleCollider, sContactMargin, sContact))
 			{
-				continue;
+				ClearDummyBoneContact(sDummyBoneMask, sContact);
+				sContact.PackedIndex = PackedIndex;
+				OutContacts.Emplace(sContact);
 			}
+		}
 
-			const FHGMCapsuleCollider& PrevCapsuleCollider = PrevBodyCollider.CapsuleColliders[ColliderIndex];
-			FHGMSIMDCapsuleCollider sCapsuleCollider(CapsuleCollider);
-			FHGMSIMDCapsuleCollider sPrevCapsuleCollider(PrevCapsuleCollider);
+		// BoneSphere vs DistanceField :
+		for (const int32 ColliderIndex : DistanceFieldColliderIndexes)
+		{
 			FHGMSIMDColliderContact sContact {};
-			if (IntersectSphereCapsule(sBoneSphereCollider, sPrevBoneSphereCollider, sCapsuleCollider, sPrevCapsuleCollider, sContact))
+			if (IntersectSphereDistanceField(sBoneSphereCollider, BodyCollider.SIMDDistanceFieldColliders[ColliderIndex], sContactMargin, sContact))
 			{
+				ClearDummyBoneContact(sDummyBoneMask, sContact);
 				sContact.PackedIndex = PackedIndex;
 				OutContacts.Emplace(sContact);
 			}
@@ -598,116 +1142,197 @@ void FHGMCollisionLibrary::CalculateBodyColliderContacts(TConstArrayView<FHGMSIM
 }
 
 
-void FHGMCollisionLibrary::CalculateBodyColliderContactsForVerticalEdge(TConstArrayView<FHGMSIMDStructure> VerticalStructures, TArrayView<FHGMSIMDVector3> Positions, const FHGMBodyCollider& BodyCollider, TArray<FHGMSIMDColliderContact>& OutContacts)
+void FHGMCollisionLibrary::CalculateBodyColliderContactsForVerticalEdge(TConstArrayView<FHGMSIMDStructure> VerticalStructures, TArrayView<FHGMSIMDVector3> Positions, const FHGMBodyCollider& BodyCollider, const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDColliderContact>& OutContacts)
 {
 	SCOPE_CYCLE_COUNTER(STAT_CollisionCalculateBodyColliderContactsForVerticalEdge);
 
-	for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
+	// Each edge is visited once per collider and contact is added to both ends.
+	for (const FHGMSIMDStructure& Structure : VerticalStructures)
 	{
-		for (const FHGMSIMDStructure& Structure : VerticalStructures)
-		{
-			const FHGMSIMDVector3& sSegmentStart = Positions[Structure.FirstBonePackedIndex];
-			const FHGMSIMDVector3& sSegmentEnd = Positions[Structure.SecondBonePackedIndex];
+		const FHGMSIMDVector3& sSegmentStart = Positions[Structure.FirstBonePackedIndex];
+		const FHGMSIMDVector3& sSegmentEnd = Positions[Structure.SecondBonePackedIndex];
 
-			// BoneEdge vs Sphere :
-			for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.SphereColliders.Num(); ++ColliderIndex)
+		// BoneEdge vs Sphere :
+		for (const FHGMSIMDSphereCollider& sSphereCollider : BodyCollider.SIMDSphereColliders)
+		{
+			FHGMSIMDEdgeColliderContact sEdgeContact {};
+			if (IntersectEdgeSphere(sSegmentStart, sSegmentEnd, sSphereCollider, sContactMargin, sEdgeContact))
 			{
-				const FHGMSphereCollider& SphereCollider = BodyCollider.SphereColliders[ColliderIndex];
-				if (!SphereCollider.bEnabled)
-				{
-					continue;
-				}
-
-				FHGMSIMDSphereCollider sSphereCollider(SphereCollider);
-				FHGMSIMDEdgeColliderContact sEdgeContact {};
-
-				if (IntersectEdgeSphere(sSegmentStart, sSegmentEnd, sSphereCollider, sEdgeContact))
-				{
-					OutContacts.Emplace(Structure.FirstBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeStartSeparatingOffset);
-					OutContacts.Emplace(Structure.SecondBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeEndSeparatingOffset);
-				}
+				OutContacts.Emplace(Structure.FirstBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeStartSeparatingOffset);
+				OutContacts.Emplace(Structure.SecondBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeEndSeparatingOffset);
 			}
+		}
 
-			// BoneEdge vs Capsule :
-			for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.CapsuleColliders.Num(); ++ColliderIndex)
+		// BoneEdge vs Capsule :
+		for (const FHGMSIMDCapsuleCollider& sCapsuleCollider : BodyCollider.SIMDCapsuleColliders)
+		{
+			FHGMSIMDEdgeColliderContact sEdgeContact {};
+			if (IntersectEdgeCapsule(sSegmentStart, sSegmentEnd, sCapsuleCollider, sContactMargin, sEdgeContact))
 			{
-				const FHGMCapsuleCollider& CapsuleCollider = BodyCollider.CapsuleColliders[ColliderIndex];
-				if (!CapsuleCollider.bEnabled)
-				{
-					continue;
-				}
-
-				FHGMCapsuleCollider sCapsuleCollider(CapsuleCollider);
-				FHGMSIMDEdgeColliderContact sEdgeContact {};
-				if (IntersectEdgeCapsule(sSegmentStart, sSegmentEnd, sCapsuleCollider, sEdgeContact))
-				{
-					OutContacts.Emplace(Structure.FirstBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeStartSeparatingOffset);
-					OutContacts.Emplace(Structure.SecondBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeEndSeparatingOffset);
-				}
+				OutContacts.Emplace(Structure.FirstBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeStartSeparatingOffset);
+				OutContacts.Emplace(Structure.SecondBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeEndSeparatingOffset);
 			}
 		}
 	}
 }
 
 
-void FHGMCollisionLibrary::CalculateBodyColliderContactsForHorizontalEdge(FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDStructure> HorizontalStructures, TArray<FHGMSIMDVector3>& Positions, const FHGMBodyCollider& BodyCollider, TArray<FHGMSIMDColliderContact>& OutContacts)
+void FHGMCollisionLibrary::CalculateBodyColliderContactsForHorizontalEdge(const FHGMSimulationPlane& SimulationPlane, bool bLoopHorizontalStructure, TConstArrayView<FHGMSIMDVector3> Positions, const FHGMBodyCollider& BodyCollider, const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDColliderContact>& OutContacts)
 {
 	SCOPE_CYCLE_COUNTER(STAT_CollisionCalculateBodyColliderContactsForHorizontalEdge);
 
-	if (HorizontalStructures.IsEmpty())
+	const int32 ActualChainNum = SimulationPlane.ActualUnpackedHorizontalBoneNum;
+	if (ActualChainNum < 2)
 	{
 		return;
 	}
 
-	FScopedTranspose ScopedTranspose(&SimulationPlane);
-	ScopedTranspose.Add(&Positions);
-	ScopedTranspose.Execute();
+	const int32 PackedHorizontalBoneNum = SimulationPlane.PackedHorizontalBoneNum;
+	const int32 LastChainComponentIndex = (ActualChainNum - 1) % 4;
+	const int32 LastChainPackedHorizontalIndex = (ActualChainNum - 1) / 4;
 
-	for (const FHGMSIMDStructure& Structure : HorizontalStructures)
+	// Loop closing edge stays in registers when last chain is at last component, since its right neighbor is head of row.
+	const bool bLoopInRegister = bLoopHorizontalStructure && LastChainComponentIndex == 3;
+	const bool bLoopAcrossRegister = bLoopHorizontalStructure && LastChainComponentIndex < 3;
+
+	FHGMSIMDReal sComponentIndexes {};
+	FHGMSIMDLibrary::Load(sComponentIndexes, 0.0, 1.0, 2.0, 3.0);
+
+	FHGMSIMDReal sLastChainMask {};
+	FHGMSIMDLibrary::Load(sLastChainMask, StaticCast<FHGMReal>(LastChainComponentIndex));
+	sLastChainMask = sComponentIndexes == sLastChainMask;
+	const FHGMSIMDReal sFirstChainMask = sComponentIndexes == HGMSIMDConstants::ZeroReal;
+
+	// Edges run from each bone to right neighbor in same row, which is next component of same packed bone or first component of next one.
+	// Contact of end bones is shifted back to components holding them, so that edges are solved in vertical layout without transpose.
+	auto AddEdgeContacts = [&OutContacts](int32 PackedIndex, int32 NextPackedIndex, const FHGMSIMDReal& sActiveMask, const FHGMSIMDEdgeColliderContact& sEdgeContact)
 	{
-		const FHGMSIMDVector3& sSegmentStart = Positions[Structure.FirstBonePackedIndex];
-		const FHGMSIMDVector3& sSegmentEnd = Positions[Structure.SecondBonePackedIndex];
+		const FHGMSIMDReal sHitMask = sEdgeContact.sHitMask & sActiveMask;
+		const FHGMSIMDVector3 sSeparatingNormal = FHGMSIMDLibrary::Select(sActiveMask, sEdgeContact.sSeparatingNormal, FHGMSIMDVector3::ZeroVector);
+		OutContacts.Emplace(PackedIndex, sHitMask, sSeparatingNormal, sEdgeContact.sEdgeStartSeparatingOffset);
+
+		FHGMSIMDColliderContact sEndContact { PackedIndex, HGMSIMDConstants::ZeroReal, FHGMSIMDVector3::ZeroVector, HGMSIMDConstants::ZeroReal, HGMSIMDConstants::ZeroReal };
+		FHGMSIMDColliderContact sNextEndContact { NextPackedIndex, HGMSIMDConstants::ZeroReal, FHGMSIMDVector3::ZeroVector, HGMSIMDConstants::ZeroReal, HGMSIMDConstants::ZeroReal };
+		FHGMSIMDColliderContact& sHeadEndContact = NextPackedIndex == PackedIndex ? sEndContact : sNextEndContact;
+		FHGMSIMDLibrary::UnshiftComponentsLeft(sHitMask, sEndContact.sHitMask, sHeadEndContact.sHitMask);
+		FHGMSIMDLibrary::UnshiftComponentsLeft(sSeparatingNormal, sEndContact.sSeparatingNormal, sHeadEndContact.sSeparatingNormal);
+		FHGMSIMDLibrary::UnshiftComponentsLeft(sEdgeContact.sEdgeEndSeparatingOffset, sEndContact.sSeparatingOffset, sHeadEndContact.sSeparatingOffset);
+
+		OutContacts.Emplace(sEndContact);
+		if (NextPackedIndex != PackedIndex)
+		{
+			OutContacts.Emplace(sNextEndContact);
+		}
+	};
 
+	auto IntersectEdgeColliders = [&BodyCollider, &sContactMargin](const FHGMSIMDVector3& sSegmentStart, const FHGMSIMDVector3& sSegmentEnd, auto&& AddContacts)
+	{
 		// BoneEdge vs Sphere :
-		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.SphereColliders.Num(); ++ColliderIndex)
+		for (const FHGMSIMDSphereCollider& sSphereCollider : BodyCollider.SIMDSphereColliders)
 		{
-			const FHGMSphereCollider& SphereCollider = BodyCollider.SphereColliders[ColliderIndex];
-			if (!SphereCollider.bEnabled)
+			FHGMSIMDEdgeColliderContact sEdgeContact {};
+			if (IntersectEdgeSphere(sSegmentStart, sSegmentEnd, sSphereCollider, sContactMargin, sEdgeContact))
 			{
-				continue;
+				AddContacts(sEdgeContact);
 			}
+		}
 
-			FHGMSIMDSphereCollider sSphereCollider(SphereCollider);
+		// BoneEdge vs Capsule :
+		for (const FHGMSIMDCapsuleCollider& sCapsuleCollider : BodyCollider.SIMDCapsuleColliders)
+		{
 			FHGMSIMDEdgeColliderContact sEdgeContact {};
-
-			if (IntersectEdgeSphere(sSegmentStart, sSegmentEnd, sSphereCollider, sEdgeContact))
+			if (IntersectEdgeCapsule(sSegmentStart, sSegmentEnd, sCapsuleCollider, sContactMargin, sEdgeContact))
 			{
-				OutContacts.Emplace(Structure.FirstBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeStartSeparatingOffset);
-				OutContacts.Emplace(Structure.SecondBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeEndSeparatingOffset);
+				AddContacts(sEdgeContact);
 			}
 		}
+	};
 
-		// BoneEdge vs Capsule :
-		for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.CapsuleColliders.Num(); ++ColliderIndex)
+	for (int32 PackedHorizontalIndex = 0; PackedHorizontalIndex <= LastChainPackedHorizontalIndex; ++PackedHorizontalIndex)
+	{
+		// Components whose right neighbor is actual chain.
+		const bool bIsLastPackedHorizontalIndex = PackedHorizontalIndex == LastChainPackedHorizontalIndex;
+		const int32 ActiveEdgeNum = (ActualChainNum - 1) - (PackedHorizontalIndex * 4) + ((bIsLastPackedHorizontalIndex && bLoopInRegister) ? 1 : 0);
+		if (ActiveEdgeNum <= 0)
 		{
-			const FHGMCapsuleCollider& CapsuleCollider = BodyCollider.CapsuleColliders[ColliderIndex];
-			if (!CapsuleCollider.bEnabled)
+			continue;
+		}
+
+		FHGMSIMDReal sActiveMask {};
+		FHGMSIMDLibrary::Load(sActiveMask, StaticCast<FHGMReal>(ActiveEdgeNum));
+		sActiveMask = sComponentIndexes < sActiveMask;
+
+		for (int32 RowHeadPackedIndex = 0; RowHeadPackedIndex < Positions.Num(); RowHeadPackedIndex += PackedHorizontalBoneNum)
+		{
+			const int32 PackedIndex = RowHeadPackedIndex + PackedHorizontalIndex;
+			const int32 NextPackedIndex = (PackedHorizontalIndex + 1 < PackedHorizontalBoneNum) ? PackedIndex + 1 : RowHeadPackedIndex;
+
+			const FHGMSIMDVector3& sSegmentStart = Positions[PackedIndex];
+			const FHGMSIMDVector3 sSegmentEnd = FHGMSIMDLibrary::ShiftComponentsLeft(sSegmentStart, Positions[NextPackedIndex]);
+
+			IntersectEdgeColliders(sSegmentStart, sSegmentEnd, [&](const FHGMSIMDEdgeColliderContact& sEdgeContact)
 			{
-				continue;
-			}
+				AddEdgeContacts(PackedIndex, NextPackedIndex, sActiveMask, sEdgeContact);
+			});
+		}
+	}
 
-			FHGMCapsuleCollider sCapsuleCollider(CapsuleCollider);
-			FHGMSIMDEdgeColliderContact sEdgeContact {};
-			if (IntersectEdgeCapsule(sSegmentStart, sSegmentEnd, sCapsuleCollider, sEdgeContact))
+	// Loop closing edge from middle of packed bone to head of row is tested on all components and added only to components of its ends.
+	if (bLoopAcrossRegister)
+	{
+		for (int32 RowHeadPackedIndex = 0; RowHeadPackedIndex < Positions.Num(); RowHeadPackedIndex += PackedHorizontalBoneNum)
+		{
+			const int32 LastChainPackedIndex = RowHeadPackedIndex + LastChainPackedHorizontalIndex;
+
+			FHGMVector3 LastChainPosition {};
+			FHGMVector3 FirstChainPosition {};
+			FHGMSIMDLibrary::Store(Positions[LastChainPackedIndex], LastChainComponentIndex, LastChainPosition);
+			FHGMSIMDLibrary::Store(Positions[RowHeadPackedIndex], 0, FirstChainPosition);
+
+			FHGMSIMDVector3 sSegmentStart {};
+			FHGMSIMDVector3 sSegmentEnd {};
+			FHGMSIMDLibrary::Load(sSegmentStart, LastChainPosition);
+			FHGMSIMDLibrary::Load(sSegmentEnd, FirstChainPosition);
+
+			IntersectEdgeColliders(sSegmentStart, sSegmentEnd, [&](const FHGMSIMDEdgeColliderContact& sEdgeContact)
 			{
-				OutContacts.Emplace(Structure.FirstBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeStartSeparatingOffset);
-				OutContacts.Emplace(Structure.SecondBonePackedIndex, sEdgeContact.sHitMask, sEdgeContact.sSeparatingNormal, sEdgeContact.sEdgeEndSeparatingOffset);
-			}
+				OutContacts.Emplace(LastChainPackedIndex, sEdgeContact.sHitMask & sLastChainMask, FHGMSIMDLibrary::Select(sLastChainMask, sEdgeContact.sSeparatingNormal, FHGMSIMDVector3::ZeroVector), sEdgeContact.sEdgeStartSeparatingOffset);
+				OutContacts.Emplace(RowHeadPackedIndex, sEdgeContact.sHitMask & sFirstChainMask, FHGMSIMDLibrary::Select(sFirstChainMask, sEdgeContact.sSeparatingNormal, FHGMSIMDVector3::ZeroVector), sEdgeContact.sEdgeEndSeparatingOffset);
+			});
 		}
 	}
 }
 
 
+void FHGMCollisionLibrary::StoreContactSides(TArrayView<FHGMSIMDColliderContact> Contacts, TConstArrayView<FHGMSIMDVector3> Positions)
+{
+	for (FHGMSIMDColliderContact& Contact : Contacts)
+	{
+		Contact.sDetectionSeparation = FHGMMathLibrary::DotProduct(Positions[Contact.PackedIndex], Contact.sSeparatingNormal) - Contact.sSeparatingOffset;
+	}
+}
+
+
+bool FHGMCollisionLibrary::UpdateContactSides(TArrayView<FHGMSIMDColliderContact> Contacts, TConstArrayView<FHGMSIMDVector3> Positions, const FHGMSIMDReal& sContactMargin)
+{
+	// Plane is only linearization of collider around detected position.
+	// Bone that was separated at detection and is now deeper than margin has moved further than plane can be trusted, so it is flagged for redetection.
+	FHGMSIMDReal sCrossedMask = ~HGMSIMDConstants::AllBitMask;
+	for (FHGMSIMDColliderContact& Contact : Contacts)
+	{
+		// Components without contact store ZeroVector, and never hit.
+		const FHGMSIMDReal sActiveMask = FHGMMathLibrary::LengthSquared(Contact.sSeparatingNormal) > HGMSIMDConstants::ZeroReal;
+		const FHGMSIMDReal sSeparation = FHGMMathLibrary::DotProduct(Positions[Contact.PackedIndex], Contact.sSeparatingNormal) - Contact.sSeparatingOffset;
+
+		// Friction follows side bone is on now, instead of side at detection.
+		Contact.sHitMask = sActiveMask & (sSeparation < HGMSIMDConstants::ZeroReal);
+		sCrossedMask |= sActiveMask & (Contact.sDetectionSeparation >= HGMSIMDConstants::ZeroReal) & (sSeparation < -sContactMargin);
+	}
+
+	return FHGMSIMDLibrary::IsAnyMaskSet(sCrossedMask);
+}
+
+
 void FHGMCollisionLibrary::InitializePlaneColliders(const FBoneContainer& RequiredBones, TArrayView<FHGMPlaneCollider> PlaneColliders, TArray<FHGMSIMDPlaneCollider>& OutPlaneColliders)
 {
 	OutPlaneColliders.Reset(PlaneColliders.Num());
@@ -751,7 +1376,7 @@ void FHGMCollisionLibrary::UpdatePlaneColliders(FComponentSpacePoseContext& Outp
 }
 
 
-void FHGMCollisionLibrary::CalculatePlaneColliderContacts(TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders, TConstArrayView<FHGMSIMDReal> BoneSphereColliderRadiuses, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDColliderContact>& OutContacts)
+void FHGMCollisionLibrary::CalculatePlaneColliderContacts(TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders, const FHGMSIMDBoneParameter& BoneSphereColliderRadiuses, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, TArray<FHGMSIMDVector3>& Positions, const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDColliderContact>& OutContacts)
 {
 	if (PlaneColliders.Num() <= 0)
 	{
@@ -760,15 +1385,22 @@ void FHGMCollisionLibrary::CalculatePlaneColliderContacts(TConstArrayView<FHGMSI
 
 	for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
 	{
+		const FHGMSIMDReal sDummyBoneMask = ParticleParameters[PackedIndex].sDummyBoneMask > HGMSIMDConstants::ZeroReal;
+		if (!FHGMSIMDLibrary::IsAnyMaskSet(~sDummyBoneMask))
+		{
+			continue;
+		}
+
 		const FHGMSIMDVector3& sPosition = Positions[PackedIndex];
-		const FHGMSIMDReal& sBoneSphereColliderRadius = BoneSphereColliderRadiuses[PackedIndex];
+		const FHGMSIMDReal sBoneSphereColliderRadius = GetBoneSphereColliderRadius(BoneSphereColliderRadiuses, sDummyBoneMask, PackedIndex);
 		const FHGMSIMDSphereCollider sBoneSphereCollider(sPosition, sBoneSphereColliderRadius);
 
 		for (const FHGMSIMDPlaneCollider& sPlaneCollider : PlaneColliders)
 		{
 			FHGMSIMDColliderContact sContact {};
-			if (IntersectPlaneSphere(sPlaneCollider, sBoneSphereCollider, sContact))
+			if (IntersectPlaneSphere(sPlaneCollider, sBoneSphereCollider, sContactMargin, sContact))
 			{
+				ClearDummyBoneContact(sDummyBoneMask, sContact);
 				sContact.PackedIndex = PackedIndex;
 				OutContacts.Emplace(sContact);
 			}
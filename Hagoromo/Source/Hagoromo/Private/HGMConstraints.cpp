@@ -8,6 +8,7 @@
 #include "HGMSolvers.h"
 #include "HGMAnimation.h"
 
+#include "Algo/StableSort.h"
 #include "Animation/AnimNodeBase.h"
 
 
@@ -21,17 +22,168 @@ namespace
 		const FHGMSIMDReal sComplianceTilda = sCompliance / sDeltaTimeSquared;
 		return (sConstraint - sComplianceTilda * sLambda) / (sInverseSumMass + sComplianceTilda);
 	}
+
+
+	// Accumulates largest constraint error of current iteration. Used for residual-driven early termination.
+	// Compression is also counted, so that iterations do not terminate while bend and shear structures are still compressed.
+	FORCEINLINE static void AccumulateConstraintError(FHGMPhysicsContext& PhysicsContext, const FHGMSIMDReal& sLength, const FHGMSIMDReal& sDesiredLength, const FHGMSIMDReal& sIgnoreMask)
+	{
+		const FHGMSIMDReal sConstraintError = FHGMMathLibrary::Abs(sLength - sDesiredLength);
+		PhysicsContext.sMaxConstraintError = FHGMMathLibrary::Max(PhysicsContext.sMaxConstraintError, FHGMSIMDLibrary::Select(sIgnoreMask, HGMSIMDConstants::ZeroReal, sConstraintError));
+	}
+
+
+	// Reads bone of shear structure. Bone on right chain is shifted from PackedIndex and NextPackedIndex.
+	template<typename T>
+	FORCEINLINE static T LoadShearBone(TConstArrayView<T> Values, int32 PackedIndex, int32 NextPackedIndex)
+	{
+		if (NextPackedIndex < 0)
+		{
+			return Values[PackedIndex];
+		}
+
+		return FHGMSIMDLibrary::ShiftComponentsLeft(Values[PackedIndex], Values[NextPackedIndex]);
+	}
+
+
+	FORCEINLINE static void StoreShearBone(TArrayView<FHGMSIMDVector3> Positions, int32 PackedIndex, int32 NextPackedIndex, const FHGMSIMDVector3& sPosition)
+	{
+		if (NextPackedIndex < 0)
+		{
+			Positions[PackedIndex] = sPosition;
+			return;
+		}
+
+		FHGMSIMDLibrary::UnshiftComponentsLeft(sPosition, Positions[PackedIndex], Positions[NextPackedIndex]);
+	}
+
+
+	FORCEINLINE static FHGMSIMDParticleParameter LoadShearParticleParameter(TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, int32 PackedIndex, int32 NextPackedIndex)
+	{
+		if (NextPackedIndex < 0)
+		{
+			return ParticleParameters[PackedIndex];
+		}
+
+		const FHGMSIMDParticleParameter& A = ParticleParameters[PackedIndex];
+		const FHGMSIMDParticleParameter& B = ParticleParameters[NextPackedIndex];
+
+		FHGMSIMDParticleParameter ParticleParameter {};
+		ParticleParameter.sInverseMass = FHGMSIMDLibrary::ShiftComponentsLeft(A.sInverseMass, B.sInverseMass);
+		ParticleParameter.sFixedBlend = FHGMSIMDLibrary::ShiftComponentsLeft(A.sFixedBlend, B.sFixedBlend);
+		ParticleParameter.sDummyBoneMask = FHGMSIMDLibrary::ShiftComponentsLeft(A.sDummyBoneMask, B.sDummyBoneMask);
+		ParticleParameter.sMovableWeight = FHGMSIMDLibrary::ShiftComponentsLeft(A.sMovableWeight, B.sMovableWeight);
+		return ParticleParameter;
+	}
+
+
+	// Gathers parameters of 4 bones by unpacked index. Used only by shear structures that can not shift components.
+	static FHGMSIMDParticleParameter GatherParticleParameter(TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, const FHGMSIMDInt& sUnpackedIndex)
+	{
+		TStaticArray<int32, 4> UnpackedIndexes {};
+		FHGMSIMDLibrary::Store(sUnpackedIndex, UnpackedIndexes);
+
+		FHGMSIMDParticleParameter ParticleParameter {};
+		for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
+		{
+			const FHGMSIMDParticleParameter& Source = ParticleParameters[UnpackedIndexes[ComponentIndex] / 4];
+			const uint32 SourceComponentIndex = UnpackedIndexes[ComponentIndex] % 4;
+
+			FHGMReal Value = 0.0;
+			FHGMSIMDLibrary::Store(Source.sInverseMass, SourceComponentIndex, Value);
+			FHGMSIMDLibrary::Load(ParticleParameter.sInverseMass, ComponentIndex, Value);
+			FHGMSIMDLibrary::Store(Source.sFixedBlend, SourceComponentIndex, Value);
+			FHGMSIMDLibrary::Load(ParticleParameter.sFixedBlend, ComponentIndex, Value);
+			FHGMSIMDLibrary::Store(Source.sDummyBoneMask, SourceComponentIndex, Value);
+			FHGMSIMDLibrary::Load(ParticleParameter.sDummyBoneMask, ComponentIndex, Value);
+			FHGMSIMDLibrary::Store(Source.sMovableWeight, SourceComponentIndex, Value);
+			FHGMSIMDLibrary::Load(ParticleParameter.sMovableWeight, ComponentIndex, Value);
+		}
+
+		return ParticleParameter;
+	}
+
+
+	// Distance constraint shared by vertical structure and vertical bend.
+	static void SolveDistanceConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, const FHGMSIMDReal& sCompliance)
+	{
+		const FHGMSIMDReal sDeltaTimeSquared = PhysicsContext.sDeltaTime * PhysicsContext.sDeltaTime;
+
+		for (FHGMSIMDStructure& Structure : Structures)
+		{
+			FHGMSIMDVector3& sFirstBonePosition = Positions[Structure.FirstBonePackedIndex];
+			FHGMSIMDVector3& sSecondBonePosition = Positions[Structure.SecondBonePackedIndex];
+
+			const FHGMSIMDVector3 sToFirst = sFirstBonePosition - sSecondBonePosition;
+			const FHGMSIMDReal sCurrentLenght =FHGMMathLibrary::Length(sToFirst);
+			const FHGMSIMDVector3 sToFirstDirection = FHGMMathLibrary::MakeSafeNormal(sToFirst);
+
+			const FHGMSIMDParticleParameter& FirstBoneParameter = ParticleParameters[Structure.FirstBonePackedIndex];
+			const FHGMSIMDParticleParameter& SecondBoneParameter = ParticleParameters[Structure.SecondBonePackedIndex];
+
+			FHGMSIMDReal sFirstBoneCoefficient = HGMSIMDConstants::OneReal;
+			sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - FirstBoneParameter.sFixedBlend);
+			sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - SecondBoneParameter.sDummyBoneMask);
+
+			FHGMSIMDReal sSecondBoneCoefficient = HGMSIMDConstants::OneReal;
+			sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - SecondBoneParameter.sFixedBlend);
+			sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - FirstBoneParameter.sDummyBoneMask);
+
+			const FHGMSIMDReal sIgnoreMask = sFirstBoneCoefficient <= HGMSIMDConstants::ZeroReal & sSecondBoneCoefficient <= HGMSIMDConstants::ZeroReal;
+			AccumulateConstraintError(PhysicsContext, sCurrentLenght, Structure.sLength, sIgnoreMask);
+
+			FHGMSIMDReal sDeltaLambda = ComputeDeltaLambda(sCurrentLenght, sToFirstDirection, Structure.sLength, FirstBoneParameter.sInverseMass + SecondBoneParameter.sInverseMass, sCompliance, Structure.sLambda, sDeltaTimeSquared);
+			sDeltaLambda = FHGMSIMDLibrary::Select(sIgnoreMask, HGMSIMDConstants::ZeroReal, sDeltaLambda);
+			Structure.sLambda += sDeltaLambda;
+
+			sFirstBonePosition -= sToFirstDirection * sDeltaLambda * sFirstBoneCoefficient * FirstBoneParameter.sInverseMass;
+			sSecondBonePosition += sToFirstDirection * sDeltaLambda * sSecondBoneCoefficient * SecondBoneParameter.sInverseMass;
+		}
+	}
+
+
+	static void SolveTetherConstraint(TArrayView<FHGMSIMDTether> Tethers, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
+	{
+		const FHGMSIMDReal sDeltaTimeSquared = PhysicsContext.sDeltaTime * PhysicsContext.sDeltaTime;
+
+		for (FHGMSIMDTether& Tether : Tethers)
+		{
+			const FHGMSIMDVector3& sRootBonePosition = Positions[Tether.RootBonePackedIndex];
+			FHGMSIMDVector3& sBonePosition = Positions[Tether.BonePackedIndex];
+
+			const FHGMSIMDVector3 sToRoot = sRootBonePosition - sBonePosition;
+			const FHGMSIMDReal sCurrentLenght = FHGMMathLibrary::Length(sToRoot);
+			const FHGMSIMDVector3 sToRootDirection = FHGMMathLibrary::MakeSafeNormal(sToRoot);
+
+			const FHGMSIMDParticleParameter& RootBoneParameter = ParticleParameters[Tether.RootBonePackedIndex];
+			const FHGMSIMDParticleParameter& BoneParameter = ParticleParameters[Tether.BonePackedIndex];
+
+			// Root bone is treated as kinematic, so only effective when it is fixed.
+			FHGMSIMDReal sBoneCoefficient = RootBoneParameter.sFixedBlend;
+			sBoneCoefficient *= (HGMSIMDConstants::OneReal - BoneParameter.sFixedBlend);
+			sBoneCoefficient *= (HGMSIMDConstants::OneReal - BoneParameter.sDummyBoneMask);
+
+			const FHGMSIMDReal sIgnoreMask = sBoneCoefficient <= HGMSIMDConstants::ZeroReal;
+			AccumulateConstraintError(PhysicsContext, sCurrentLenght, Tether.sLength, sIgnoreMask);
+
+			FHGMSIMDReal sDeltaLambda = ComputeDeltaLambda(sCurrentLenght, sToRootDirection, Tether.sLength, BoneParameter.sInverseMass, Tether.sCompliance, Tether.sLambda, sDeltaTimeSquared);
+			sDeltaLambda = FHGMSIMDLibrary::Select(sIgnoreMask, HGMSIMDConstants::ZeroReal, sDeltaLambda);
+			Tether.sLambda += sDeltaLambda;
+
+			sBonePosition += sToRootDirection * sDeltaLambda * sBoneCoefficient * BoneParameter.sInverseMass;
+		}
+	}
 }
 
 
-void FHGMConstraintLibrary::FixedBlendConstraint(TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDVector3>& PrevPositions, const TArray<FHGMSIMDVector3>& AnimPositions, const TArray<FHGMSIMDReal>& FixedBlends)
+void FHGMConstraintLibrary::FixedBlendConstraint(TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDVector3>& PrevPositions, const TArray<FHGMSIMDVector3>& AnimPositions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
 {
 	for (int32 PackedIndex { 0 }; PackedIndex < Positions.Num(); PackedIndex++)
 	{
 		FHGMSIMDVector3& sPosition = Positions[PackedIndex];
 		FHGMSIMDVector3& sPrevPosition = PrevPositions[PackedIndex];
 		const FHGMSIMDVector3& sAnimPosition = AnimPositions[PackedIndex];
-		const FHGMSIMDReal& sFixedBlend = FixedBlends[PackedIndex];
+		const FHGMSIMDReal& sFixedBlend = ParticleParameters[PackedIndex].sFixedBlend;
 
 		sPosition = FHGMMathLibrary::Lerp(sPosition, sAnimPosition, sFixedBlend);
 		sPrevPosition = FHGMMathLibrary::Lerp(sPrevPosition, sAnimPosition, sFixedBlend);
@@ -39,7 +191,7 @@ void FHGMConstraintLibrary::FixedBlendConstraint(TArray<FHGMSIMDVector3>& Positi
 }
 
 
-void FHGMConstraintLibrary::ColliderContactConstraint(const TArray<FHGMSIMDColliderContact>& Contacts, const FHGMSIMDReal& sCollisionBlend, const FHGMSIMDReal& sColliderPenetrationDepth, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks)
+void FHGMConstraintLibrary::ColliderContactConstraint(const TArray<FHGMSIMDColliderContact>& Contacts, const FHGMSIMDReal& sCollisionBlend, const FHGMSIMDReal& sColliderPenetrationDepth, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
 {
 	for (const FHGMSIMDColliderContact& Contact : Contacts)
 	{
@@ -50,7 +202,7 @@ void FHGMConstraintLibrary::ColliderContactConstraint(const TArray<FHGMSIMDColli
 		FHGMSIMDReal sPushAmountWithPenetrationDepth = sPushAmountWithBlend - sColliderPenetrationDepth;
 		FHGMSIMDReal sFinalPushAmount = FHGMSIMDLibrary::Select(sPushAmountWithPenetrationDepth > HGMSIMDConstants::ZeroReal, sPushAmountWithPenetrationDepth, sPushAmountWithBlend);
 
-		sPosition += sFinalPushAmount * Contact.sSeparatingNormal * (HGMSIMDConstants::OneReal - FixedBlends[Contact.PackedIndex]) * (HGMSIMDConstants::OneReal - DummyBoneMasks[Contact.PackedIndex]);
+		sPosition += sFinalPushAmount * Contact.sSeparatingNormal * ParticleParameters[Contact.PackedIndex].sMovableWeight;
 	}
 }
 
@@ -93,52 +245,149 @@ void FHGMConstraintLibrary::MakeVerticalStructure(const FHGMSimulationPlane& Sim
 }
 
 
-void FHGMConstraintLibrary::VerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> InverseMasses, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks)
+void FHGMConstraintLibrary::MakeParticleParameters(TConstArrayView<FHGMSIMDReal> InverseMasses, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks, TArray<FHGMSIMDParticleParameter>& OutParticleParameters)
 {
-	SCOPE_CYCLE_COUNTER(STAT_ConstraintVerticalStructuralConstraint);
+	OutParticleParameters.Reset(InverseMasses.Num());
+	for (int32 PackedIndex = 0; PackedIndex < InverseMasses.Num(); ++PackedIndex)
+	{
+		FHGMSIMDParticleParameter ParticleParameter {};
+		ParticleParameter.sInverseMass = InverseMasses[PackedIndex];
+		ParticleParameter.sFixedBlend = FixedBlends[PackedIndex];
+		ParticleParameter.sDummyBoneMask = DummyBoneMasks[PackedIndex];
+		ParticleParameter.sMovableWeight = (HGMSIMDConstants::OneReal - FixedBlends[PackedIndex]) * (HGMSIMDConstants::OneReal - DummyBoneMasks[PackedIndex]);
+		OutParticleParameters.Emplace(MoveTemp(ParticleParameter));
+	}
+}
 
-	const FHGMSIMDReal sDeltaTimeSquared = PhysicsContext.sDeltaTime * PhysicsContext.sDeltaTime;
+
+void FHGMConstraintLibrary::VerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ConstraintVerticalStructuralConstraint);
 
 	FHGMSIMDReal sStructureStiffness {};
 	FHGMSIMDLibrary::Load(sStructureStiffness, PhysicsContext.PhysicsSettings.StructureStiffness);
 
-	for (FHGMSIMDStructure& Structure : Structures)
+	SolveDistanceConstraint(Structures, PhysicsContext, Positions, ParticleParameters, sStructureStiffness);
+}
+
+
+void FHGMConstraintLibrary::DirectVerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, const FHGMSimulationPlane& SimulationPlane, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ConstraintVerticalStructuralConstraint);
+
+	const int32 PackedHorizontalBoneNum = SimulationPlane.PackedHorizontalBoneNum;
+	if (PackedHorizontalBoneNum <= 0 || Structures.IsEmpty())
 	{
-		FHGMSIMDVector3& sFirstBonePosition = Positions[Structure.FirstBonePackedIndex];
-		FHGMSIMDVector3& sSecondBonePosition = Positions[Structure.SecondBonePackedIndex];
+		return;
+	}
 
-		const FHGMSIMDVector3 sToFirst = sFirstBonePosition - sSecondBonePosition;
-		const FHGMSIMDReal sCurrentLenght =FHGMMathLibrary::Length(sToFirst);
-		const FHGMSIMDVector3 sToFirstDirection = FHGMMathLibrary::MakeSafeNormal(sToFirst);
+	// Structures are arranged row by row, so each packed column is 4 chains of ChainStructureNum constraints.
+	const int32 ChainStructureNum = Structures.Num() / PackedHorizontalBoneNum;
+
+	const FHGMSIMDReal sDeltaTimeSquared = PhysicsContext.sDeltaTime * PhysicsContext.sDeltaTime;
+
+	FHGMSIMDReal sCompliance {};
+	FHGMSIMDLibrary::Load(sCompliance, PhysicsContext.PhysicsSettings.StructureStiffness);
+	const FHGMSIMDReal sComplianceTilda = sCompliance / sDeltaTimeSquared;
+
+	FHGMScopedScratchMemory ScratchMemory {};
+	TArray<FHGMSIMDVector3, TMemStackAllocator<>> Directions {};
+	TArray<FHGMSIMDReal, TMemStackAllocator<>> FirstWeights {};
+	TArray<FHGMSIMDReal, TMemStackAllocator<>> SecondWeights {};
+	TArray<FHGMSIMDReal, TMemStackAllocator<>> SharedWeights {};
+	TArray<FHGMSIMDReal, TMemStackAllocator<>> ActiveMasks {};
+	TArray<FHGMSIMDReal, TMemStackAllocator<>> Diagonals {};
+	TArray<FHGMSIMDReal, TMemStackAllocator<>> UpperDiagonals {};
+	TArray<FHGMSIMDReal, TMemStackAllocator<>> DeltaLambdas {};
+	Directions.SetNumUninitialized(ChainStructureNum);
+	FirstWeights.SetNumUninitialized(ChainStructureNum);
+	SecondWeights.SetNumUninitialized(ChainStructureNum);
+	SharedWeights.SetNumUninitialized(ChainStructureNum);
+	ActiveMasks.SetNumUninitialized(ChainStructureNum);
+	Diagonals.SetNumUninitialized(ChainStructureNum);
+	UpperDiagonals.SetNumUninitialized(ChainStructureNum);
+	DeltaLambdas.SetNumUninitialized(ChainStructureNum);
+
+	for (int32 PackedX = 0; PackedX < PackedHorizontalBoneNum; ++PackedX)
+	{
+		// Build diagonal and right-hand side of J * W * J^T + Compliance.
+		for (int32 Row = 0; Row < ChainStructureNum; ++Row)
+		{
+			const FHGMSIMDStructure& Structure = Structures[Row * PackedHorizontalBoneNum + PackedX];
 
-		const FHGMSIMDReal& sFirstInverseMass = InverseMasses[Structure.FirstBonePackedIndex];
-		const FHGMSIMDReal& sSecondInverseMass = InverseMasses[Structure.SecondBonePackedIndex];
+			const FHGMSIMDVector3 sToFirst = Positions[Structure.FirstBonePackedIndex] - Positions[Structure.SecondBonePackedIndex];
+			const FHGMSIMDReal sCurrentLenght = FHGMMathLibrary::Length(sToFirst);
+			Directions[Row] = FHGMMathLibrary::MakeSafeNormal(sToFirst);
 
-		const FHGMSIMDReal& sFirstBoneFixedBlend = FixedBlends[Structure.FirstBonePackedIndex];
-		const FHGMSIMDReal& sSecondBoneFixedBlend = FixedBlends[Structure.SecondBonePackedIndex];
+			const FHGMSIMDParticleParameter& FirstBoneParameter = ParticleParameters[Structure.FirstBonePackedIndex];
+			const FHGMSIMDParticleParameter& SecondBoneParameter = ParticleParameters[Structure.SecondBonePackedIndex];
 
-		const FHGMSIMDReal& sFirstBoneDummyMask = DummyBoneMasks[Structure.FirstBonePackedIndex];
-		const FHGMSIMDReal& sSecondBoneDummyMask = DummyBoneMasks[Structure.SecondBonePackedIndex];
+			const FHGMSIMDReal sFirstBoneCoefficient = (HGMSIMDConstants::OneReal - FirstBoneParameter.sFixedBlend) * (HGMSIMDConstants::OneReal - SecondBoneParameter.sDummyBoneMask);
+			const FHGMSIMDReal sSecondBoneCoefficient = (HGMSIMDConstants::OneReal - SecondBoneParameter.sFixedBlend) * (HGMSIMDConstants::OneReal - FirstBoneParameter.sDummyBoneMask);
 
-		FHGMSIMDReal sFirstBoneCoefficient = HGMSIMDConstants::OneReal;
-		sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - sFirstBoneFixedBlend);
-		sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - sSecondBoneDummyMask);
+			FirstWeights[Row] = FirstBoneParameter.sInverseMass * sFirstBoneCoefficient;
+			SecondWeights[Row] = SecondBoneParameter.sInverseMass * sSecondBoneCoefficient;
+			SharedWeights[Row] = FirstBoneParameter.sInverseMass * (HGMSIMDConstants::OneReal - FirstBoneParameter.sFixedBlend);
 
-		FHGMSIMDReal sSecondBoneCoefficient = HGMSIMDConstants::OneReal;
-		sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - sSecondBoneFixedBlend);
-		sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - sFirstBoneDummyMask);
+			const FHGMSIMDReal sIgnoreMask = sFirstBoneCoefficient <= HGMSIMDConstants::ZeroReal & sSecondBoneCoefficient <= HGMSIMDConstants::ZeroReal;
+			AccumulateConstraintError(PhysicsContext, sCurrentLenght, Structure.sLength, sIgnoreMask);
 
-		FHGMSIMDReal sDeltaLambda = ComputeDeltaLambda(sCurrentLenght, sToFirstDirection, Structure.sLength, sFirstInverseMass + sSecondInverseMass, sStructureStiffness, Structure.sLambda, sDeltaTimeSquared);
-		sDeltaLambda = FHGMSIMDLibrary::Select(sFirstBoneCoefficient <= HGMSIMDConstants::ZeroReal & sSecondBoneCoefficient <= HGMSIMDConstants::ZeroReal, HGMSIMDConstants::ZeroReal, sDeltaLambda);
-		Structure.sLambda += sDeltaLambda;
+			// Constrained only when extended to prevent vibration, same as iterative solve.
+			// Inactive rows are replaced with identity so that they are decoupled from chain.
+			const FHGMSIMDReal sConstraint = sCurrentLenght - Structure.sLength;
+			const FHGMSIMDReal sInactiveMask = sIgnoreMask | (sConstraint <= HGMSIMDConstants::ZeroReal);
+			ActiveMasks[Row] = FHGMSIMDLibrary::Select(sInactiveMask, HGMSIMDConstants::ZeroReal, HGMSIMDConstants::OneReal);
+			Diagonals[Row] = FHGMSIMDLibrary::Select(sInactiveMask, HGMSIMDConstants::OneReal, FirstWeights[Row] + SecondWeights[Row] + sComplianceTilda);
+			DeltaLambdas[Row] = FHGMSIMDLibrary::Select(sInactiveMask, HGMSIMDConstants::ZeroReal, sConstraint - sComplianceTilda * Structure.sLambda);
+		}
 
-		sFirstBonePosition -= sToFirstDirection * sDeltaLambda * sFirstBoneCoefficient * sFirstInverseMass;
-		sSecondBonePosition += sToFirstDirection * sDeltaLambda * sSecondBoneCoefficient * sSecondInverseMass;
+		// Forward elimination of Thomas algorithm.
+		// Adjacent constraints share a bone, and coupling term is W * dot(-Direction(i - 1), Direction(i)).
+		FHGMSIMDReal sPrevUpperDiagonal = HGMSIMDConstants::ZeroReal;
+		FHGMSIMDReal sPrevDeltaLambda = HGMSIMDConstants::ZeroReal;
+		for (int32 Row = 0; Row < ChainStructureNum; ++Row)
+		{
+			FHGMSIMDReal sLowerDiagonal = HGMSIMDConstants::ZeroReal;
+			if (Row > 0)
+			{
+				sLowerDiagonal = -FHGMMathLibrary::DotProduct(Directions[Row - 1], Directions[Row]) * SharedWeights[Row] * ActiveMasks[Row - 1] * ActiveMasks[Row];
+			}
+
+			FHGMSIMDReal sUpperDiagonal = HGMSIMDConstants::ZeroReal;
+			if (Row < ChainStructureNum - 1)
+			{
+				sUpperDiagonal = -FHGMMathLibrary::DotProduct(Directions[Row], Directions[Row + 1]) * SharedWeights[Row + 1] * ActiveMasks[Row] * ActiveMasks[Row + 1];
+			}
+
+			const FHGMSIMDReal sPivot = FHGMMathLibrary::Max(Diagonals[Row] - sLowerDiagonal * sPrevUpperDiagonal, HGMSIMDConstants::SmallReal);
+			UpperDiagonals[Row] = sUpperDiagonal / sPivot;
+			DeltaLambdas[Row] = (DeltaLambdas[Row] - sLowerDiagonal * sPrevDeltaLambda) / sPivot;
+
+			sPrevUpperDiagonal = UpperDiagonals[Row];
+			sPrevDeltaLambda = DeltaLambdas[Row];
+		}
+
+		// Back substitution.
+		for (int32 Row = ChainStructureNum - 2; Row >= 0; --Row)
+		{
+			DeltaLambdas[Row] -= UpperDiagonals[Row] * DeltaLambdas[Row + 1];
+		}
+
+		// Apply corrections. All of them are linearized at same positions, so order does not matter.
+		for (int32 Row = 0; Row < ChainStructureNum; ++Row)
+		{
+			FHGMSIMDStructure& Structure = Structures[Row * PackedHorizontalBoneNum + PackedX];
+			const FHGMSIMDReal& sDeltaLambda = DeltaLambdas[Row];
+			Structure.sLambda += sDeltaLambda;
+
+			Positions[Structure.FirstBonePackedIndex] -= Directions[Row] * sDeltaLambda * FirstWeights[Row];
+			Positions[Structure.SecondBonePackedIndex] += Directions[Row] * sDeltaLambda * SecondWeights[Row];
+		}
 	}
 }
 
 
-void FHGMConstraintLibrary::RigidVerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> FixedBlends)
+void FHGMConstraintLibrary::RigidVerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
 {
 	for (FHGMSIMDStructure& Structure : Structures)
 	{
@@ -150,7 +399,7 @@ void FHGMConstraintLibrary::RigidVerticalStructuralConstraint(TArrayView<FHGMSIM
 		const FHGMSIMDVector3 sToFirstDirection = FHGMMathLibrary::MakeSafeNormal(sToFirst);
 
 		const FHGMSIMDVector3 sConstraintedSecondBonePosition = (sCurrentLenght - Structure.sLength) * sToFirstDirection + sSecondBonePosition;
-		sSecondBonePosition = FHGMSIMDLibrary::Select(FixedBlends[Structure.SecondBonePackedIndex] <= HGMSIMDConstants::ZeroReal, sConstraintedSecondBonePosition, sSecondBonePosition);
+		sSecondBonePosition = FHGMSIMDLibrary::Select(ParticleParameters[Structure.SecondBonePackedIndex].sFixedBlend <= HGMSIMDConstants::ZeroReal, sConstraintedSecondBonePosition, sSecondBonePosition);
 	}
 }
 
@@ -189,21 +438,31 @@ void FHGMConstraintLibrary::MakeHorizontalStructure(FHGMSimulationPlane& Simulat
 			OutHorizontalStructures.Emplace(MoveTemp(Constraint));
 		}
 	}
+
+	// Links sharing a bone are separated into different colors, so each link does not wait for the result of the previous one.
+	const int32 PackedHorizontalBoneNum = SimulationPlane.PackedHorizontalBoneNum;
+	Algo::StableSortBy(OutHorizontalStructures, [PackedHorizontalBoneNum](const FHGMSIMDStructure& Structure)
+	{
+		const int32 FirstBoneStep = Structure.FirstBonePackedIndex / PackedHorizontalBoneNum;
+		const int32 SecondBoneStep = Structure.SecondBonePackedIndex / PackedHorizontalBoneNum;
+
+		// Link closing loop of odd number of chains conflicts with both colors.
+		const bool bIsOddLoopLink = SecondBoneStep < FirstBoneStep && (FirstBoneStep % 2) == 0;
+		return bIsOddLoopLink ? 2 : FirstBoneStep % 2;
+	});
 }
 
 
-void FHGMConstraintLibrary::HorizontalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, FHGMSimulationPlane& SimulationPlane, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDReal>& InverseMasses, TArray<FHGMSIMDReal>& FixedBlends, TArray<FHGMSIMDReal>& DummyBoneMasks)
+void FHGMConstraintLibrary::HorizontalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, const FHGMSimulationPlane& SimulationPlane, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> HorizontalPositions, TConstArrayView<FHGMSIMDParticleParameter> HorizontalParticleParameters)
 {
 	SCOPE_CYCLE_COUNTER(STAT_ConstraintHorizontalStructuralConstraint);
 
-	FScopedTranspose ScopedTranspose(&SimulationPlane);
-	ScopedTranspose.Add(&Positions);
-	ScopedTranspose.Add(&InverseMasses);
-	ScopedTranspose.Add(&FixedBlends);
-	ScopedTranspose.Add(&DummyBoneMasks);
-	ScopedTranspose.Execute();
+	FHGMSimulationPlane HorizontalSimulationPlane = SimulationPlane;
+	FHGMSolverLibrary::Transpose(HorizontalSimulationPlane);
 
-	FHGMConstraintLibrary::VerticalStructuralConstraint(Structures, PhysicsContext, Positions, InverseMasses, FixedBlends, DummyBoneMasks);
+	FHGMSolverLibrary::Transpose<FHGMSIMDVector3, FHGMVector3>(SimulationPlane, Positions, HorizontalPositions);
+	FHGMConstraintLibrary::VerticalStructuralConstraint(Structures, PhysicsContext, HorizontalPositions, HorizontalParticleParameters);
+	FHGMSolverLibrary::Transpose<FHGMSIMDVector3, FHGMVector3>(HorizontalSimulationPlane, HorizontalPositions, Positions);
 }
 
 
@@ -211,87 +470,119 @@ void FHGMConstraintLibrary::MakeShearStructure(const FHGMSimulationPlane& Simula
 {
 	OutShearStructures.Reset((SimulationPlane.PackedVerticalBoneNum - 1) * (SimulationPlane.ActualUnpackedHorizontalBoneNum / 4 )* 2);
 
-	int32 PackedIndex = 0;
-	while(PackedIndex < Positions.Num())
-	{
-		// Process ends here because no constraint target is found at end.
-		const int32 VerticalBoneStep = PackedIndex / SimulationPlane.PackedHorizontalBoneNum;
-		const bool bIsEndVerticalBone = (VerticalBoneStep == (SimulationPlane.UnpackedVerticalBoneNum - 1));
-		if (bIsEndVerticalBone)
-		{
-			break;
-		}
+	const int32 PackedHorizontalBoneNum = SimulationPlane.PackedHorizontalBoneNum;
+	const int32 StructureVerticalBoneNum = SimulationPlane.UnpackedVerticalBoneNum - 1;
 
-		int32 LoopIncreaseValue = 1;
-		int32 RightUnpackedEndIndex = 0;
-		int32 LowerRightUnpackedEndIndex = 0;
-		int32 EndComponentIndex = 3;
+	FHGMSIMDReal sComponentIndexes {};
+	FHGMSIMDLibrary::Load(sComponentIndexes, 0.0, 1.0, 2.0, 3.0);
 
-		bool bIsEndHorizontalBone = ((PackedIndex % SimulationPlane.PackedHorizontalBoneNum)) + 1 == SimulationPlane.PackedHorizontalBoneNum;
-		if (bIsEndHorizontalBone)
+	// Bones of one diagonal direction in one row are never shared, so each (row parity, direction) becomes one color.
+	for (int32 RowParity = 0; RowParity < 2; ++RowParity)
+	{
+		for (int32 Direction = 0; Direction < 2; ++Direction)
 		{
-			EndComponentIndex = (SimulationPlane.ActualUnpackedHorizontalBoneNum - 1) % 4;
+			const bool bIsLowerRightDiagonal = Direction == 0;
 
-			if (bLoopHorizontalStructure)
+			for (int32 VerticalBoneStep = RowParity; VerticalBoneStep < StructureVerticalBoneNum; VerticalBoneStep += 2)
 			{
-				RightUnpackedEndIndex = (VerticalBoneStep * SimulationPlane.PackedHorizontalBoneNum) * 4;
-				LowerRightUnpackedEndIndex = ((VerticalBoneStep + 1) * SimulationPlane.PackedHorizontalBoneNum) * 4;
+				for (int32 HorizontalBoneStep = 0; HorizontalBoneStep < PackedHorizontalBoneNum; ++HorizontalBoneStep)
+				{
+					const int32 PackedIndex = VerticalBoneStep * PackedHorizontalBoneNum + HorizontalBoneStep;
+					const int32 LowerBonePackedIndex = PackedIndex + PackedHorizontalBoneNum;
+
+					int32 RightUnpackedEndIndex = 0;
+					int32 LowerRightUnpackedEndIndex = 0;
+					int32 EndComponentIndex = 3;
+
+					// Packed bone holding first component of right neighbor. Wraps to row head at end.
+					int32 NextPackedIndex = PackedIndex + 1;
+
+					bool bIsEndHorizontalBone = HorizontalBoneStep + 1 == PackedHorizontalBoneNum;
+					if (bIsEndHorizontalBone)
+					{
+						EndComponentIndex = (SimulationPlane.ActualUnpackedHorizontalBoneNum - 1) % 4;
+						NextPackedIndex = VerticalBoneStep * PackedHorizontalBoneNum;
+
+						if (bLoopHorizontalStructure)
+						{
+							RightUnpackedEndIndex = (VerticalBoneStep * PackedHorizontalBoneNum) * 4;
+							LowerRightUnpackedEndIndex = ((VerticalBoneStep + 1) * PackedHorizontalBoneNum) * 4;
+						}
+					}
+					else
+					{
+						LowerRightUnpackedEndIndex = (LowerBonePackedIndex + 1) * 4;
+						RightUnpackedEndIndex = (PackedIndex + 1) * 4;
+					}
+
+					// Last component has no right neighbor unless loop is closed.
+					const int32 ActiveEndComponentIndex = (bIsEndHorizontalBone && !bLoopHorizontalStructure) ? EndComponentIndex - 1 : EndComponentIndex;
+					if (ActiveEndComponentIndex < 0)
+					{
+						continue;
+					}
+
+					// When loop closes in middle of packed bone, right neighbor of last component is not adjacent.
+					const bool bCanShiftComponents = !(bIsEndHorizontalBone && bLoopHorizontalStructure && EndComponentIndex < 3);
+
+					FHGMSIMDShearStructure sShear {};
+					FHGMSIMDReal sActiveEndComponentIndex {};
+					FHGMSIMDLibrary::Load(sActiveEndComponentIndex, StaticCast<FHGMReal>(ActiveEndComponentIndex));
+					sShear.sActiveMask = sComponentIndexes <= sActiveEndComponentIndex;
+
+					if (bIsLowerRightDiagonal)
+					{
+						// Diagonal constraint in lower right direction.
+						if (bCanShiftComponents)
+						{
+							sShear.FirstBonePackedIndex = PackedIndex;
+							sShear.SecondBonePackedIndex = LowerBonePackedIndex;
+							sShear.SecondBoneNextPackedIndex = NextPackedIndex + PackedHorizontalBoneNum;
+						}
+
+						FHGMSIMDLibrary::Load(sShear.sFirstBoneUnpackedIndex, PackedIndex * 4 + 0, PackedIndex * 4 + 1, PackedIndex * 4 + 2, PackedIndex * 4 + 3);
+						FHGMSIMDLibrary::Load(sShear.sSecondBoneUnpackedIndex, LowerBonePackedIndex * 4 + 1, LowerBonePackedIndex * 4 + 2, LowerBonePackedIndex * 4 + 3, LowerRightUnpackedEndIndex);
+						if (bLoopHorizontalStructure)
+						{
+							FHGMSIMDLibrary::Load(sShear.sSecondBoneUnpackedIndex, EndComponentIndex, LowerRightUnpackedEndIndex);
+						}
+					}
+					else
+					{
+						// Diagonal constraint in lower left direction.
+						if (bCanShiftComponents)
+						{
+							sShear.FirstBonePackedIndex = PackedIndex;
+							sShear.FirstBoneNextPackedIndex = NextPackedIndex;
+							sShear.SecondBonePackedIndex = LowerBonePackedIndex;
+						}
+
+						FHGMSIMDLibrary::Load(sShear.sFirstBoneUnpackedIndex, PackedIndex * 4 + 1, PackedIndex * 4 + 2, PackedIndex * 4 + 3, RightUnpackedEndIndex);
+						if (bLoopHorizontalStructure)
+						{
+							FHGMSIMDLibrary::Load(sShear.sFirstBoneUnpackedIndex, EndComponentIndex, RightUnpackedEndIndex);
+						}
+
+						FHGMSIMDLibrary::Load(sShear.sSecondBoneUnpackedIndex, LowerBonePackedIndex * 4 + 0, LowerBonePackedIndex * 4 + 1, LowerBonePackedIndex * 4 + 2, LowerBonePackedIndex * 4 + 3);
+					}
+
+					FHGMSIMDVector3 sFirstBonePosition {};
+					FHGMSIMDLibrary::Store(Positions, sShear.sFirstBoneUnpackedIndex, sFirstBonePosition);
+
+					FHGMSIMDVector3 sSecondBonePosition {};
+					FHGMSIMDLibrary::Store(Positions, sShear.sSecondBoneUnpackedIndex, sSecondBonePosition);
+
+					sShear.sLength = FHGMMathLibrary::Length(sSecondBonePosition - sFirstBonePosition);
+					sShear.sLambda = HGMSIMDConstants::ZeroReal;
+					OutShearStructures.Emplace(MoveTemp(sShear));
+				}
 			}
 		}
-		else
-		{
-			const int32 LowerBonePackedIndex = PackedIndex + SimulationPlane.PackedHorizontalBoneNum;
-			const int32 LowerRightPackedIndex = LowerBonePackedIndex + 1;
-			LowerRightUnpackedEndIndex = LowerRightPackedIndex * 4;
-
-			const int32 RightBonePackedIndex = PackedIndex + 1;
-			RightUnpackedEndIndex = RightBonePackedIndex * 4;
-		}
-
-		const int32 LowerBonePackedIndex = PackedIndex + SimulationPlane.PackedHorizontalBoneNum;
-
-		// Diagonal constraint in lower right direction.
-		FHGMSIMDShearStructure sLowerRightDiagonalShear {};
-		FHGMSIMDVector3 sFirstBonePosition {};
-		FHGMSIMDLibrary::Load(sLowerRightDiagonalShear.sFirstBoneUnpackedIndex, PackedIndex * 4 + 0, PackedIndex * 4 + 1, PackedIndex * 4 + 2, PackedIndex * 4 + 3);
-		FHGMSIMDLibrary::Store(Positions, sLowerRightDiagonalShear.sFirstBoneUnpackedIndex, sFirstBonePosition);
-
-		FHGMSIMDVector3 sSecondBonePosition {};
-		FHGMSIMDLibrary::Load(sLowerRightDiagonalShear.sSecondBoneUnpackedIndex, LowerBonePackedIndex * 4 + 1, LowerBonePackedIndex * 4 + 2, LowerBonePackedIndex * 4 + 3, LowerRightUnpackedEndIndex);
-		if (bLoopHorizontalStructure)
-		{
-			FHGMSIMDLibrary::Load(sLowerRightDiagonalShear.sSecondBoneUnpackedIndex, EndComponentIndex, LowerRightUnpackedEndIndex);
-		}
-
-		FHGMSIMDLibrary::Store(Positions, sLowerRightDiagonalShear.sSecondBoneUnpackedIndex, sSecondBonePosition);
-
-		sLowerRightDiagonalShear.sLength = FHGMMathLibrary::Length(sSecondBonePosition - sFirstBonePosition);
-		sLowerRightDiagonalShear.sLambda = HGMSIMDConstants::ZeroReal;
-		OutShearStructures.Emplace(MoveTemp(sLowerRightDiagonalShear));
-
-		// Diagonal constraint in lower left direction.
-		FHGMSIMDShearStructure sLowerLeftDiagonalShear {};
-		FHGMSIMDLibrary::Load(sLowerLeftDiagonalShear.sFirstBoneUnpackedIndex, PackedIndex * 4 + 1, PackedIndex * 4 + 2, PackedIndex * 4 + 3, RightUnpackedEndIndex);
-		if (bLoopHorizontalStructure)
-		{
-			FHGMSIMDLibrary::Load(sLowerLeftDiagonalShear.sFirstBoneUnpackedIndex, EndComponentIndex, RightUnpackedEndIndex);
-		}
-
-		FHGMSIMDLibrary::Store(Positions, sLowerLeftDiagonalShear.sFirstBoneUnpackedIndex, sFirstBonePosition);
-
-		FHGMSIMDLibrary::Load(sLowerLeftDiagonalShear.sSecondBoneUnpackedIndex, LowerBonePackedIndex * 4 + 0, LowerBonePackedIndex * 4 + 1, LowerBonePackedIndex * 4 + 2, LowerBonePackedIndex * 4 + 3);
-		FHGMSIMDLibrary::Store(Positions, sLowerLeftDiagonalShear.sSecondBoneUnpackedIndex, sSecondBonePosition);
-
-		sLowerLeftDiagonalShear.sLength = FHGMMathLibrary::Length(sSecondBonePosition - sFirstBonePosition);
-		sLowerLeftDiagonalShear.sLambda = HGMSIMDConstants::ZeroReal;
-		OutShearStructures.Emplace(MoveTemp(sLowerLeftDiagonalShear));
-
-		PackedIndex += LoopIncreaseValue;
 	}
 }
 
 
-void FHGMConstraintLibrary::ShearConstraint(TArrayView<FHGMSIMDShearStructure> Shears, FHGMPhysicsContext& PhysicsContext, const FHGMSimulationPlane& SimulationPlane, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> InverseMasses, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks)
+void FHGMConstraintLibrary::ShearConstraint(TArrayView<FHGMSIMDShearStructure> Shears, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
 {
 	SCOPE_CYCLE_COUNTER(STAT_ConstraintShearConstraint);
 
@@ -300,103 +591,124 @@ void FHGMConstraintLibrary::ShearConstraint(TArrayView<FHGMSIMDShearStructure> S
 	FHGMSIMDReal sStiffness {};
 	FHGMSIMDLibrary::Load(sStiffness, PhysicsContext.PhysicsSettings.ShearStiffness);
 
-	for (int32 ShearIndexBase = 0; ShearIndexBase < Shears.Num(); ShearIndexBase += 2)
+	// Structures of same color share no bones, so the order within color does not change result.
+	for (FHGMSIMDShearStructure& sShear : Shears)
 	{
-		const int32 HorizontalChainIndex = ShearIndexBase / 2;
-		bool bIsEndHorizontalBone = (HorizontalChainIndex % SimulationPlane.PackedHorizontalBoneNum) + 1 == SimulationPlane.PackedHorizontalBoneNum;
+		const bool bCanShiftComponents = sShear.FirstBonePackedIndex >= 0;
+
+		FHGMSIMDVector3 sFirstBonePosition {};
+		FHGMSIMDVector3 sSecondBonePosition {};
+		FHGMSIMDParticleParameter FirstBoneParameter {};
+		FHGMSIMDParticleParameter SecondBoneParameter {};
 
-		int32 EndComponentIndex = 3;
-		if (bIsEndHorizontalBone)
+		if (bCanShiftComponents)
 		{
-			EndComponentIndex = (SimulationPlane.ActualUnpackedHorizontalBoneNum - 1) % 4;
-			if (!PhysicsContext.PhysicsSettings.bLoopHorizontalStructure)
-			{
-				--EndComponentIndex;
-				if (EndComponentIndex < 0)
-				{
-					continue;
-				}
-			}
+			sFirstBonePosition = LoadShearBone<FHGMSIMDVector3>(Positions, sShear.FirstBonePackedIndex, sShear.FirstBoneNextPackedIndex);
+			sSecondBonePosition = LoadShearBone<FHGMSIMDVector3>(Positions, sShear.SecondBonePackedIndex, sShear.SecondBoneNextPackedIndex);
+			FirstBoneParameter = LoadShearParticleParameter(ParticleParameters, sShear.FirstBonePackedIndex, sShear.FirstBoneNextPackedIndex);
+			SecondBoneParameter = LoadShearParticleParameter(ParticleParameters, sShear.SecondBonePackedIndex, sShear.SecondBoneNextPackedIndex);
 		}
-
-		for (int32 Offset = 0; Offset < 2; ++Offset)
+		else
 		{
-			const int32 ShearIndex = ShearIndexBase + Offset;
-			FHGMSIMDShearStructure& sShear = Shears[ShearIndex];
-
-			FHGMSIMDVector3 sFirstBonePosition {};
 			FHGMSIMDLibrary::Store(Positions, sShear.sFirstBoneUnpackedIndex, sFirstBonePosition);
-
-			FHGMSIMDVector3 sSecondBonePosition {};
 			FHGMSIMDLibrary::Store(Positions, sShear.sSecondBoneUnpackedIndex, sSecondBonePosition);
+			FirstBoneParameter = GatherParticleParameter(ParticleParameters, sShear.sFirstBoneUnpackedIndex);
+			SecondBoneParameter = GatherParticleParameter(ParticleParameters, sShear.sSecondBoneUnpackedIndex);
+		}
 
-			FHGMSIMDReal sFirstInverseMass {};
-			FHGMSIMDLibrary::Store(InverseMasses, sShear.sFirstBoneUnpackedIndex, sFirstInverseMass);
+		const FHGMSIMDVector3 sToFirst = sFirstBonePosition - sSecondBonePosition;
+		const FHGMSIMDReal sCurrentLenght = FHGMMathLibrary::Length(sToFirst);
+		const FHGMSIMDVector3 sToFirstDirection = FHGMMathLibrary::MakeSafeNormal(sToFirst);
 
-			FHGMSIMDReal sSecondInverseMass {};
-			FHGMSIMDLibrary::Store(InverseMasses, sShear.sSecondBoneUnpackedIndex, sSecondInverseMass);
+		FHGMSIMDReal sFirstBoneCoefficient = HGMSIMDConstants::OneReal;
+		sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - FirstBoneParameter.sFixedBlend);
+		sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - SecondBoneParameter.sDummyBoneMask);
 
-			FHGMSIMDReal sFirstBoneFixedBlend {};
-			FHGMSIMDLibrary::Store(FixedBlends, sShear.sFirstBoneUnpackedIndex, sFirstBoneFixedBlend);
+		FHGMSIMDReal sSecondBoneCoefficient = HGMSIMDConstants::OneReal;
+		sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - SecondBoneParameter.sFixedBlend);
+		sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - FirstBoneParameter.sDummyBoneMask);
 
-			FHGMSIMDReal sSecondBoneFixedBlend {};
-			FHGMSIMDLibrary::Store(FixedBlends, sShear.sSecondBoneUnpackedIndex, sSecondBoneFixedBlend);
+		const FHGMSIMDReal sIgnoreMask = (sFirstBoneCoefficient <= HGMSIMDConstants::ZeroReal & sSecondBoneCoefficient <= HGMSIMDConstants::ZeroReal) | ~sShear.sActiveMask;
+		AccumulateConstraintError(PhysicsContext, sCurrentLenght, sShear.sLength, sIgnoreMask);
 
-			FHGMSIMDReal sFirstBoneDummyMask {};
-			FHGMSIMDLibrary::Store(DummyBoneMasks, sShear.sFirstBoneUnpackedIndex, sFirstBoneDummyMask);
+		FHGMSIMDReal sDeltaLambda = ComputeDeltaLambda(sCurrentLenght, sToFirstDirection, sShear.sLength, FirstBoneParameter.sInverseMass + SecondBoneParameter.sInverseMass, sStiffness, sShear.sLambda, sDeltaTimeSquared);
+		sDeltaLambda = FHGMSIMDLibrary::Select(sIgnoreMask, HGMSIMDConstants::ZeroReal, sDeltaLambda);
 
-			FHGMSIMDReal sSecondBoneDummyMask {};
-			FHGMSIMDLibrary::Store(DummyBoneMasks, sShear.sSecondBoneUnpackedIndex, sSecondBoneDummyMask);
+		sShear.sLambda += sDeltaLambda;
+		sFirstBonePosition -= sToFirstDirection * sDeltaLambda * sFirstBoneCoefficient * FirstBoneParameter.sInverseMass;
+		sSecondBonePosition += sToFirstDirection * sDeltaLambda * sSecondBoneCoefficient * SecondBoneParameter.sInverseMass;
 
-			const FHGMSIMDVector3 sToFirst = sFirstBonePosition - sSecondBonePosition;
-			const FHGMSIMDReal sCurrentLenght = FHGMMathLibrary::Length(sToFirst);
-			const FHGMSIMDVector3 sToFirstDirection = FHGMMathLibrary::MakeSafeNormal(sToFirst);
+		if (bCanShiftComponents)
+		{
+			StoreShearBone(Positions, sShear.FirstBonePackedIndex, sShear.FirstBoneNextPackedIndex, sFirstBonePosition);
+			StoreShearBone(Positions, sShear.SecondBonePackedIndex, sShear.SecondBoneNextPackedIndex, sSecondBonePosition);
+		}
+		else
+		{
+			// Unpacked indexes of inactive components may overlap with active ones, so write back only active components.
+			const int32 ActiveComponentBits = VectorMaskBits(sShear.sActiveMask);
 
-			FHGMSIMDReal sFirstBoneCoefficient = HGMSIMDConstants::OneReal;
-			sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - sFirstBoneFixedBlend);
-			sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - sSecondBoneDummyMask);
+			TStaticArray<int32, 4> FirstBoneUnpackedIndexes {};
+			FHGMSIMDLibrary::Store(sShear.sFirstBoneUnpackedIndex, FirstBoneUnpackedIndexes);
 
-			FHGMSIMDReal sSecondBoneCoefficient = HGMSIMDConstants::OneReal;
-			sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - sSecondBoneFixedBlend);
-			sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - sFirstBoneDummyMask);
+			TStaticArray<int32, 4> SecondBoneUnpackedIndexes {};
+			FHGMSIMDLibrary::Store(sShear.sSecondBoneUnpackedIndex, SecondBoneUnpackedIndexes);
 
-			FHGMSIMDReal sDeltaLambda = ComputeDeltaLambda(sCurrentLenght, sToFirstDirection, sShear.sLength, sFirstInverseMass + sSecondInverseMass, sStiffness, sShear.sLambda, sDeltaTimeSquared);
-			sDeltaLambda = FHGMSIMDLibrary::Select(sFirstBoneCoefficient <= HGMSIMDConstants::ZeroReal & sSecondBoneCoefficient <= HGMSIMDConstants::ZeroReal, HGMSIMDConstants::ZeroReal, sDeltaLambda);
+			TStaticArray<FHGMVector3, 4> FirstBoneUnpackedPositions {};
+			FHGMSIMDLibrary::Store(sFirstBonePosition, FirstBoneUnpackedPositions);
 
-			sShear.sLambda += sDeltaLambda;
-			sFirstBonePosition -= sToFirstDirection * sDeltaLambda * sFirstBoneCoefficient * sFirstInverseMass;
-			sSecondBonePosition += sToFirstDirection * sDeltaLambda * sSecondBoneCoefficient * sSecondInverseMass;
+			TStaticArray<FHGMVector3, 4> SecondBoneUnpackedPositions {};
+			FHGMSIMDLibrary::Store(sSecondBonePosition, SecondBoneUnpackedPositions);
 
-			if (bIsEndHorizontalBone)
+			for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
 			{
-				TStaticArray<int32, 4> FirstBoneUnpackedIndexes {};
-				FHGMSIMDLibrary::Store(sShear.sFirstBoneUnpackedIndex, FirstBoneUnpackedIndexes);
-
-				TStaticArray<int32, 4> SecondBoneUnpackedIndexes {};
-				FHGMSIMDLibrary::Store(sShear.sSecondBoneUnpackedIndex, SecondBoneUnpackedIndexes);
-
-				TStaticArray<FHGMVector3, 4> FirstBoneUnpackedPositions {};
-				FHGMSIMDLibrary::Store(sFirstBonePosition, FirstBoneUnpackedPositions);
-
-				TStaticArray<FHGMVector3, 4> SecondBoneUnpackedPositions {};
-				FHGMSIMDLibrary::Store(sSecondBonePosition, SecondBoneUnpackedPositions);
-
-				for (int32 ComponentIndex = 0; ComponentIndex <= EndComponentIndex; ++ComponentIndex)
+				if ((ActiveComponentBits & (1 << ComponentIndex)) == 0)
 				{
-					FHGMSIMDLibrary::Load(Positions, FHGMSIMDIndex(FirstBoneUnpackedIndexes[ComponentIndex]), FirstBoneUnpackedPositions[ComponentIndex]);
-					FHGMSIMDLibrary::Load(Positions, FHGMSIMDIndex(SecondBoneUnpackedIndexes[ComponentIndex]), SecondBoneUnpackedPositions[ComponentIndex]);
+					continue;
 				}
-			}
-			else
-			{
-				FHGMSIMDLibrary::Load(Positions, sShear.sFirstBoneUnpackedIndex, sFirstBonePosition);
-				FHGMSIMDLibrary::Load(Positions, sShear.sSecondBoneUnpackedIndex, sSecondBonePosition);
+
+				FHGMSIMDLibrary::Load(Positions, FHGMSIMDIndex(FirstBoneUnpackedIndexes[ComponentIndex]), FirstBoneUnpackedPositions[ComponentIndex]);
+				FHGMSIMDLibrary::Load(Positions, FHGMSIMDIndex(SecondBoneUnpackedIndexes[ComponentIndex]), SecondBoneUnpackedPositions[ComponentIndex]);
 			}
 		}
 	}
 }
 
 
+void FHGMConstraintLibrary::MakeTetherStructure(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDStructure> VerticalStructures, TConstArrayView<FHGMSIMDReal> TetherCompliances, TArray<FHGMSIMDTether>& OutTethers)
+{
+	OutTethers.Reset(VerticalStructures.Num());
+
+	// Maximum distance is geodesic length along chain, so chain can be straightened but never stretched.
+	TArray<FHGMSIMDReal> ChainLengths {};
+	ChainLengths.Init(HGMSIMDConstants::ZeroReal, SimulationPlane.PackedHorizontalBoneNum);
+
+	for (int32 VerticalStructureIndex = 0; VerticalStructureIndex < VerticalStructures.Num(); ++VerticalStructureIndex)
+	{
+		const FHGMSIMDStructure& VerticalStructure = VerticalStructures[VerticalStructureIndex];
+		const int32 PackedHorizontalIndex = VerticalStructureIndex % SimulationPlane.PackedHorizontalBoneNum;
+		ChainLengths[PackedHorizontalIndex] += VerticalStructure.sLength;
+
+		FHGMSIMDTether Tether {};
+		Tether.RootBonePackedIndex = PackedHorizontalIndex;
+		Tether.BonePackedIndex = VerticalStructure.SecondBonePackedIndex;
+		Tether.sLength = ChainLengths[PackedHorizontalIndex];
+		Tether.sCompliance = TetherCompliances[VerticalStructure.SecondBonePackedIndex];
+		Tether.sLambda = HGMSIMDConstants::ZeroReal;
+
+		OutTethers.Emplace(MoveTemp(Tether));
+	}
+}
+
+
+void FHGMConstraintLibrary::TetherConstraint(TArrayView<FHGMSIMDTether> Tethers, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ConstraintTetherConstraint);
+
+	SolveTetherConstraint(Tethers, PhysicsContext, Positions, ParticleParameters);
+}
+
+
 void FHGMConstraintLibrary::MakeVerticalBendStructure(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDVector3> Positions, TArray<FHGMSIMDStructure>& OutVerticalBendStructures)
 {
 	OutVerticalBendStructures.Reset(SimulationPlane.PackedHorizontalBoneNum * SimulationPlane.UnpackedVerticalBoneNum);
@@ -436,48 +748,14 @@ void FHGMConstraintLibrary::MakeVerticalBendStructure(const FHGMSimulationPlane&
 }
 
 
-void FHGMConstraintLibrary::VerticalBendConstraint(TArrayView<FHGMSIMDStructure> BendStructures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> InverseMasses, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks)
+void FHGMConstraintLibrary::VerticalBendConstraint(TArrayView<FHGMSIMDStructure> BendStructures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
 {
 	SCOPE_CYCLE_COUNTER(STAT_ConstraintVerticalBendConstraint);
 
-	const FHGMSIMDReal sDeltaTimeSquared = PhysicsContext.sDeltaTime * PhysicsContext.sDeltaTime;
-
 	FHGMSIMDReal sStiffness {};
 	FHGMSIMDLibrary::Load(sStiffness, PhysicsContext.PhysicsSettings.VerticalBendStiffness);
 
-	for (FHGMSIMDStructure& Structure : BendStructures)
-	{
-		FHGMSIMDVector3& sFirstBonePosition = Positions[Structure.FirstBonePackedIndex];
-		FHGMSIMDVector3& sSecondBonePosition = Positions[Structure.SecondBonePackedIndex];
-
-		const FHGMSIMDVector3 sToFirst = sFirstBonePosition - sSecondBonePosition;
-		const FHGMSIMDReal sCurrentLenght =FHGMMathLibrary::Length(sToFirst);
-		const FHGMSIMDVector3 sToFirstDirection = FHGMMathLibrary::MakeSafeNormal(sToFirst);
-
-		const FHGMSIMDReal& sFirstInverseMass = InverseMasses[Structure.FirstBonePackedIndex];
-		const FHGMSIMDReal& sSecondInverseMass = InverseMasses[Structure.SecondBonePackedIndex];
-
-		const FHGMSIMDReal& sFirstBoneFixedBlend = FixedBlends[Structure.FirstBonePackedIndex];
-		const FHGMSIMDReal& sSecondBoneFixedBlend = FixedBlends[Structure.SecondBonePackedIndex];
-
-		const FHGMSIMDReal& sFirstBoneDummyMask = DummyBoneMasks[Structure.FirstBonePackedIndex];
-		const FHGMSIMDReal& sSecondBoneDummyMask = DummyBoneMasks[Structure.SecondBonePackedIndex];
-
-		FHGMSIMDReal sFirstBoneCoefficient = HGMSIMDConstants::OneReal;
-		sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - sFirstBoneFixedBlend);
-		sFirstBoneCoefficient *= (HGMSIMDConstants::OneReal - sSecondBoneDummyMask);
-
-		FHGMSIMDReal sSecondBoneCoefficient = HGMSIMDConstants::OneReal;
-		sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - sSecondBoneFixedBlend);
-		sSecondBoneCoefficient *= (HGMSIMDConstants::OneReal - sFirstBoneDummyMask);
-
-		FHGMSIMDReal sDeltaLambda = ComputeDeltaLambda(sCurrentLenght, sToFirstDirection, Structure.sLength, sFirstInverseMass + sSecondInverseMass, sStiffness, Structure.sLambda, sDeltaTimeSquared);
-		sDeltaLambda = FHGMSIMDLibrary::Select(sFirstBoneCoefficient <= HGMSIMDConstants::ZeroReal & sSecondBoneCoefficient <= HGMSIMDConstants::ZeroReal, HGMSIMDConstants::ZeroReal, sDeltaLambda);
-
-		Structure.sLambda += sDeltaLambda;
-		sFirstBonePosition -= sToFirstDirection * sDeltaLambda * sFirstBoneCoefficient * sFirstInverseMass;
-		sSecondBonePosition += sToFirstDirection * sDeltaLambda * sSecondBoneCoefficient * sSecondInverseMass;
-	}
+	SolveDistanceConstraint(BendStructures, PhysicsContext, Positions, ParticleParameters, sStiffness);
 }
 
 
@@ -491,22 +769,20 @@ void FHGMConstraintLibrary::MakeHorizontalBendStructure(FHGMSimulationPlane& Sim
 }
 
 
-void FHGMConstraintLibrary::HorizontalBendConstraint(TArrayView<FHGMSIMDStructure> HorizontalBendStructures, FHGMPhysicsContext& PhysicsContext, FHGMSimulationPlane& SimulationPlane, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDReal>& InverseMasses, TArray<FHGMSIMDReal>& FixedBlends, TArray<FHGMSIMDReal>& DummyBoneMasks)
+void FHGMConstraintLibrary::HorizontalBendConstraint(TArrayView<FHGMSIMDStructure> HorizontalBendStructures, FHGMPhysicsContext& PhysicsContext, const FHGMSimulationPlane& SimulationPlane, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> HorizontalPositions, TConstArrayView<FHGMSIMDParticleParameter> HorizontalParticleParameters)
 {
 	SCOPE_CYCLE_COUNTER(STAT_ConstraintHorizontalBendConstraint);
 
-	FScopedTranspose ScopedTranspose(&SimulationPlane);
-	ScopedTranspose.Add(&Positions);
-	ScopedTranspose.Add(&InverseMasses);
-	ScopedTranspose.Add(&FixedBlends);
-	ScopedTranspose.Add(&DummyBoneMasks);
-	ScopedTranspose.Execute();
+	FHGMSimulationPlane HorizontalSimulationPlane = SimulationPlane;
+	FHGMSolverLibrary::Transpose(HorizontalSimulationPlane);
 
-	FHGMConstraintLibrary::VerticalBendConstraint(HorizontalBendStructures, PhysicsContext, Positions, InverseMasses, FixedBlends, DummyBoneMasks);
+	FHGMSolverLibrary::Transpose<FHGMSIMDVector3, FHGMVector3>(SimulationPlane, Positions, HorizontalPositions);
+	FHGMConstraintLibrary::VerticalBendConstraint(HorizontalBendStructures, PhysicsContext, HorizontalPositions, HorizontalParticleParameters);
+	FHGMSolverLibrary::Transpose<FHGMSIMDVector3, FHGMVector3>(HorizontalSimulationPlane, HorizontalPositions, Positions);
 }
 
 
-void FHGMConstraintLibrary::RelativeLimitAngleConstraint(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDStructure> VerticalStructures, TConstArrayView<FHGMSIMDRelativeLimitAngle> RelativeLimitAngles, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArray<FHGMSIMDVector3>& Positions, TConstArrayView<FHGMSIMDReal> DummyBoneMasks)
+void FHGMConstraintLibrary::RelativeLimitAngleConstraint(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDStructure> VerticalStructures, TConstArrayView<FHGMSIMDRelativeLimitAngle> RelativeLimitAngles, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArray<FHGMSIMDVector3>& Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
 {
 	SCOPE_CYCLE_COUNTER(STAT_ConstraintRelativeLimitAngleConstraint);
 
@@ -620,12 +896,10 @@ void FHGMConstraintLibrary::AnimPoseLimitAngleConstraint(TConstArrayView<FHGMSIM
 }
 
 
-void FHGMConstraintLibrary::AnimPosePlanarConstraint(TConstArrayView<FHGMSIMDInt> PlanarConstraintAxes, TConstArrayView<FHGMSIMDStructure> VerticalStructures, const FHGMSimulationPlane& SimulationPlane, FComponentSpacePoseContext& Output, TArrayView<FBoneReference> Bones, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArrayView<FHGMSIMDVector3> Positions)
+void FHGMConstraintLibrary::AnimPosePlanarConstraint(TConstArrayView<FHGMSIMDInt> PlanarConstraintAxes, TConstArrayView<FHGMSIMDStructure> VerticalStructures, const FHGMSimulationPlane& SimulationPlane, FComponentSpacePoseContext& Output, TConstArrayView<FCompactPoseBoneIndex> CompactPoseBoneIndexes, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArrayView<FHGMSIMDVector3> Positions)
 {
 	SCOPE_CYCLE_COUNTER(STAT_ConstraintAnimPosePlanarConstraint);
 
-	const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
-
 	for (int32 StructureIndex = 0; StructureIndex < VerticalStructures.Num(); ++StructureIndex)
 	{
 		const FHGMSIMDStructure& VerticalStructure = VerticalStructures[StructureIndex];
@@ -637,14 +911,13 @@ void FHGMConstraintLibrary::AnimPosePlanarConstraint(TConstArrayView<FHGMSIMDInt
 		TStaticArray<FHGMQuaternion, 4> BoneRotations {};
 		for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
 		{
-			const FBoneReference& Bone = Bones[BoneUnpackedIndexes[ComponentIndex]];
-			if (!FHGMAnimationLibrary::IsValidBone(Bone))
+			const FCompactPoseBoneIndex& CompactPoseBoneIndex = CompactPoseBoneIndexes[BoneUnpackedIndexes[ComponentIndex]];
+			if (!CompactPoseBoneIndex.IsValid())
 			{
 				BoneRotations[ComponentIndex] = FHGMQuaternion::Identity;
 				continue;
 			}
 
-			const FCompactPoseBoneIndex CompactPoseBoneIndex = Bone.GetCompactPoseIndex(BoneContainer);
 			const FHGMTransform& BoneTransform = Output.Pose.GetComponentSpaceTransform(CompactPoseBoneIndex);
 			BoneRotations[ComponentIndex] = BoneTransform.GetRotation();
 		}
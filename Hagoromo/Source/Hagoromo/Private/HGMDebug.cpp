@@ -108,6 +108,38 @@ void FHGMDebugLibrary::DrawBodyCollider(FComponentSpacePoseContext& PoseContext,
 		EdgeEnd = WorldSpaceEndPoint - Rotation.GetRightVector() * CapsuleCollider.Radius;
 		PoseContext.AnimInstanceProxy->AnimDrawDebugLine(EdgeStart, EdgeEnd, FColor(162, 242, 204, 255), false, -1.0f, 0.0f, DepthPriority);
 	}
+	// Draw grid of distance field, since its surface is not available at runtime.
+	for (int32 ColliderIndex = 0; ColliderIndex < BodyCollider.DistanceFieldColliders.Num(); ++ColliderIndex)
+	{
+		const FHGMDistanceFieldCollider& DistanceFieldCollider = BodyCollider.DistanceFieldColliders[ColliderIndex];
+		if (!DistanceFieldCollider.bEnabled)
+		{
+			continue;
+		}
+
+		const FHGMDistanceField& DistanceField = *BodyCollider.BoneSpaceDistanceFieldColliders[ColliderIndex].DistanceField;
+		const FHGMVector3 GridSize = FHGMVector3(DistanceField.Resolution - FIntVector(1)) * DistanceField.VoxelSize;
+		const FHGMTransform WorldSpaceTransform = DistanceFieldCollider.Transform * SkeletalMeshComponentTransform;
+
+		// Bit 0, 1 and 2 of corner index are offsets in X, Y and Z.
+		TStaticArray<FHGMVector3, 8> WorldSpaceCorners {};
+		for (int32 CornerIndex = 0; CornerIndex < 8; ++CornerIndex)
+		{
+			const FHGMVector3 CornerOffset((CornerIndex & 1) ? GridSize.X : 0.0, (CornerIndex & 2) ? GridSize.Y : 0.0, (CornerIndex & 4) ? GridSize.Z : 0.0);
+			WorldSpaceCorners[CornerIndex] = WorldSpaceTransform.TransformPosition(DistanceField.Origin + CornerOffset);
+		}
+
+		for (int32 CornerIndex = 0; CornerIndex < 8; ++CornerIndex)
+		{
+			for (int32 Axis = 1; Axis < 8; Axis <<= 1)
+			{
+				if (!(CornerIndex & Axis))
+				{
+					PoseContext.AnimInstanceProxy->AnimDrawDebugLine(WorldSpaceCorners[CornerIndex], WorldSpaceCorners[CornerIndex | Axis], FColor(162, 242, 204, 255), false, -1.0f, 0.0f, DepthPriority);
+				}
+			}
+		}
+	}
 }
 
 
@@ -132,9 +164,9 @@ void FHGMDebugLibrary::DrawBoneColliders(FComponentSpacePoseContext& PoseContext
 		FHGMSIMDLibrary::Store(sWorldPosition, UnpackedWorldPositions);
 
 		TStaticArray<FHGMReal, 4> UnpackedRadiuses {};
-		FHGMSIMDLibrary::Store(Solver->BoneSphereColliderRadiuses[PackedIndex], UnpackedRadiuses);
+		FHGMSIMDLibrary::Store(Solver->Template->BoneSphereColliderRadiuses[PackedIndex], UnpackedRadiuses);
 
-		const FHGMSIMDReal& sDummyBoneMask = Solver->DummyBoneMasks[PackedIndex];
+		const FHGMSIMDReal& sDummyBoneMask = Solver->GetParticleParameters()[PackedIndex].sDummyBoneMask;
 		TStaticArray<FHGMReal, 4> UnpackedDummyBoneMasks {};
 		FHGMSIMDLibrary::Store(sDummyBoneMask, UnpackedDummyBoneMasks);
 
@@ -196,7 +228,7 @@ void FHGMDebugLibrary::DrawFixedBlends(FComponentSpacePoseContext& PoseContext,
 
 	for (int32 PackedIndex = 0; PackedIndex < Solver->Positions.Num(); ++PackedIndex)
 	{
-		const FHGMSIMDReal& sFixedBlend = Solver->FixedBlends[PackedIndex];
+		const FHGMSIMDReal& sFixedBlend = Solver->GetParticleParameters()[PackedIndex].sFixedBlend;
 		TStaticArray<FHGMReal, 4> UnpackedFixedBlends {};
 		FHGMSIMDLibrary::Store(sFixedBlend, UnpackedFixedBlends);
 
@@ -205,7 +237,7 @@ void FHGMDebugLibrary::DrawFixedBlends(FComponentSpacePoseContext& PoseContext,
 		TStaticArray<FHGMVector3, 4> UnpackedWorldPositions {};
 		FHGMSIMDLibrary::Store(sWorldPosition, UnpackedWorldPositions);
 
-		const FHGMSIMDReal& sDummyBoneMask = Solver->DummyBoneMasks[PackedIndex];
+		const FHGMSIMDReal& sDummyBoneMask = Solver->GetParticleParameters()[PackedIndex].sDummyBoneMask;
 		TStaticArray<FHGMReal, 4> UnpackedDummyBoneMasks {};
 		FHGMSIMDLibrary::Store(sDummyBoneMask, UnpackedDummyBoneMasks);
 
@@ -246,11 +278,11 @@ void FHGMDebugLibrary::DrawVerticalStructure(FComponentSpacePoseContext& PoseCon
 		TStaticArray<FHGMVector3, 4> UnpackedWorldSecondBonePositions {};
 		FHGMSIMDLibrary::Store(sWorldSecondBonePosition, UnpackedWorldSecondBonePositions);
 
-		const FHGMSIMDReal& sFirstBoneDummyMask = Solver->DummyBoneMasks[Structure.FirstBonePackedIndex];
+		const FHGMSIMDReal& sFirstBoneDummyMask = Solver->GetParticleParameters()[Structure.FirstBonePackedIndex].sDummyBoneMask;
 		TStaticArray<FHGMReal, 4> UnpackedFirstBoneDummyMasks {};
 		FHGMSIMDLibrary::Store(sFirstBoneDummyMask, UnpackedFirstBoneDummyMasks);
 
-		const FHGMSIMDReal& sSecondBoneDummyMask = Solver->DummyBoneMasks[Structure.SecondBonePackedIndex];
+		const FHGMSIMDReal& sSecondBoneDummyMask = Solver->GetParticleParameters()[Structure.SecondBonePackedIndex].sDummyBoneMask;
 		TStaticArray<FHGMReal, 4> UnpackedSecondBoneDummyMasks {};
 		FHGMSIMDLibrary::Store(sSecondBoneDummyMask, UnpackedSecondBoneDummyMasks);
 
@@ -269,10 +301,11 @@ void FHGMDebugLibrary::DrawVerticalStructure(FComponentSpacePoseContext& PoseCon
 
 void FHGMDebugLibrary::DrawHorizontalStructure(FComponentSpacePoseContext& PoseContext, FHGMDynamicBoneSolver* Solver, ESceneDepthPriorityGroup DepthPriority)
 {
-	FScopedTranspose ScopedTranspose(&Solver->SimulationPlane);
-	ScopedTranspose.Add(&Solver->Positions);
-	ScopedTranspose.Add(&Solver->DummyBoneMasks);
-	ScopedTranspose.Execute();
+	// Template is shared with other instances, so its horizontal-major layout is read instead of transposing in place.
+	TArray<FHGMSIMDVector3> HorizontalPositions {};
+	HorizontalPositions.SetNum(Solver->Positions.Num());
+	FHGMSolverLibrary::Transpose<FHGMSIMDVector3, FHGMVector3>(Solver->Template->SimulationPlane, Solver->Positions, HorizontalPositions);
+	const TConstArrayView<FHGMSIMDParticleParameter> HorizontalParticleParameters = Solver->GetHorizontalParticleParameters();
 
 	const FHGMTransform& SkeletalMeshComponentTransform = PoseContext.AnimInstanceProxy->GetComponentTransform();
 	FHGMSIMDTransform sSkeletalMeshComponentTransform {};
@@ -280,22 +313,22 @@ void FHGMDebugLibrary::DrawHorizontalStructure(FComponentSpacePoseContext& PoseC
 
 	for (FHGMSIMDStructure& Structure : Solver->HorizontalStructures)
 	{
-		const FHGMSIMDVector3& sFirstBonePosition = Solver->Positions[Structure.FirstBonePackedIndex];
+		const FHGMSIMDVector3& sFirstBonePosition = HorizontalPositions[Structure.FirstBonePackedIndex];
 		const FHGMSIMDVector3 sWorldFirstBonePosition = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, sFirstBonePosition);
 
 		TStaticArray<FHGMVector3, 4> UnpackedWorldFirstBonePositions {};
 		FHGMSIMDLibrary::Store(sWorldFirstBonePosition, UnpackedWorldFirstBonePositions);
 
-		const FHGMSIMDVector3& sSecondBonePosition = Solver->Positions[Structure.SecondBonePackedIndex];
+		const FHGMSIMDVector3& sSecondBonePosition = HorizontalPositions[Structure.SecondBonePackedIndex];
 		const FHGMSIMDVector3 sWorldSecondBonePosition = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, sSecondBonePosition);
 		TStaticArray<FHGMVector3, 4> UnpackedWorldSecondBonePositions {};
 		FHGMSIMDLibrary::Store(sWorldSecondBonePosition, UnpackedWorldSecondBonePositions);
 
-		const FHGMSIMDReal& sFirstBoneDummyMask = Solver->DummyBoneMasks[Structure.FirstBonePackedIndex];
+		const FHGMSIMDReal& sFirstBoneDummyMask = HorizontalParticleParameters[Structure.FirstBonePackedIndex].sDummyBoneMask;
 		TStaticArray<FHGMReal, 4> UnpackedFirstBoneDummyMasks {};
 		FHGMSIMDLibrary::Store(sFirstBoneDummyMask, UnpackedFirstBoneDummyMasks);
 
-		const FHGMSIMDReal& sSecondBoneDummyMask = Solver->DummyBoneMasks[Structure.SecondBonePackedIndex];
+		const FHGMSIMDReal& sSecondBoneDummyMask = HorizontalParticleParameters[Structure.SecondBonePackedIndex].sDummyBoneMask;
 		TStaticArray<FHGMReal, 4> UnpackedSecondBoneDummyMasks {};
 		FHGMSIMDLibrary::Store(sSecondBoneDummyMask, UnpackedSecondBoneDummyMasks);
 
@@ -327,59 +360,60 @@ void FHGMDebugLibrary::DrawShear(FComponentSpacePoseContext& PoseContext, FHGMDy
 	Colors[0] = FColor(117, 253, 255, 255);
 	Colors[1] = FColor(255, 186, 102, 255);
 
-	for (int32 ShearIndexBase = 0; ShearIndexBase < Solver->ShearStructures.Num(); ShearIndexBase += 2)
+	for (const FHGMSIMDShearStructure& sShear : Solver->ShearStructures)
 	{
-		const int32 HorizontalChainIndex = ShearIndexBase / 2;
-		bool bIsEndHorizontalBone = (HorizontalChainIndex % Solver->SimulationPlane.PackedHorizontalBoneNum) + 1 == Solver->SimulationPlane.PackedHorizontalBoneNum;
+		const int32 ActiveComponentBits = VectorMaskBits(sShear.sActiveMask);
 
-		int32 EndComponentIndex = 3;
-		if (bIsEndHorizontalBone)
-		{
-			EndComponentIndex = (Solver->SimulationPlane.ActualUnpackedHorizontalBoneNum - 1) % 4;
-			if (!bLoopHorizontalStructure)
-			{
-				--EndComponentIndex;
-				if (EndComponentIndex < 0)
-				{
-					continue;
-				}
-			}
-		}
+		TStaticArray<int32, 4> FirstBoneUnpackedIndexes {};
+		FHGMSIMDLibrary::Store(sShear.sFirstBoneUnpackedIndex, FirstBoneUnpackedIndexes);
 
-		for (int32 Offset = 0; Offset < 2; ++Offset)
-		{
-			const int32 ShearIndex = ShearIndexBase + Offset;
-			const FHGMSIMDShearStructure& sShear = Solver->ShearStructures[ShearIndex];
+		// Lower right diagonal starts from first component of packed bone.
+		const int32 ColorIndex = (FirstBoneUnpackedIndexes[0] % 4) == 0 ? 0 : 1;
+
+		FHGMSIMDVector3 sFirstBonePosition {};
+		FHGMSIMDLibrary::Store(Solver->Positions, sShear.sFirstBoneUnpackedIndex, sFirstBonePosition);
+		const FHGMSIMDVector3 sWorldFirstBonePosition = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, sFirstBonePosition);
 
-			FHGMSIMDVector3 sFirstBonePosition {};
-			FHGMSIMDLibrary::Store(Solver->Positions, sShear.sFirstBoneUnpackedIndex, sFirstBonePosition);
-			const FHGMSIMDVector3 sWorldFirstBonePosition = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, sFirstBonePosition);
+		TStaticArray<FHGMVector3, 4> FirstBonePositions {};
+		FHGMSIMDLibrary::Store(sWorldFirstBonePosition, FirstBonePositions);
 
-			TStaticArray<FHGMVector3, 4> FirstBonePositions {};
-			FHGMSIMDLibrary::Store(sWorldFirstBonePosition, FirstBonePositions);
+		FHGMSIMDVector3 sSecondBonePositions {};
+		FHGMSIMDLibrary::Store(Solver->Positions, sShear.sSecondBoneUnpackedIndex, sSecondBonePositions);
+		const FHGMSIMDVector3 sWorldSecondBonePosition = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, sSecondBonePositions);
 
-			FHGMSIMDVector3 sSecondBonePositions {};
-			FHGMSIMDLibrary::Store(Solver->Positions, sShear.sSecondBoneUnpackedIndex, sSecondBonePositions);
-			const FHGMSIMDVector3 sWorldSecondBonePosition = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, sSecondBonePositions);
+		TStaticArray<FHGMVector3, 4> SecondBonePositions {};
+		FHGMSIMDLibrary::Store(sWorldSecondBonePosition, SecondBonePositions);
 
-			TStaticArray<FHGMVector3, 4> SecondBonePositions {};
-			FHGMSIMDLibrary::Store(sWorldSecondBonePosition, SecondBonePositions);
+		TStaticArray<int32, 4> FirstBoneUnpackedIndexes {};
+		FHGMSIMDLibrary::Store(sShear.sFirstBoneUnpackedIndex, FirstBoneUnpackedIndexes);
 
-			TStaticArray<FHGMReal, 4> DummyFirstBoneMasks {};
-			FHGMSIMDLibrary::Store(Solver->DummyBoneMasks, sShear.sFirstBoneUnpackedIndex, DummyFirstBoneMasks);
+		TStaticArray<int32, 4> SecondBoneUnpackedIndexes {};
+		FHGMSIMDLibrary::Store(sShear.sSecondBoneUnpackedIndex, SecondBoneUnpackedIndexes);
 
-			TStaticArray<FHGMReal, 4> DummySecondBoneMasks {};
-			FHGMSIMDLibrary::Store(Solver->DummyBoneMasks, sShear.sSecondBoneUnpackedIndex, DummySecondBoneMasks);
+		TStaticArray<FHGMReal, 4> DummyFirstBoneMasks {};
+		TStaticArray<FHGMReal, 4> DummySecondBoneMasks {};
+		for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
+		{
+			const int32 FirstBoneUnpackedIndex = FirstBoneUnpackedIndexes[ComponentIndex];
+			FHGMSIMDLibrary::Store(Solver->GetParticleParameters()[FirstBoneUnpackedIndex / 4].sDummyBoneMask, FirstBoneUnpackedIndex % 4, DummyFirstBoneMasks[ComponentIndex]);
+
+			const int32 SecondBoneUnpackedIndex = SecondBoneUnpackedIndexes[ComponentIndex];
+			FHGMSIMDLibrary::Store(Solver->GetParticleParameters()[SecondBoneUnpackedIndex / 4].sDummyBoneMask, SecondBoneUnpackedIndex % 4, DummySecondBoneMasks[ComponentIndex]);
+		}
 
-			for (int32 ComponentIndex = 0; ComponentIndex <= EndComponentIndex; ++ComponentIndex)
+		for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
+		{
+			if ((ActiveComponentBits & (1 << ComponentIndex)) == 0)
 			{
-				if (DummyFirstBoneMasks[ComponentIndex] > 0.0 || DummySecondBoneMasks[ComponentIndex] > 0.0)
-				{
-					continue;
-				}
+				continue;
+			}
 
-				PoseContext.AnimInstanceProxy->AnimDrawDebugLine(FirstBonePositions[ComponentIndex], SecondBonePositions[ComponentIndex], Colors[Offset], false, -1.0f, 0.5f, DepthPriority);
+			if (DummyFirstBoneMasks[ComponentIndex] > 0.0 || DummySecondBoneMasks[ComponentIndex] > 0.0)
+			{
+				continue;
 			}
+
+			PoseContext.AnimInstanceProxy->AnimDrawDebugLine(FirstBonePositions[ComponentIndex], SecondBonePositions[ComponentIndex], Colors[ColorIndex], false, -1.0f, 0.5f, DepthPriority);
 		}
 	}
 }
@@ -403,11 +437,11 @@ void FHGMDebugLibrary::DrawAnimPoseMovableRadiusConstraint(FComponentSpacePoseCo
 
 	for (int32 PackedIndex = 0; PackedIndex < Solver->Positions.Num(); ++PackedIndex)
 	{
-		const FHGMSIMDReal& sDummyBoneMask = Solver->DummyBoneMasks[PackedIndex];
+		const FHGMSIMDReal& sDummyBoneMask = Solver->GetParticleParameters()[PackedIndex].sDummyBoneMask;
 
 		const FHGMSIMDVector3& sAnimPosition = Solver->AnimPosePositions[PackedIndex];
 		const FHGMSIMDVector3 sWorldAnimPosition = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, sAnimPosition);
-		const FHGMSIMDReal& sMovableRadius = Solver->AnimPoseConstraintMovableRadiuses[PackedIndex].sRadius;
+		const FHGMSIMDReal& sMovableRadius = Solver->Template->AnimPoseConstraintMovableRadiuses[PackedIndex].sRadius;
 		FHGMDebugLibrary::DrawSphere(PoseContext, sWorldAnimPosition, sMovableRadius * (HGMSIMDConstants::OneReal - sDummyBoneMask), 12, FColor(255, 196, 102, 255), DepthPriority);
 
 		const FHGMSIMDVector3& sPosition = Solver->Positions[PackedIndex];
@@ -446,13 +480,13 @@ void FHGMDebugLibrary::DrawAnimPoseLimitAngleConstraint(FComponentSpacePoseConte
 		FHGMSIMDLibrary::Store(sWorldSecondBonePosition, UnpackedWorldSecondBonePositions);
 
 		TStaticArray<FHGMReal, 4> UnpackedFirstBoneDummyMasks {};
-		FHGMSIMDLibrary::Store(Solver->DummyBoneMasks[VerticalStructure.FirstBonePackedIndex], UnpackedFirstBoneDummyMasks);
+		FHGMSIMDLibrary::Store(Solver->GetParticleParameters()[VerticalStructure.FirstBonePackedIndex].sDummyBoneMask, UnpackedFirstBoneDummyMasks);
 
 		TStaticArray<FHGMReal, 4> UnpackedSecondBoneDummyMasks {};
-		FHGMSIMDLibrary::Store(Solver->DummyBoneMasks[VerticalStructure.SecondBonePackedIndex], UnpackedSecondBoneDummyMasks);
+		FHGMSIMDLibrary::Store(Solver->GetParticleParameters()[VerticalStructure.SecondBonePackedIndex].sDummyBoneMask, UnpackedSecondBoneDummyMasks);
 
 		TStaticArray<FHGMReal, 4> UnpackedLimitAngles {};
-		FHGMSIMDLibrary::Store(Solver->AnimPoseConstraintLimitAngles[VerticalStructure.FirstBonePackedIndex].sAngle, UnpackedLimitAngles);
+		FHGMSIMDLibrary::Store(Solver->Template->AnimPoseConstraintLimitAngles[VerticalStructure.FirstBonePackedIndex].sAngle, UnpackedLimitAngles);
 
 		TStaticArray<FHGMReal, 4> UnpackedLength {};
 		FHGMSIMDLibrary::Store(VerticalStructure.sLength, UnpackedLength);
@@ -486,16 +520,14 @@ void FHGMDebugLibrary::DrawAnimPosePlanarConstraint(FComponentSpacePoseContext&
 		return;
 	}
 
-	const FBoneContainer& BoneContainer = PoseContext.Pose.GetPose().GetBoneContainer();
-
 	const FHGMTransform& SkeletalMeshComponentTransform = PoseContext.AnimInstanceProxy->GetComponentTransform();
 	FHGMSIMDTransform sSkeletalMeshComponentTransform {};
 	FHGMSIMDLibrary::Load(sSkeletalMeshComponentTransform, SkeletalMeshComponentTransform);
 
-	for (int32 PackedIndex = 0; PackedIndex < Solver->AnimPosePlanarConstraintAxes.Num(); ++PackedIndex)
+	for (int32 PackedIndex = 0; PackedIndex < Solver->Template->AnimPosePlanarConstraintAxes.Num(); ++PackedIndex)
 	{
 		TStaticArray<int32, 4> UnpackedAxes {};
-		FHGMSIMDLibrary::Store(Solver->AnimPosePlanarConstraintAxes[PackedIndex], UnpackedAxes);
+		FHGMSIMDLibrary::Store(Solver->Template->AnimPosePlanarConstraintAxes[PackedIndex], UnpackedAxes);
 
 		const FHGMSIMDVector3 sWorldPosition = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, Solver->Positions[PackedIndex]);
 		TStaticArray<FHGMVector3, 4> UnpackedWorldPositions {};
@@ -510,10 +542,9 @@ void FHGMDebugLibrary::DrawAnimPosePlanarConstraint(FComponentSpacePoseContext&
 
 			FHGMTransform BoneTransform = FHGMTransform::Identity;
 
-			const FBoneReference& Bone = Solver->Bones[(PackedIndex * 4) + ComponentIndex];
-			if (Bone.IsValidToEvaluate())
+			const FCompactPoseBoneIndex& BoneIndex = Solver->CompactPoseBoneIndexes[(PackedIndex * 4) + ComponentIndex];
+			if (BoneIndex.IsValid())
 			{
-				const FCompactPoseBoneIndex BoneIndex = Bone.GetCompactPoseIndex(BoneContainer);
 				BoneTransform = PoseContext.Pose.GetComponentSpaceTransform(BoneIndex);
 			}
 
@@ -547,10 +578,10 @@ void FHGMDebugLibrary::DrawRelativeLimitAngleConstraint(FComponentSpacePoseConte
 
 	for (int32 StructureIndex = 0; StructureIndex < Solver->VerticalStructures.Num(); ++StructureIndex)
 	{
-		const int32 HorizontalIndex = StructureIndex % Solver->SimulationPlane.PackedHorizontalBoneNum;
+		const int32 HorizontalIndex = StructureIndex % Solver->Template->SimulationPlane.PackedHorizontalBoneNum;
 
 		const FHGMSIMDStructure& sVerticalStructure = Solver->VerticalStructures[StructureIndex];
-		const FHGMSIMDReal& sAngle = Solver->RelativeLimitAngles[StructureIndex].sAngle;
+		const FHGMSIMDReal& sAngle = Solver->Template->RelativeLimitAngles[StructureIndex].sAngle;
 
 		const FHGMSIMDVector3 sStart = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, Solver->Positions[sVerticalStructure.FirstBonePackedIndex]);
 		const FHGMSIMDVector3 sEnd = FHGMMathLibrary::TransformPosition(sSkeletalMeshComponentTransform, Solver->Positions[sVerticalStructure.SecondBonePackedIndex]);
@@ -573,10 +604,10 @@ void FHGMDebugLibrary::DrawRelativeLimitAngleConstraint(FComponentSpacePoseConte
 		FHGMSIMDLibrary::Store(sAngle, UnpackedAngles);
 
 		TStaticArray<FHGMReal, 4> UnpackedFirstDummyMasks {};
-		FHGMSIMDLibrary::Store(Solver->DummyBoneMasks[sVerticalStructure.FirstBonePackedIndex], UnpackedFirstDummyMasks);
+		FHGMSIMDLibrary::Store(Solver->GetParticleParameters()[sVerticalStructure.FirstBonePackedIndex].sDummyBoneMask, UnpackedFirstDummyMasks);
 
 		TStaticArray<FHGMReal, 4> UnpackedSecondDummyMasks {};
-		FHGMSIMDLibrary::Store(Solver->DummyBoneMasks[sVerticalStructure.SecondBonePackedIndex], UnpackedSecondDummyMasks);
+		FHGMSIMDLibrary::Store(Solver->GetParticleParameters()[sVerticalStructure.SecondBonePackedIndex].sDummyBoneMask, UnpackedSecondDummyMasks);
 
 		for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
 		{
@@ -608,7 +639,7 @@ void FHGMDebugLibrary::DrawVelocities(FComponentSpacePoseContext& PoseContext, c
 		TStaticArray<FHGMReal, 4> UnpackedVelocitySizeArray {};
 		FHGMSIMDLibrary::Store(sVelocitySize, UnpackedVelocitySizeArray);
 
-		const FHGMSIMDReal& sDummyBoneMask = Solver->DummyBoneMasks[PackedIndex];
+		const FHGMSIMDReal& sDummyBoneMask = Solver->GetParticleParameters()[PackedIndex].sDummyBoneMask;
 		TStaticArray<FHGMReal, 4> UnpackedDummyBoneMasks {};
 		FHGMSIMDLibrary::Store(sDummyBoneMask, UnpackedDummyBoneMasks);
 
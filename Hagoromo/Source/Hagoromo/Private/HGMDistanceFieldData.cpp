@@ -0,0 +1,146 @@
+// Hagoromo : Copyright (c) 2025 nozoxa_0131, MIT License
+
+#include "HGMDistanceFieldData.h"
+#include "HagoromoModule.h"
+
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/SkeletalBodySetup.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+
+namespace DistanceFieldDataInternal
+{
+	// Increase when layout of FHGMDistanceField changes.
+	static constexpr int32 DistanceFieldVersion = 1;
+}
+
+
+void UHagoromoDistanceFieldData::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Distance fields are written as single blob with header, so that data of incompatible build is skipped as whole.
+	TArray<uint8> DistanceFieldBlob {};
+	if (Ar.IsSaving() && !DistanceFields.IsEmpty())
+	{
+		FMemoryWriter Writer(DistanceFieldBlob);
+
+		int32 Version = DistanceFieldDataInternal::DistanceFieldVersion;
+		int32 RealSize = sizeof(FHGMReal);
+		int32 DistanceFieldNum = DistanceFields.Num();
+		Writer << Version;
+		Writer << RealSize;
+		Writer << DistanceFieldNum;
+
+		for (const TSharedPtr<FHGMDistanceField>& DistanceField : DistanceFields)
+		{
+			DistanceField->Serialize(Writer);
+		}
+	}
+
+	Ar << DistanceFieldBlob;
+
+	if (Ar.IsLoading())
+	{
+		DistanceFields.Reset();
+
+		if (DistanceFieldBlob.IsEmpty())
+		{
+			return;
+		}
+
+		FMemoryReader Reader(DistanceFieldBlob);
+
+		int32 Version = 0;
+		int32 RealSize = 0;
+		int32 DistanceFieldNum = 0;
+		Reader << Version;
+		Reader << RealSize;
+		Reader << DistanceFieldNum;
+
+		if (Version != DistanceFieldDataInternal::DistanceFieldVersion || RealSize != sizeof(FHGMReal))
+		{
+			HGM_LOG(Warning, TEXT("Distance field data %s was built with different version or precision. Resave it to rebuild distance fields."), *GetPathName());
+			return;
+		}
+
+		DistanceFields.Reserve(DistanceFieldNum);
+		for (int32 DistanceFieldIndex = 0; DistanceFieldIndex < DistanceFieldNum; ++DistanceFieldIndex)
+		{
+			TSharedPtr<FHGMDistanceField> DistanceField = MakeShared<FHGMDistanceField>();
+			DistanceField->Serialize(Reader);
+			DistanceFields.Emplace(MoveTemp(DistanceField));
+		}
+	}
+}
+
+
+TSharedPtr<const FHGMDistanceField> UHagoromoDistanceFieldData::FindDistanceField(FName BoneName) const
+{
+	for (const TSharedPtr<FHGMDistanceField>& DistanceField : DistanceFields)
+	{
+		if (DistanceField->BoneName == BoneName)
+		{
+			return DistanceField;
+		}
+	}
+
+	return nullptr;
+}
+
+
+#if WITH_EDITOR
+void UHagoromoDistanceFieldData::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	BuildDistanceFields();
+}
+
+
+void UHagoromoDistanceFieldData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Rebake immediately, so that nodes initialized before asset is saved use distance fields of current settings.
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(UHagoromoDistanceFieldData, PhysicsAsset) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(UHagoromoDistanceFieldData, VoxelSize) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(UHagoromoDistanceFieldData, Padding) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(UHagoromoDistanceFieldData, MaxResolution))
+	{
+		BuildDistanceFields();
+	}
+}
+
+
+bool UHagoromoDistanceFieldData::BuildDistanceFields()
+{
+	DistanceFields.Reset();
+
+	if (!PhysicsAsset)
+	{
+		return false;
+	}
+
+	for (const TObjectPtr<USkeletalBodySetup> SkeletalBodySetup : PhysicsAsset->SkeletalBodySetups)
+	{
+		if (!SkeletalBodySetup)
+		{
+			continue;
+		}
+
+		TSharedPtr<FHGMDistanceField> DistanceField = MakeShared<FHGMDistanceField>();
+		if (!FHGMCollisionLibrary::BuildDistanceField(SkeletalBodySetup->BoneName, SkeletalBodySetup->AggGeom, VoxelSize, Padding, MaxResolution, *DistanceField))
+		{
+			HGM_LOG(Log, TEXT("Body %s has no sphere, capsule or box, so distance field is not built."), *SkeletalBodySetup->BoneName.ToString());
+			continue;
+		}
+
+		DistanceFields.Emplace(MoveTemp(DistanceField));
+	}
+
+	return !DistanceFields.IsEmpty();
+}
+#endif
@@ -301,6 +301,23 @@ FHGMSIMDVector3 FHGMSIMDLibrary::Select(const FHGMSIMDReal& Mask, const FHGMSIMD
 }
 
 
+FHGMSIMDVector3 FHGMSIMDLibrary::ShiftComponentsLeft(const FHGMSIMDVector3& V, const FHGMSIMDVector3& W)
+{
+	FHGMSIMDVector3 Result {};
+	FHGMSIMDLibrary::Load(Result, FHGMSIMDLibrary::ShiftComponentsLeft(V.X, W.X), FHGMSIMDLibrary::ShiftComponentsLeft(V.Y, W.Y), FHGMSIMDLibrary::ShiftComponentsLeft(V.Z, W.Z));
+
+	return Result;
+}
+
+
+void FHGMSIMDLibrary::UnshiftComponentsLeft(const FHGMSIMDVector3& V, FHGMSIMDVector3& A, FHGMSIMDVector3& B)
+{
+	FHGMSIMDLibrary::UnshiftComponentsLeft(V.X, A.X, B.X);
+	FHGMSIMDLibrary::UnshiftComponentsLeft(V.Y, A.Y, B.Y);
+	FHGMSIMDLibrary::UnshiftComponentsLeft(V.Z, A.Z, B.Z);
+}
+
+
 FHGMSIMDQuaternion FHGMSIMDLibrary::Select(const FHGMSIMDReal& sMask, const FHGMSIMDQuaternion& sQ1, const FHGMSIMDQuaternion& sQ2)
 {
 	FHGMSIMDQuaternion sResult {};
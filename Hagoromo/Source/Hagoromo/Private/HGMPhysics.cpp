@@ -7,128 +7,307 @@
 #include "Math/Axis.h"
 
 
-void FHGMPhysicsLibrary::ApplyForces(FComponentSpacePoseContext& Output, const FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions,
-								TConstArrayView<FHGMSIMDReal> WorldVelocityDampings, TConstArrayView<FHGMSIMDReal> WorldAngularVelocityDampings, TConstArrayView<FHGMSIMDReal> SimulationVelocityDampings, TConstArrayView<FHGMSIMDReal> SimulationAngularVelocityDampings, TConstArrayView<FHGMSIMDReal> MasterDampings,
-								TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks)
+// Specify an internal linkage as unnamed space may not work depending on unity build.
+namespace PhysicsInternal
 {
-	SCOPE_CYCLE_COUNTER(STAT_PhysicsApplyForces);
+	// Movement of actor, SimulationRootBone and gravity in component space. Shared by all bones in a step.
+	struct FExternalForces
+	{
+		FHGMSIMDVector3 sWorldVelocity = FHGMSIMDVector3::ZeroVector;
+		FHGMSIMDQuaternion sWorldAngularVelocity = FHGMSIMDQuaternion::Identity;
+		FHGMSIMDVector3 sSimulationVelocity = FHGMSIMDVector3::ZeroVector;
+		FHGMSIMDQuaternion sSimulationAngularVelocity = FHGMSIMDQuaternion::Identity;
+		FHGMSIMDVector3 sGravity = FHGMSIMDVector3::ZeroVector;
+	};
+
 
-	// World Movement :
-	FHGMVector3 WorldVelocity = PhysicsContext.SkeletalMeshComponentTransform.InverseTransformPosition(PhysicsContext.PrevSkeletalMeshComponentTransform.GetTranslation());
-	if (FHGMMathLibrary::LengthSquared(WorldVelocity) > (PhysicsContext.PhysicsSettings.IgnoreWorldVelocityThreshold * PhysicsContext.PhysicsSettings.IgnoreWorldVelocityThreshold))
+	static FExternalForces CalculateExternalForces(FComponentSpacePoseContext& Output, const FHGMPhysicsContext& PhysicsContext)
 	{
-		WorldVelocity = FHGMVector3::ZeroVector;
+		FExternalForces ExternalForces {};
+
+		// World Movement :
+		FHGMVector3 WorldVelocity = PhysicsContext.SkeletalMeshComponentTransform.InverseTransformPosition(PhysicsContext.PrevSkeletalMeshComponentTransform.GetTranslation());
+		if (FHGMMathLibrary::LengthSquared(WorldVelocity) > (PhysicsContext.PhysicsSettings.IgnoreWorldVelocityThreshold * PhysicsContext.PhysicsSettings.IgnoreWorldVelocityThreshold))
+		{
+			WorldVelocity = FHGMVector3::ZeroVector;
+		}
+		FHGMSIMDLibrary::Load(ExternalForces.sWorldVelocity, WorldVelocity);
+
+		// World Rotation :
+		FHGMQuaternion RotationDifference = PhysicsContext.SkeletalMeshComponentTransform.InverseTransformRotation(PhysicsContext.PrevSkeletalMeshComponentTransform.GetRotation());
+		RotationDifference.Normalize();
+		if (FHGMMathLibrary::RadiansToDegrees(RotationDifference.GetAngle()) > PhysicsContext.PhysicsSettings.IgnoreWorldAngularVelocityThreshold)
+		{
+			RotationDifference = FHGMQuaternion::Identity;
+		}
+		FHGMSIMDLibrary::Load(ExternalForces.sWorldAngularVelocity, RotationDifference);
+
+		if (PhysicsContext.PhysicsSettings.bUseSimulationRootBone)
+		{
+			// SimulationRootBone Movement :
+			FHGMVector3 SimulationVelocity = PhysicsContext.SimulationRootBoneTransform.InverseTransformPosition(PhysicsContext.PrevSimulationRootBoneTransform.GetTranslation());
+			if (FHGMMathLibrary::LengthSquared(SimulationVelocity) > (PhysicsContext.PhysicsSettings.IgnoreSimulationVelocityThreshold * PhysicsContext.PhysicsSettings.IgnoreSimulationVelocityThreshold))
+			{
+				SimulationVelocity = FHGMVector3::ZeroVector;
+			}
+			FHGMSIMDLibrary::Load(ExternalForces.sSimulationVelocity, SimulationVelocity);
+
+			// SimulationRootBone Rotation :
+			FHGMQuaternion SimulationRotationDifference = PhysicsContext.SimulationRootBoneTransform.InverseTransformRotation(PhysicsContext.PrevSimulationRootBoneTransform.GetRotation());
+			if (FHGMMathLibrary::RadiansToDegrees(SimulationRotationDifference.GetAngle()) > PhysicsContext.PhysicsSettings.IgnoreSimulationAngularVelocityThreshold)
+			{
+				SimulationRotationDifference = FHGMQuaternion::Identity;
+			}
+			FHGMSIMDLibrary::Load(ExternalForces.sSimulationAngularVelocity, SimulationRotationDifference);
+		}
+
+		// Gravity :
+		static FHGMReal MeterToCentimeter = 100.0;
+		const FHGMGravitySettings& GravitySettings = PhysicsContext.PhysicsSettings.GravitySettings;
+		if (GravitySettings.bUseBoneSpaceGravity && GravitySettings.DrivingBone.IsValidToEvaluate())
+		{
+			const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
+			const FCompactPoseBoneIndex DrivingBoneIndex = GravitySettings.DrivingBone.GetCompactPoseIndex(BoneContainer);
+			const FHGMTransform& DrivingBoneTransform = Output.Pose.GetComponentSpaceTransform(DrivingBoneIndex);
+			const FHGMVector3 Gravity = DrivingBoneTransform.GetUnitAxis(GravitySettings.Axis) * GravitySettings.Gravity * MeterToCentimeter;
+			FHGMSIMDLibrary::Load(ExternalForces.sGravity, Gravity);
+		}
+		else
+		{
+			const FHGMVector3 Gravity = PhysicsContext.SkeletalMeshComponentTransform.InverseTransformVector(-(FHGMVector3::UpVector * GravitySettings.Gravity * MeterToCentimeter));
+			FHGMSIMDLibrary::Load(ExternalForces.sGravity, Gravity);
+		}
+
+		return ExternalForces;
 	}
-	FHGMSIMDVector3 sWorldVelocity {};
-	FHGMSIMDLibrary::Load(sWorldVelocity, WorldVelocity);
 
-	// World Rotation :
-	FHGMQuaternion RotationDifference = PhysicsContext.SkeletalMeshComponentTransform.InverseTransformRotation(PhysicsContext.PrevSkeletalMeshComponentTransform.GetRotation());
-	RotationDifference.Normalize();
-	if (FHGMMathLibrary::RadiansToDegrees(RotationDifference.GetAngle()) > PhysicsContext.PhysicsSettings.IgnoreWorldAngularVelocityThreshold)
+
+	// Displacement by velocities of actor and SimulationRootBone, before scaling by inertia and friction.
+	template<bool bUseSimulationRootBone>
+	FORCEINLINE static FHGMSIMDVector3 CalculateInertialDisplacement(const FExternalForces& ExternalForces, const FHGMSIMDVector3& sPrevPosition,
+														const FHGMSIMDReal& sWorldVelocityDamping, const FHGMSIMDReal& sWorldAngularVelocityDamping, const FHGMSIMDReal& sSimulationVelocityDamping, const FHGMSIMDReal& sSimulationAngularVelocityDamping)
 	{
-		RotationDifference = FHGMQuaternion::Identity;
+		// Calculate world movement.
+		const FHGMSIMDReal sWorldVelocityInfluence = FHGMMathLibrary::Lerp(HGMSIMDConstants::OneReal, HGMSIMDConstants::ZeroReal, sWorldVelocityDamping);
+		const FHGMSIMDVector3 sAdjustedWorldVelocity = sWorldVelocityInfluence * ExternalForces.sWorldVelocity;
+
+		// Calculate world rotation.
+		const FHGMSIMDVector3 sLinearizedWorldAngularVelocity = FHGMMathLibrary::RotateVector(ExternalForces.sWorldAngularVelocity, sPrevPosition) - sPrevPosition;
+		const FHGMSIMDReal sWorldAngularVelocityInfluence = FHGMMathLibrary::Lerp(HGMSIMDConstants::OneReal, HGMSIMDConstants::ZeroReal, sWorldAngularVelocityDamping);
+		const FHGMSIMDVector3 sDampedWorldAngularVelocity = sLinearizedWorldAngularVelocity * sWorldAngularVelocityInfluence;
+
+		if constexpr (bUseSimulationRootBone)
+		{
+			// Calculate simulation movement.
+			const FHGMSIMDReal sSimulationVelocityInfluence = FHGMMathLibrary::Lerp(HGMSIMDConstants::OneReal, HGMSIMDConstants::ZeroReal, sSimulationVelocityDamping);
+			const FHGMSIMDVector3 sAdjustedSimulationVelocity = ExternalForces.sSimulationVelocity * sSimulationVelocityInfluence;
+
+			// Calculate simulation rotation.
+			const FHGMSIMDVector3 sLinearizedSimulationAngularVelocity = FHGMMathLibrary::RotateVector(ExternalForces.sSimulationAngularVelocity, sPrevPosition) - sPrevPosition;
+			const FHGMSIMDReal sSimulationAngularVelocityInfluence = FHGMMathLibrary::Lerp(HGMSIMDConstants::OneReal, HGMSIMDConstants::ZeroReal, sSimulationAngularVelocityDamping);
+			const FHGMSIMDVector3 sDampedSimulationAngularVelocity = sLinearizedSimulationAngularVelocity * sSimulationAngularVelocityInfluence;
+
+			return sAdjustedWorldVelocity + sDampedWorldAngularVelocity + sAdjustedSimulationVelocity + sDampedSimulationAngularVelocity;
+		}
+		else
+		{
+			return sAdjustedWorldVelocity + sDampedWorldAngularVelocity;
+		}
 	}
 
-	FHGMSIMDQuaternion sWorldAngularVelocity;
-	FHGMSIMDLibrary::Load(sWorldAngularVelocity, RotationDifference);
 
-	FHGMSIMDVector3 sSimulationVelocity = FHGMSIMDVector3::ZeroVector;
-	FHGMSIMDQuaternion sSimulationAngularVelocity = FHGMSIMDQuaternion::Identity;
-	if (PhysicsContext.PhysicsSettings.bUseSimulationRootBone)
+	// Dampings of each bone referred by force kernels.
+	struct FBoneDampings
 	{
-		// SimulationRootBone Movement :
-		FHGMVector3 SimulationVelocity = PhysicsContext.SimulationRootBoneTransform.InverseTransformPosition(PhysicsContext.PrevSimulationRootBoneTransform.GetTranslation());
-		if (FHGMMathLibrary::LengthSquared(SimulationVelocity) > (PhysicsContext.PhysicsSettings.IgnoreSimulationVelocityThreshold * PhysicsContext.PhysicsSettings.IgnoreSimulationVelocityThreshold))
+		const FHGMSIMDBoneParameter& WorldVelocityDampings;
+		const FHGMSIMDBoneParameter& WorldAngularVelocityDampings;
+		const FHGMSIMDBoneParameter& SimulationVelocityDampings;
+		const FHGMSIMDBoneParameter& SimulationAngularVelocityDampings;
+		const FHGMSIMDBoneParameter& MasterDampings;
+
+		FORCEINLINE bool IsUniform() const
 		{
-			SimulationVelocity = FHGMVector3::ZeroVector;
+			return WorldVelocityDampings.bIsUniform && WorldAngularVelocityDampings.bIsUniform && SimulationVelocityDampings.bIsUniform && SimulationAngularVelocityDampings.bIsUniform && MasterDampings.bIsUniform;
 		}
-		FHGMSIMDLibrary::Load(sSimulationVelocity, SimulationVelocity);
+	};
 
-		// SimulationRootBone Rotation :
-		FHGMQuaternion SimulationRotationDifference = PhysicsContext.SimulationRootBoneTransform.InverseTransformRotation(PhysicsContext.PrevSimulationRootBoneTransform.GetRotation());
-		if (FHGMMathLibrary::RadiansToDegrees(SimulationRotationDifference.GetAngle()) > PhysicsContext.PhysicsSettings.IgnoreSimulationAngularVelocityThreshold)
+
+	// Uniform parameter is read from single register, so it is hoisted out of loop instead of being loaded per bone.
+	template<bool bUniformParameter>
+	FORCEINLINE static const FHGMSIMDReal& GetParameter(const FHGMSIMDBoneParameter& Parameter, int32 PackedIndex)
+	{
+		if constexpr (bUniformParameter)
 		{
-			SimulationRotationDifference = FHGMQuaternion::Identity;
+			return Parameter.GetUniformValue();
+		}
+		else
+		{
+			return Parameter[PackedIndex];
 		}
-
-		FHGMSIMDLibrary::Load(sSimulationAngularVelocity, SimulationRotationDifference);
 	}
 
-	// Gravity :
-	static FHGMReal MeterToCentimeter = 100.0;
-	const FHGMGravitySettings& GravitySettings = PhysicsContext.PhysicsSettings.GravitySettings;
-	FHGMSIMDVector3 sGravity = FHGMSIMDVector3::ZeroVector;
-	if (GravitySettings.bUseBoneSpaceGravity && GravitySettings.DrivingBone.IsValidToEvaluate())
-	{
-		const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
-		const FCompactPoseBoneIndex DrivingBoneIndex = GravitySettings.DrivingBone.GetCompactPoseIndex(BoneContainer);
-		const FHGMTransform& DrivingBoneTransform = Output.Pose.GetComponentSpaceTransform(DrivingBoneIndex);
-		const FHGMVector3 Gravity = DrivingBoneTransform.GetUnitAxis(GravitySettings.Axis) * GravitySettings.Gravity * MeterToCentimeter;
-		FHGMSIMDLibrary::Load(sGravity, Gravity);
+
+	template<bool bUseSimulationRootBone, bool bUniformDampings>
+	FORCEINLINE static FHGMSIMDVector3 CalculateBoneInertialDisplacement(const FExternalForces& ExternalForces, const FBoneDampings& Dampings, const FHGMSIMDVector3& sPrevPosition, int32 PackedIndex)
+	{
+		return CalculateInertialDisplacement<bUseSimulationRootBone>(ExternalForces, sPrevPosition,
+																	GetParameter<bUniformDampings>(Dampings.WorldVelocityDampings, PackedIndex), GetParameter<bUniformDampings>(Dampings.WorldAngularVelocityDampings, PackedIndex),
+																	GetParameter<bUniformDampings>(Dampings.SimulationVelocityDampings, PackedIndex), GetParameter<bUniformDampings>(Dampings.SimulationAngularVelocityDampings, PackedIndex));
 	}
-	else
+
+
+	// Fraction of velocity kept by integration.
+	// Frictions are either zero or friction of bone, so retained friction of Small Steps is selected by whether friction is set.
+	FORCEINLINE static FHGMSIMDReal CalculateVelocityRetention(const FHGMPhysicsContext& PhysicsContext, bool bUseSmallSteps, const FHGMSIMDReal& sActualFriction, const FHGMSIMDReal& sMasterDamping, int32 PackedIndex)
 	{
-		const FHGMVector3 Gravity = PhysicsContext.SkeletalMeshComponentTransform.InverseTransformVector(-(FHGMVector3::UpVector * GravitySettings.Gravity * MeterToCentimeter));
-		FHGMSIMDLibrary::Load(sGravity, Gravity);
+		if (bUseSmallSteps)
+		{
+			const FHGMSIMDReal sFrictionRetention = FHGMSIMDLibrary::Select(sActualFriction > HGMSIMDConstants::ZeroReal, PhysicsContext.SmallStepFrictionRetentions[PackedIndex], HGMSIMDConstants::OneReal);
+			return PhysicsContext.SmallStepMasterDampingRetentions[PackedIndex] * sFrictionRetention;
+		}
+
+		return (HGMSIMDConstants::OneReal - sActualFriction) * (HGMSIMDConstants::OneReal - sMasterDamping);
 	}
 
-	// Apply force.
-	// #OPTIMIZE
-	// Considering cache hit rate, it may be better to separate loops by type of force.
-	const FHGMSIMDReal sDeltaTimeChangeFactor = PhysicsContext.sDeltaTime / PhysicsContext.sPrevDeltaTime;
-	for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
+
+	// Per-bone part of ApplyForces(). Specialized by SimulationRootBone and uniform dampings so that loop does not branch on settings.
+	template<bool bUseSimulationRootBone, bool bUniformDampings>
+	static void AddForces(const FHGMPhysicsContext& PhysicsContext, const FExternalForces& ExternalForces, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDVector3> PrevPositions,
+						const FBoneDampings& Dampings, TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
 	{
-		const FHGMSIMDReal sFriction = HGMSIMDConstants::OneReal - Frictions[PackedIndex];
+		const FHGMSIMDReal sDeltaTimeChangeFactor = PhysicsContext.sDeltaTime / PhysicsContext.sPrevDeltaTime;
+		const FHGMSIMDVector3 sGravityDisplacement = (ExternalForces.sGravity * PhysicsContext.sDeltaTime * PhysicsContext.sDeltaTime) * sDeltaTimeChangeFactor * PhysicsContext.sGravityScale;
+		const FHGMSIMDReal sInertiaScale = sDeltaTimeChangeFactor * PhysicsContext.sInertiaScale;
+		for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
+		{
+			const FHGMSIMDReal sFriction = HGMSIMDConstants::OneReal - Frictions[PackedIndex];
+			const FHGMSIMDReal& sMovableWeight = ParticleParameters[PackedIndex].sMovableWeight;
 
-		// Calculate world movement.
-		const FHGMSIMDReal sWorldVelocityInfluence = FHGMMathLibrary::Lerp(HGMSIMDConstants::OneReal, HGMSIMDConstants::ZeroReal, WorldVelocityDampings[PackedIndex]);
-		const FHGMSIMDVector3 sAdjustedWorldVelocity = sWorldVelocityInfluence * sWorldVelocity;
+			const FHGMSIMDVector3 sInertialDisplacement = CalculateBoneInertialDisplacement<bUseSimulationRootBone, bUniformDampings>(ExternalForces, Dampings, PrevPositions[PackedIndex], PackedIndex);
 
-		// Calculate world rotation.
-		FHGMSIMDVector3 sLinearizedWorldAngularVelocity {};
-		sLinearizedWorldAngularVelocity = FHGMMathLibrary::RotateVector(sWorldAngularVelocity, PrevPositions[PackedIndex]) - PrevPositions[PackedIndex];
-		const FHGMSIMDReal sWorldAngularVelocityDamping = FHGMMathLibrary::Lerp(HGMSIMDConstants::OneReal, HGMSIMDConstants::ZeroReal, WorldAngularVelocityDampings[PackedIndex]);
-		FHGMSIMDVector3 sDampedWorldAngularVelocity = sLinearizedWorldAngularVelocity * sWorldAngularVelocityDamping;
+			// Add gravity and velocities.
+			Positions[PackedIndex] += (sGravityDisplacement + sInertialDisplacement * sInertiaScale * sFriction) * sMovableWeight;
+		}
+	}
 
-		FHGMSIMDVector3 sAdjustedSimulationVelocity = FHGMSIMDVector3::ZeroVector;
-		FHGMSIMDVector3 sDampedSimulationAngularVelocity = FHGMSIMDVector3::ZeroVector;
-		if (PhysicsContext.PhysicsSettings.bUseSimulationRootBone)
+
+	// Per-bone part of IntegrateForces(). Forces, verlet integration and fixed blend are done while bone is in register.
+	template<bool bUseSimulationRootBone, bool bUniformDampings>
+	static void AddForcesAndIntegrate(const FHGMPhysicsContext& PhysicsContext, const FExternalForces& ExternalForces, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, TConstArrayView<FHGMSIMDVector3> AnimPosePositions,
+									const FBoneDampings& Dampings, TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
+	{
+		// sDeltaTimeChangeFactor was adopted from 「 https://en.wikipedia.org/wiki/Verlet_integration > Non-constant time differences 」.
+		const FHGMSIMDReal sDeltaTimeChangeFactor = PhysicsContext.sDeltaTime / PhysicsContext.sPrevDeltaTime;
+		const FHGMSIMDVector3 sGravityDisplacement = (ExternalForces.sGravity * PhysicsContext.sDeltaTime * PhysicsContext.sDeltaTime) * sDeltaTimeChangeFactor * PhysicsContext.sGravityScale;
+		const FHGMSIMDReal sInertiaScale = sDeltaTimeChangeFactor * PhysicsContext.sInertiaScale;
+		const bool bUseSmallSteps = PhysicsContext.PhysicsSettings.bUseSmallSteps;
+		for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
 		{
-			// Calculate simulation movement.
-			const FHGMSIMDReal sSimulationVelocityDamping = FHGMMathLibrary::Lerp(HGMSIMDConstants::OneReal, HGMSIMDConstants::ZeroReal, SimulationVelocityDampings[PackedIndex]);
-			sAdjustedSimulationVelocity = sSimulationVelocity * sSimulationVelocityDamping;
+			const FHGMSIMDReal sFriction = HGMSIMDConstants::OneReal - Frictions[PackedIndex];
+			const FHGMSIMDParticleParameter& ParticleParameter = ParticleParameters[PackedIndex];
+			const FHGMSIMDReal& sMovableWeight = ParticleParameter.sMovableWeight;
+			const FHGMSIMDVector3 sPrevPosition = PrevPositions[PackedIndex];
 
-			// Calculate simulation rotation.
-			FHGMSIMDVector3 sLinearizedSimulationAngularVelocity {};
-			sLinearizedSimulationAngularVelocity = FHGMMathLibrary::RotateVector(sSimulationAngularVelocity, PrevPositions[PackedIndex]) - PrevPositions[PackedIndex];
-			const FHGMSIMDReal sSimulationAngularVelocityDamping = FHGMMathLibrary::Lerp(HGMSIMDConstants::OneReal, HGMSIMDConstants::ZeroReal, SimulationAngularVelocityDampings[PackedIndex]);
-			sDampedSimulationAngularVelocity = sLinearizedSimulationAngularVelocity * sSimulationAngularVelocityDamping;
+			const FHGMSIMDVector3 sInertialDisplacement = CalculateBoneInertialDisplacement<bUseSimulationRootBone, bUniformDampings>(ExternalForces, Dampings, sPrevPosition, PackedIndex);
+
+			// Add gravity and velocities.
+			const FHGMSIMDVector3 sPosition = Positions[PackedIndex] + (sGravityDisplacement + sInertialDisplacement * sInertiaScale * sFriction) * sMovableWeight;
+
+			// Verlet integration.
+			const FHGMSIMDVector3 sVelocity = (sPosition - sPrevPosition) * sDeltaTimeChangeFactor;
+			const FHGMSIMDReal sVelocityRetention = CalculateVelocityRetention(PhysicsContext, bUseSmallSteps, Frictions[PackedIndex], GetParameter<bUniformDampings>(Dampings.MasterDampings, PackedIndex), PackedIndex);
+			const FHGMSIMDVector3 sNextPosition = sPosition + sVelocity * (sVelocityRetention * sMovableWeight);
+
+			// Fixed blend.
+			const FHGMSIMDVector3& sAnimPosePosition = AnimPosePositions[PackedIndex];
+			const FHGMSIMDReal& sFixedBlend = ParticleParameter.sFixedBlend;
+			Positions[PackedIndex] = FHGMMathLibrary::Lerp(sNextPosition, sAnimPosePosition, sFixedBlend);
+			PrevPositions[PackedIndex] = FHGMMathLibrary::Lerp(sPosition, sAnimPosePosition, sFixedBlend);
 		}
+	}
+} // End of PhysicsInternal
 
-		// Add gravity.
-		Positions[PackedIndex] += (sGravity * PhysicsContext.sDeltaTime * PhysicsContext.sDeltaTime) * sDeltaTimeChangeFactor * (HGMSIMDConstants::OneReal - DummyBoneMasks[PackedIndex]) * (HGMSIMDConstants::OneReal - FixedBlends[PackedIndex]);
 
-		// Add velocities.
-		Positions[PackedIndex] += (sAdjustedWorldVelocity + sDampedWorldAngularVelocity + sAdjustedSimulationVelocity + sDampedSimulationAngularVelocity) * sDeltaTimeChangeFactor * sFriction * (HGMSIMDConstants::OneReal - DummyBoneMasks[PackedIndex]) * (HGMSIMDConstants::OneReal - FixedBlends[PackedIndex]);
+void FHGMPhysicsLibrary::ApplyForces(FComponentSpacePoseContext& Output, const FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions,
+								const FHGMSIMDBoneParameter& WorldVelocityDampings, const FHGMSIMDBoneParameter& WorldAngularVelocityDampings, const FHGMSIMDBoneParameter& SimulationVelocityDampings, const FHGMSIMDBoneParameter& SimulationAngularVelocityDampings, const FHGMSIMDBoneParameter& MasterDampings,
+								TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PhysicsApplyForces);
+
+	const PhysicsInternal::FExternalForces ExternalForces = PhysicsInternal::CalculateExternalForces(Output, PhysicsContext);
+	const PhysicsInternal::FBoneDampings Dampings { WorldVelocityDampings, WorldAngularVelocityDampings, SimulationVelocityDampings, SimulationAngularVelocityDampings, MasterDampings };
+	if (PhysicsContext.PhysicsSettings.bUseSimulationRootBone)
+	{
+		if (Dampings.IsUniform())
+		{
+			PhysicsInternal::AddForces<true, true>(PhysicsContext, ExternalForces, Positions, PrevPositions, Dampings, Frictions, ParticleParameters);
+		}
+		else
+		{
+			PhysicsInternal::AddForces<true, false>(PhysicsContext, ExternalForces, Positions, PrevPositions, Dampings, Frictions, ParticleParameters);
+		}
+	}
+	else
+	{
+		if (Dampings.IsUniform())
+		{
+			PhysicsInternal::AddForces<false, true>(PhysicsContext, ExternalForces, Positions, PrevPositions, Dampings, Frictions, ParticleParameters);
+		}
+		else
+		{
+			PhysicsInternal::AddForces<false, false>(PhysicsContext, ExternalForces, Positions, PrevPositions, Dampings, Frictions, ParticleParameters);
+		}
+	}
+}
+
+
+void FHGMPhysicsLibrary::IntegrateForces(FComponentSpacePoseContext& Output, const FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, TConstArrayView<FHGMSIMDVector3> AnimPosePositions,
+									const FHGMSIMDBoneParameter& WorldVelocityDampings, const FHGMSIMDBoneParameter& WorldAngularVelocityDampings, const FHGMSIMDBoneParameter& SimulationVelocityDampings, const FHGMSIMDBoneParameter& SimulationAngularVelocityDampings, const FHGMSIMDBoneParameter& MasterDampings,
+									TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PhysicsIntegrateForces);
+
+	const PhysicsInternal::FExternalForces ExternalForces = PhysicsInternal::CalculateExternalForces(Output, PhysicsContext);
+	const PhysicsInternal::FBoneDampings Dampings { WorldVelocityDampings, WorldAngularVelocityDampings, SimulationVelocityDampings, SimulationAngularVelocityDampings, MasterDampings };
+	if (PhysicsContext.PhysicsSettings.bUseSimulationRootBone)
+	{
+		if (Dampings.IsUniform())
+		{
+			PhysicsInternal::AddForcesAndIntegrate<true, true>(PhysicsContext, ExternalForces, Positions, PrevPositions, AnimPosePositions, Dampings, Frictions, ParticleParameters);
+		}
+		else
+		{
+			PhysicsInternal::AddForcesAndIntegrate<true, false>(PhysicsContext, ExternalForces, Positions, PrevPositions, AnimPosePositions, Dampings, Frictions, ParticleParameters);
+		}
+	}
+	else
+	{
+		if (Dampings.IsUniform())
+		{
+			PhysicsInternal::AddForcesAndIntegrate<false, true>(PhysicsContext, ExternalForces, Positions, PrevPositions, AnimPosePositions, Dampings, Frictions, ParticleParameters);
+		}
+		else
+		{
+			PhysicsInternal::AddForcesAndIntegrate<false, false>(PhysicsContext, ExternalForces, Positions, PrevPositions, AnimPosePositions, Dampings, Frictions, ParticleParameters);
+		}
 	}
 }
 
 
-void FHGMPhysicsLibrary::VerletIntegrate(const FHGMPhysicsContext& PhysicsContext, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDVector3>& PrevPositions, TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDReal> MasterDampings, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks)
+void FHGMPhysicsLibrary::VerletIntegrate(const FHGMPhysicsContext& PhysicsContext, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDVector3>& PrevPositions, TConstArrayView<FHGMSIMDReal> Frictions, const FHGMSIMDBoneParameter& MasterDampings, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters)
 {
 	SCOPE_CYCLE_COUNTER(STAT_PhysicsVerletIntegrate);
 
 	// sDeltaTimeChangeFactor was adopted from 「 https://en.wikipedia.org/wiki/Verlet_integration > Non-constant time differences 」.
 	const FHGMSIMDReal sDeltaTimeChangeFactor = PhysicsContext.sDeltaTime / PhysicsContext.sPrevDeltaTime;
+	const bool bUseSmallSteps = PhysicsContext.PhysicsSettings.bUseSmallSteps;
 	for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
 	{
-		const FHGMSIMDReal sFriction = HGMSIMDConstants::OneReal - Frictions[PackedIndex];
-		const FHGMSIMDReal sMasterDamping = (HGMSIMDConstants::OneReal - MasterDampings[PackedIndex]);
+		const FHGMSIMDReal sVelocityRetention = PhysicsInternal::CalculateVelocityRetention(PhysicsContext, bUseSmallSteps, Frictions[PackedIndex], MasterDampings[PackedIndex], PackedIndex);
 
 		const FHGMSIMDVector3 sCopiedPosition = Positions[PackedIndex];
 		const FHGMSIMDVector3 sVelocity = (sCopiedPosition - PrevPositions[PackedIndex]) * sDeltaTimeChangeFactor;
-		const FHGMSIMDVector3 sNextPosition = sCopiedPosition + (sVelocity * sFriction * sMasterDamping) * (HGMSIMDConstants::OneReal - FixedBlends[PackedIndex]) * (HGMSIMDConstants::OneReal - DummyBoneMasks[PackedIndex]);
+		const FHGMSIMDVector3 sNextPosition = sCopiedPosition + (sVelocity * sVelocityRetention) * ParticleParameters[PackedIndex].sMovableWeight;
 
 		Positions[PackedIndex] = sNextPosition;
 		PrevPositions[PackedIndex] = sCopiedPosition;
@@ -142,16 +321,17 @@ void FHGMPhysicsLibrary::ResetFriction(TArray<FHGMSIMDReal>& Frictions)
 }
 
 
-void FHGMPhysicsLibrary::CalculateFriction(TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDColliderContact> ColliderContacts, TArray<FHGMSIMDReal>& OutFrictions)
+void FHGMPhysicsLibrary::CalculateFriction(const FHGMSIMDBoneParameter& Frictions, TConstArrayView<FHGMSIMDColliderContact> ColliderContacts, TArray<FHGMSIMDReal>& OutFrictions)
 {
-	if (OutFrictions.Num() != Frictions.Num())
+	if (!Frictions.bIsUniform && OutFrictions.Num() != Frictions.Values.Num())
 	{
 		HGM_LOG(Error, TEXT("Friction is not working. There is error in calculation of number of elements in friction array."));
 		return;
 	}
 
+	// Same bone may have several contacts, so components without hit keep friction of previous contacts.
 	for (const FHGMSIMDColliderContact& ColliderContact : ColliderContacts)
 	{
-		OutFrictions[ColliderContact.PackedIndex] = FHGMSIMDLibrary::Select(ColliderContact.sHitMask, Frictions[ColliderContact.PackedIndex], HGMSIMDConstants::ZeroReal);
+		OutFrictions[ColliderContact.PackedIndex] = FHGMSIMDLibrary::Select(ColliderContact.sHitMask, Frictions[ColliderContact.PackedIndex], OutFrictions[ColliderContact.PackedIndex]);
 	}
 }
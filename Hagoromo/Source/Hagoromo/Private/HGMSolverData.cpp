@@ -0,0 +1,121 @@
+// Hagoromo : Copyright (c) 2025 nozoxa_0131, MIT License
+
+#include "HGMSolverData.h"
+#include "HagoromoModule.h"
+#include "HGMAnimation.h"
+
+#include "Engine/SkeletalMesh.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_EDITOR
+#include "Animation/AnimCurveFilter.h"
+#endif
+
+
+namespace SolverDataInternal
+{
+	// Increase when layout of FHGMSolverTemplate changes.
+	static constexpr int32 SolverTemplateVersion = 6;
+}
+
+
+void UHagoromoSolverData::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Template is written as single blob with header, so that data of incompatible version is skipped as whole.
+	// Template is built only when cooking, so asset saved in editor has empty blob and is built at runtime there.
+	TArray<uint8> SolverTemplateBlob {};
+	if (Ar.IsSaving() && Ar.IsCooking() && SolverTemplate.IsValid())
+	{
+		FMemoryWriter Writer(SolverTemplateBlob);
+		Writer.SetByteSwapping(Ar.IsByteSwapping());
+
+		int32 Version = SolverDataInternal::SolverTemplateVersion;
+		uint64 RefSkeletonHash = SolverTemplate->RefSkeletonHash;
+		Writer << Version;
+		Writer << RefSkeletonHash;
+
+		SolverTemplate->Serialize(Writer);
+	}
+
+	Ar << SolverTemplateBlob;
+
+	if (Ar.IsLoading())
+	{
+		SolverTemplate.Reset();
+
+		if (SolverTemplateBlob.IsEmpty())
+		{
+			return;
+		}
+
+		FMemoryReader Reader(SolverTemplateBlob);
+		Reader.SetByteSwapping(Ar.IsByteSwapping());
+
+		int32 Version = 0;
+		uint64 RefSkeletonHash = 0;
+		Reader << Version;
+
+		if (Version != SolverDataInternal::SolverTemplateVersion)
+		{
+			HGM_LOG(Warning, TEXT("Solver data %s was built with different version. Solver is built at runtime."), *GetPathName());
+			return;
+		}
+
+		Reader << RefSkeletonHash;
+
+		SolverTemplate = MakeShared<FHGMSolverTemplate>();
+		SolverTemplate->Serialize(Reader);
+		SolverTemplate->RefSkeletonHash = RefSkeletonHash;
+	}
+}
+
+
+#if WITH_EDITOR
+void UHagoromoSolverData::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	if (SaveContext.IsCooking())
+	{
+		BuildSolverTemplate();
+	}
+}
+
+
+bool UHagoromoSolverData::BuildSolverTemplate()
+{
+	SolverTemplate.Reset();
+
+	if (!SkeletalMesh)
+	{
+		return false;
+	}
+
+	const FReferenceSkeleton& RefSkeleton = SkeletalMesh->GetRefSkeleton();
+	TArray<FBoneIndexType> RequiredBoneIndices {};
+	RequiredBoneIndices.Reserve(RefSkeleton.GetNum());
+	for (int32 BoneIndex = 0; BoneIndex < RefSkeleton.GetNum(); ++BoneIndex)
+	{
+		RequiredBoneIndices.Emplace(StaticCast<FBoneIndexType>(BoneIndex));
+	}
+
+	const FBoneContainer RequiredBones(RequiredBoneIndices, UE::Anim::FCurveFilterSettings(), *SkeletalMesh);
+
+	const TSharedPtr<const FHGMReferenceSkeletonCache> RefSkeletonCache = FHGMAnimationLibrary::FindOrCreateReferenceSkeletonCache(RequiredBones);
+	FHGMGatheredChains GatheredChains {};
+	TSharedPtr<FHGMSolverTemplate> NewTemplate = MakeShared<FHGMSolverTemplate>();
+	if (!FHGMSolverTemplate::GatherChains(RequiredBones, *RefSkeletonCache, ChainSettings, GatheredChains) || !NewTemplate->Initialize(GatheredChains, RefSkeletonCache, ChainSettings, PhysicsSettings))
+	{
+		HGM_LOG(Error, TEXT("Failed to build solver data %s ."), *GetPathName());
+		return false;
+	}
+
+	NewTemplate->Key = FHGMSolverTemplate::MakeKey(RequiredBones, ChainSettings, PhysicsSettings);
+	SolverTemplate = MoveTemp(NewTemplate);
+
+	return true;
+}
+#endif
@@ -5,34 +5,452 @@
 #include "HGMAnimation.h"
 #include "HGMPhysics.h"
 
+#include "Async/Future.h"
 #include "Engine/Engine.h"
+#include "Hash/CityHash.h"
+#include <atomic>
+#include <type_traits>
 
 
 // Specify an internal linkage as unnamed space may not work depending on unity build.
 namespace SolverInternal
 {
-	// Referring FReferenceSkeleton::GetDirectChildBones().
-	static int32 GatherDirectChildBoneIndexes(const FReferenceSkeleton& RefSkeleton, int32 ParentBoneIndex, TArray<int32>& ChildBones)
+	// Compare "stat Hagoromo" of Physics IntegrateForces with sum of Physics ApplyForces and Physics VerletIntegrate.
+	static TAutoConsoleVariable<int32> CVarFusedIntegration(TEXT("p.Hagoromo.FusedIntegration"), 1, TEXT("Add forces, integrate and blend fixed bones in single pass. 0 uses separate passes.\n"));
+
+	// Compare memory of instances using same settings.
+	static TAutoConsoleVariable<int32> CVarShareSolverTemplate(TEXT("p.Hagoromo.ShareSolverTemplate"), 1, TEXT("Share immutable solver data between instances of same skeleton and settings. 0 builds it per instance.\n"));
+
+	// Templates are weakly referenced so that they are released together with last instance using them.
+	// BuildingTemplate is valid while template is built outside lock, and other instances of same key wait for it.
+	struct FSolverTemplateEntry
+	{
+		TWeakPtr<const FHGMSolverTemplate> Template {};
+		TSharedFuture<TSharedPtr<const FHGMSolverTemplate>> BuildingTemplate {};
+	};
+
+	static FCriticalSection SolverTemplatesCriticalSection {};
+	static TMap<uint64, FSolverTemplateEntry> SolverTemplates {};
+
+
+	template<typename T>
+	FORCEINLINE static uint64 HashValue(const T& Value, uint64 Hash)
+	{
+		static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "Only types without padding are hashed as memory.");
+		return CityHash64WithSeed(reinterpret_cast<const char*>(&Value), sizeof(T), Hash);
+	}
+
+
+	// Name is hashed as string, since index of FName differs per session.
+	static uint64 HashName(const FName& Name, uint64 Hash)
+	{
+		TStringBuilder<FName::StringBufferSize> NameString {};
+		Name.AppendString(NameString);
+		return CityHash64WithSeed(reinterpret_cast<const char*>(NameString.ToString()), NameString.Len() * sizeof(TCHAR), Hash);
+	}
+
+
+	// Keys are hashed member by member, since FRichCurveKey has padding.
+	static uint64 HashParameter(double Parameter, const FRuntimeFloatCurve& Curve, uint64 Hash)
+	{
+		Hash = HashValue(Parameter, Hash);
+
+		const FRichCurve* RichCurve = Curve.GetRichCurveConst();
+		Hash = HashValue(RichCurve->PreInfinityExtrap.GetValue(), Hash);
+		Hash = HashValue(RichCurve->PostInfinityExtrap.GetValue(), Hash);
+
+		const TArray<FRichCurveKey>& Keys = RichCurve->GetConstRefOfKeys();
+		Hash = HashValue(Keys.Num(), Hash);
+		for (const FRichCurveKey& Key : Keys)
+		{
+			Hash = HashValue(Key.InterpMode.GetValue(), Hash);
+			Hash = HashValue(Key.TangentMode.GetValue(), Hash);
+			Hash = HashValue(Key.TangentWeightMode.GetValue(), Hash);
+			Hash = HashValue(Key.Time, Hash);
+			Hash = HashValue(Key.Value, Hash);
+			Hash = HashValue(Key.ArriveTangent, Hash);
+			Hash = HashValue(Key.ArriveTangentWeight, Hash);
+			Hash = HashValue(Key.LeaveTangent, Hash);
+			Hash = HashValue(Key.LeaveTangentWeight, Hash);
+		}
+
+		return Hash;
+	}
+
+
+	// Per-bone parameters of chain are read only when chain overrides them.
+	static uint64 HashTemplateSettings(const FHGMChainSetting& ChainSetting, uint64 Hash)
+	{
+		Hash = HashName(ChainSetting.RootBone.BoneName, Hash);
+		Hash = HashValue(ChainSetting.ExcludeBones.Num(), Hash);
+		for (const FBoneReference& ExcludeBone : ChainSetting.ExcludeBones)
+		{
+			Hash = HashName(ExcludeBone.BoneName, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bBeginBonePositionFixed, Hash);
+		Hash = HashValue(ChainSetting.AnimPoseConstraintPlanarAxis.GetValue(), Hash);
+
+		Hash = HashValue(ChainSetting.bOverrideRelativeLimitAngleEachBone, Hash);
+		if (ChainSetting.bOverrideRelativeLimitAngleEachBone)
+		{
+			Hash = HashParameter(ChainSetting.RelativeLimitAngleConstraintSettings.Angle, ChainSetting.RelativeLimitAngleConstraintSettings.MultiplierCurve, Hash);
+			Hash = HashParameter(ChainSetting.RelativeLimitAngleConstraintSettings.Damping, ChainSetting.RelativeLimitAngleConstraintSettings.DampingMultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideAnimPoseConstraintMovableRadiusEachBone, Hash);
+		if (ChainSetting.bOverrideAnimPoseConstraintMovableRadiusEachBone)
+		{
+			Hash = HashParameter(ChainSetting.AnimPoseConstraintMovableRadiusSettings.Radius, ChainSetting.AnimPoseConstraintMovableRadiusSettings.MultiplierCurve, Hash);
+			Hash = HashParameter(ChainSetting.AnimPoseConstraintMovableRadiusSettings.Damping, ChainSetting.AnimPoseConstraintMovableRadiusSettings.DampingMultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideAnimPoseConstraintLimitAngleEachBone, Hash);
+		if (ChainSetting.bOverrideAnimPoseConstraintLimitAngleEachBone)
+		{
+			Hash = HashParameter(ChainSetting.AnimPoseConstraintLimitAngleSettings.Angle, ChainSetting.AnimPoseConstraintLimitAngleSettings.MultiplierCurve, Hash);
+			Hash = HashParameter(ChainSetting.AnimPoseConstraintLimitAngleSettings.Damping, ChainSetting.AnimPoseConstraintLimitAngleSettings.DampingMultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideBoneSphereColliderRadiusEachBone, Hash);
+		if (ChainSetting.bOverrideBoneSphereColliderRadiusEachBone)
+		{
+			Hash = HashParameter(ChainSetting.BoneSphereColliderSettings.Radius, ChainSetting.BoneSphereColliderSettings.MultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideFrictionEachBone, Hash);
+		if (ChainSetting.bOverrideFrictionEachBone)
+		{
+			Hash = HashParameter(ChainSetting.FrictionSettings.Friction, ChainSetting.FrictionSettings.MultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideWorldVelocityDampingEachBone, Hash);
+		if (ChainSetting.bOverrideWorldVelocityDampingEachBone)
+		{
+			Hash = HashParameter(ChainSetting.WorldVelocityDampingSettings.Damping, ChainSetting.WorldVelocityDampingSettings.MultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideWorldAngularVelocityDampingEachBone, Hash);
+		if (ChainSetting.bOverrideWorldAngularVelocityDampingEachBone)
+		{
+			Hash = HashParameter(ChainSetting.WorldAngularVelocityDampingSettings.Damping, ChainSetting.WorldAngularVelocityDampingSettings.MultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideSimulationVelocityDampingEachBone, Hash);
+		if (ChainSetting.bOverrideSimulationVelocityDampingEachBone)
+		{
+			Hash = HashParameter(ChainSetting.SimulationVelocityDampingSettings.Damping, ChainSetting.SimulationVelocityDampingSettings.MultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideSimulationAngularVelocityDampingEachBone, Hash);
+		if (ChainSetting.bOverrideSimulationAngularVelocityDampingEachBone)
+		{
+			Hash = HashParameter(ChainSetting.SimulationAngularVelocityDampingSettings.Damping, ChainSetting.SimulationAngularVelocityDampingSettings.MultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideMasterDampingEachBone, Hash);
+		if (ChainSetting.bOverrideMasterDampingEachBone)
+		{
+			Hash = HashParameter(ChainSetting.MasterDampingSettings.MasterDamping, ChainSetting.MasterDampingSettings.MultiplierCurve, Hash);
+		}
+
+		Hash = HashValue(ChainSetting.bOverrideMassEachBone, Hash);
+		if (ChainSetting.bOverrideMassEachBone)
+		{
+			Hash = HashParameter(ChainSetting.MassSettings.Mass, ChainSetting.MassSettings.MultiplierCurve, Hash);
+		}
+
+		return Hash;
+	}
+
+
+	// Stiffnesses of structures, solver iterations, time step and other settings used only at runtime are not hashed, so that they do not split templates.
+	// Note: Update this together with FHGMSolverTemplate::Initialize() when it reads another setting.
+	static uint64 HashTemplateSettings(const FHGMPhysicsSettings& PhysicsSettings, uint64 Hash)
 	{
-		ChildBones.Reset();
+		Hash = HashValue(PhysicsSettings.bUseHorizontalStructuralConstraint, Hash);
+		Hash = HashValue(PhysicsSettings.bLoopHorizontalStructure, Hash);
+		Hash = HashValue(PhysicsSettings.bUseVerticalBendConstraint, Hash);
+		Hash = HashValue(PhysicsSettings.bUseHorizontalBendConstraint, Hash);
+		Hash = HashValue(PhysicsSettings.bUseShearConstraint, Hash);
+		Hash = HashValue(PhysicsSettings.bUseTetherConstraint, Hash);
+		Hash = HashValue(PhysicsSettings.bUseRelativeLimitAngleConstraint, Hash);
+		Hash = HashValue(PhysicsSettings.bUseAnimPoseConstraint, Hash);
+		Hash = HashValue(PhysicsSettings.bUseAnimPoseConstraintMovableRadius, Hash);
+		Hash = HashValue(PhysicsSettings.bUseAnimPoseConstraintLimitAngle, Hash);
+		Hash = HashValue(PhysicsSettings.bUseAnimPoseConstraintPlanar, Hash);
+
+		Hash = HashParameter(PhysicsSettings.TetherConstraintSettings.Stiffness, PhysicsSettings.TetherConstraintSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.RelativeLimitAngleConstraintSettings.Angle, PhysicsSettings.RelativeLimitAngleConstraintSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.RelativeLimitAngleConstraintSettings.Damping, PhysicsSettings.RelativeLimitAngleConstraintSettings.DampingMultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.AnimPoseConstraintMovableRadiusSettings.Radius, PhysicsSettings.AnimPoseConstraintMovableRadiusSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.AnimPoseConstraintMovableRadiusSettings.Damping, PhysicsSettings.AnimPoseConstraintMovableRadiusSettings.DampingMultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.AnimPoseConstraintLimitAngleSettings.Angle, PhysicsSettings.AnimPoseConstraintLimitAngleSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.AnimPoseConstraintLimitAngleSettings.Damping, PhysicsSettings.AnimPoseConstraintLimitAngleSettings.DampingMultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.BoneSphereColliderSettings.Radius, PhysicsSettings.BoneSphereColliderSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.FrictionSettings.Friction, PhysicsSettings.FrictionSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.WorldVelocityDampingSettings.Damping, PhysicsSettings.WorldVelocityDampingSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.WorldAngularVelocityDampingSettings.Damping, PhysicsSettings.WorldAngularVelocityDampingSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.SimulationVelocityDampingSettings.Damping, PhysicsSettings.SimulationVelocityDampingSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.SimulationAngularVelocityDampingSettings.Damping, PhysicsSettings.SimulationAngularVelocityDampingSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.MasterDampingSettings.MasterDamping, PhysicsSettings.MasterDampingSettings.MultiplierCurve, Hash);
+		Hash = HashParameter(PhysicsSettings.MassSettings.Mass, PhysicsSettings.MassSettings.MultiplierCurve, Hash);
+
+		return Hash;
+	}
+
 
-		const int32 BoneMaxNum = RefSkeleton.GetNum();
-		for (int32 ChildBoneIndex = ParentBoneIndex + 1; ChildBoneIndex < BoneMaxNum; ChildBoneIndex++)
+	// Zero clear lambdas, or scale them to carry over to this step when Warm Start is enabled.
+	template<typename T>
+	static void InitializeLambda(TArrayView<T> StructureDataArray, bool bUseWarmStart, const FHGMSIMDReal& sWarmStartScale)
+	{
+		if (bUseWarmStart)
+		{
+			FHGMConstraintLibrary::ScaleLambda<T>(StructureDataArray, sWarmStartScale);
+		}
+		else
 		{
-			if (ParentBoneIndex == RefSkeleton.GetParentIndex(ChildBoneIndex))
+			FHGMConstraintLibrary::ResetLambda<T>(StructureDataArray);
+		}
+	}
+
+
+	// Registers are written component by component as double and int32, so data does not depend on precision, padding or byte order of build.
+	static void SerializeElement(FArchive& Ar, FHGMSIMDReal& sValue)
+	{
+		TStaticArray<FHGMReal, 4> Values {};
+		if (Ar.IsSaving())
+		{
+			FHGMSIMDLibrary::Store(sValue, Values);
+		}
+
+		for (FHGMReal& Value : Values)
+		{
+			double SerializedValue = Value;
+			Ar << SerializedValue;
+			Value = StaticCast<FHGMReal>(SerializedValue);
+		}
+
+		if (Ar.IsLoading())
+		{
+			FHGMSIMDLibrary::Load(sValue, Values);
+		}
+	}
+
+
+	static void SerializeElement(FArchive& Ar, FHGMSIMDInt& sValue)
+	{
+		TStaticArray<int32, 4> Values {};
+		if (Ar.IsSaving())
+		{
+			FHGMSIMDLibrary::Store(sValue, Values);
+		}
+
+		for (int32& Value : Values)
+		{
+			Ar << Value;
+		}
+
+		if (Ar.IsLoading())
+		{
+			FHGMSIMDLibrary::Load(sValue, Values);
+		}
+	}
+
+
+	// Bit pattern of mask is not value, so only bit of each component is written.
+	static void SerializeMask(FArchive& Ar, FHGMSIMDReal& sMask)
+	{
+		int32 MaskBits = Ar.IsSaving() ? VectorMaskBits(sMask) : 0;
+		Ar << MaskBits;
+
+		if (Ar.IsLoading())
+		{
+			FHGMSIMDLibrary::Load(sMask, (MaskBits & 1) ? 1.0 : 0.0, (MaskBits & 2) ? 1.0 : 0.0, (MaskBits & 4) ? 1.0 : 0.0, (MaskBits & 8) ? 1.0 : 0.0);
+			sMask = sMask > HGMSIMDConstants::ZeroReal;
+		}
+	}
+
+
+	static void SerializeElement(FArchive& Ar, FHGMSIMDVector3& sValue)
+	{
+		SerializeElement(Ar, sValue.X);
+		SerializeElement(Ar, sValue.Y);
+		SerializeElement(Ar, sValue.Z);
+	}
+
+
+	// Movable weight is derived from other parameters, so it is recomputed on load.
+	static void SerializeElement(FArchive& Ar, FHGMSIMDParticleParameter& ParticleParameter)
+	{
+		SerializeElement(Ar, ParticleParameter.sInverseMass);
+		SerializeElement(Ar, ParticleParameter.sFixedBlend);
+		SerializeElement(Ar, ParticleParameter.sDummyBoneMask);
+
+		if (Ar.IsLoading())
+		{
+			ParticleParameter.sMovableWeight = (HGMSIMDConstants::OneReal - ParticleParameter.sFixedBlend) * (HGMSIMDConstants::OneReal - ParticleParameter.sDummyBoneMask);
+		}
+	}
+
+
+	// Lambdas are state of solver instance, so they are not written.
+	static void SerializeElement(FArchive& Ar, FHGMSIMDStructure& Structure)
+	{
+		Ar << Structure.FirstBonePackedIndex;
+		Ar << Structure.SecondBonePackedIndex;
+		SerializeElement(Ar, Structure.sFirstBoneUnpackedIndex);
+		SerializeElement(Ar, Structure.sSecondBoneUnpackedIndex);
+		SerializeElement(Ar, Structure.sLength);
+	}
+
+
+	static void SerializeElement(FArchive& Ar, FHGMSIMDShearStructure& Shear)
+	{
+		Ar << Shear.FirstBonePackedIndex;
+		Ar << Shear.FirstBoneNextPackedIndex;
+		Ar << Shear.SecondBonePackedIndex;
+		Ar << Shear.SecondBoneNextPackedIndex;
+		SerializeMask(Ar, Shear.sActiveMask);
+		SerializeElement(Ar, Shear.sFirstBoneUnpackedIndex);
+		SerializeElement(Ar, Shear.sSecondBoneUnpackedIndex);
+		SerializeElement(Ar, Shear.sLength);
+	}
+
+
+	static void SerializeElement(FArchive& Ar, FHGMSIMDTether& Tether)
+	{
+		Ar << Tether.RootBonePackedIndex;
+		Ar << Tether.BonePackedIndex;
+		SerializeElement(Ar, Tether.sLength);
+		SerializeElement(Ar, Tether.sCompliance);
+	}
+
+
+	static void SerializeElement(FArchive& Ar, FHGMSIMDRelativeLimitAngle& LimitAngle)
+	{
+		SerializeElement(Ar, LimitAngle.sAngle);
+		SerializeElement(Ar, LimitAngle.sDamping);
+	}
+
+
+	static void SerializeElement(FArchive& Ar, FHGMSIMDAnimPoseConstraintMovableRadius& MovableRadius)
+	{
+		SerializeElement(Ar, MovableRadius.sRadius);
+		SerializeElement(Ar, MovableRadius.sDamping);
+	}
+
+
+	static void SerializeElement(FArchive& Ar, FHGMSIMDAnimPoseConstraintLimitAngle& LimitAngle)
+	{
+		SerializeElement(Ar, LimitAngle.sAngle);
+		SerializeElement(Ar, LimitAngle.sDamping);
+	}
+
+
+	static void SerializeElement(FArchive& Ar, FHGMSimulationPlane& SimulationPlane)
+	{
+		Ar << SimulationPlane.UnpackedVerticalBoneNum;
+		Ar << SimulationPlane.PackedVerticalBoneNum;
+		Ar << SimulationPlane.UnpackedHorizontalBoneNum;
+		Ar << SimulationPlane.PackedHorizontalBoneNum;
+		Ar << SimulationPlane.ActualUnpackedHorizontalBoneNum;
+	}
+
+
+	template<typename T>
+	static void SerializeArray(FArchive& Ar, TArray<T>& Values)
+	{
+		int32 Num = Values.Num();
+		Ar << Num;
+
+		if (Ar.IsLoading())
+		{
+			Values.Reset(Num);
+			Values.SetNum(Num);
+		}
+
+		for (T& Value : Values)
+		{
+			SerializeElement(Ar, Value);
+		}
+	}
+
+
+	static void SerializeBoneParameter(FArchive& Ar, FHGMSIMDBoneParameter& Parameter)
+	{
+		SerializeArray(Ar, Parameter.Values);
+		Ar << Parameter.bIsUniform;
+	}
+
+	// Keeps only single register when all bones except dummy bones have same value.
+	// Dummy bones are excluded since they do not move, so value shared with other bones is harmless for them.
+	static void CompressUniformParameter(TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, FHGMSIMDBoneParameter& Parameter)
+	{
+		Parameter.bIsUniform = false;
+
+		bool bHasValue = false;
+		FHGMReal UniformValue = 0.0;
+		for (int32 PackedIndex = 0; PackedIndex < Parameter.Values.Num(); ++PackedIndex)
+		{
+			TStaticArray<FHGMReal, 4> UnpackedValues {};
+			TStaticArray<FHGMReal, 4> UnpackedDummyBoneMasks {};
+			FHGMSIMDLibrary::Store(Parameter.Values[PackedIndex], UnpackedValues);
+			FHGMSIMDLibrary::Store(ParticleParameters[PackedIndex].sDummyBoneMask, UnpackedDummyBoneMasks);
+
+			for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
 			{
-				ChildBones.Add(ChildBoneIndex);
+				if (UnpackedDummyBoneMasks[ComponentIndex] > 0.0)
+				{
+					continue;
+				}
+
+				if (!bHasValue)
+				{
+					UniformValue = UnpackedValues[ComponentIndex];
+					bHasValue = true;
+				}
+				else if (UnpackedValues[ComponentIndex] != UniformValue)
+				{
+					return;
+				}
 			}
 		}
 
-		return ChildBones.Num();
+		if (!bHasValue)
+		{
+			return;
+		}
+
+		FHGMSIMDReal sUniformValue {};
+		FHGMSIMDLibrary::Load(sUniformValue, UniformValue);
+
+		Parameter.Values.Reset(1);
+		Parameter.Values.Emplace(sUniformValue);
+		Parameter.Values.Shrink();
+		Parameter.bIsUniform = true;
+	}
+
+
+	// Copies particle parameters with bones of RemovedBoneMasks turned into dummy bones that do not move by themselves.
+	static void MaskRemovedBones(TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, TConstArrayView<FHGMSIMDReal> RemovedBoneMasks, TArray<FHGMSIMDParticleParameter>& OutParticleParameters)
+	{
+		OutParticleParameters.Reset(ParticleParameters.Num());
+		OutParticleParameters.Append(ParticleParameters.GetData(), ParticleParameters.Num());
+		for (int32 PackedIndex = 0; PackedIndex < OutParticleParameters.Num(); ++PackedIndex)
+		{
+			FHGMSIMDParticleParameter& ParticleParameter = OutParticleParameters[PackedIndex];
+			const FHGMSIMDReal& sRemovedBoneMask = RemovedBoneMasks[PackedIndex];
+			ParticleParameter.sDummyBoneMask = FHGMMathLibrary::Max(ParticleParameter.sDummyBoneMask, sRemovedBoneMask);
+			ParticleParameter.sMovableWeight *= HGMSIMDConstants::OneReal - sRemovedBoneMask;
+		}
 	}
 
 
-	static bool GatherChain(const FBoneContainer& BoneContainer, const FReferenceSkeleton& RefSkeleton, TConstArrayView<FBoneReference> ExcludeBones, int32 BoneIndex,
+	static bool GatherChain(const FBoneContainer& BoneContainer, const FReferenceSkeleton& RefSkeleton, const FHGMReferenceSkeletonCache& RefSkeletonCache, TConstArrayView<FBoneReference> ExcludeBones, int32 BoneIndex,
 							TArray<FBoneReference>& Bones, TArray<FHGMVector3>& BonePositions)
 	{
-		if (BoneIndex < 0 || RefSkeleton.GetNum() < BoneIndex)
+		if (BoneIndex < 0 || RefSkeleton.GetNum() <= BoneIndex)
 		{
 			return false;
 		}
@@ -47,21 +465,20 @@ namespace SolverInternal
 			return true;
 		}
 
-		if (Bone.CachedCompactPoseIndex == INDEX_NONE)
+		// Bones are looked up in mesh rather than in required bones of current LOD, so that template covers all LODs.
+		if (Bone.BoneIndex == INDEX_NONE)
 		{
 			return false;
 		}
 
 		Bones.Emplace(Bone);
 
-		const FHGMTransform& BoneTransform = FHGMAnimationLibrary::GetComponentSpaceRefTransform(BoneContainer, Bone.CachedCompactPoseIndex);
+		const FHGMTransform& BoneTransform = RefSkeletonCache.ComponentSpaceRefTransforms[BoneIndex];
 		BonePositions.Emplace(BoneTransform.GetTranslation());
 
-		TArray<int32> ChildBoneIndexes {};
-		SolverInternal::GatherDirectChildBoneIndexes(RefSkeleton, BoneIndex, ChildBoneIndexes);
-		for (int32 ChildBoneIndex : ChildBoneIndexes)
+		for (int32 ChildBoneIndex : RefSkeletonCache.GetDirectChildBoneIndexes(BoneIndex))
 		{
-			SolverInternal::GatherChain(BoneContainer, RefSkeleton, ExcludeBones, ChildBoneIndex, Bones, BonePositions);
+			SolverInternal::GatherChain(BoneContainer, RefSkeleton, RefSkeletonCache, ExcludeBones, ChildBoneIndex, Bones, BonePositions);
 		}
 
 		return true;
@@ -141,12 +558,30 @@ namespace SolverInternal
 	}
 
 
+	static FHGMReal GetFixedTimeStep(const FHGMPhysicsSettings& PhysicsSettings)
+	{
+		return 1.0 / FHGMMathLibrary::Max<FHGMReal>(StaticCast<FHGMReal>(PhysicsSettings.FixedTimeStepRate), 1.0);
+	}
+
+
 	static void UpdateDeltaTime(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext)
 	{
 		PhysicsContext.sPrevDeltaTime = PhysicsContext.sDeltaTime;
 		const FHGMReal CurrentDeltaTime = Output.AnimInstanceProxy->GetDeltaSeconds();
 		const FHGMReal FixedDeltaTime = 1.0 / GEngine->FixedFrameRate;
 		const FHGMReal AdjustedDeltaTime = CurrentDeltaTime <= 0.0 ? FixedDeltaTime : CurrentDeltaTime;
+
+		// Substeps always advance by same time, so hitch countermeasures are handled by MaxSubsteps instead.
+		if (PhysicsContext.PhysicsSettings.bUseFixedTimeStep)
+		{
+			const FHGMReal FixedTimeStep = SolverInternal::GetFixedTimeStep(PhysicsContext.PhysicsSettings);
+			PhysicsContext.TimeAccumulator += AdjustedDeltaTime;
+			FHGMSIMDLibrary::Load(PhysicsContext.sDeltaTime, FixedTimeStep);
+			FHGMSIMDLibrary::Load(PhysicsContext.sPrevDeltaTime, FixedTimeStep);
+			FHGMSIMDLibrary::Load(PhysicsContext.sDeltaTimeExponent, HGMGlobal::TargetFrameRate * FixedTimeStep);
+			return;
+		}
+
 		FHGMSIMDLibrary::Load(PhysicsContext.sDeltaTime, AdjustedDeltaTime);
 		FHGMSIMDLibrary::Load(PhysicsContext.sDeltaTimeExponent, HGMGlobal::TargetFrameRate * AdjustedDeltaTime);
 
@@ -206,7 +641,7 @@ namespace SolverInternal
 	}
 
 
-	static void ApplySimulationRootBone(const FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions)
+	static void ApplySimulationRootBone(const FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, TArrayView<FHGMSIMDVector3> SubstepStartPositions)
 	{
 		FHGMSIMDTransform sSimulationForce {};
 		FHGMSIMDLibrary::Load(sSimulationForce, PhysicsContext.PrevSimulationRootBoneTransform.Inverse() * PhysicsContext.SimulationRootBoneTransform);
@@ -221,6 +656,76 @@ namespace SolverInternal
 
 		Apply(Positions);
 		Apply(PrevPositions);
+		Apply(SubstepStartPositions);
+	}
+
+
+	// Moves Positions only by actor and SimulationRootBone movement, without gravity.
+	// Displacement depends on PrevPositions, not Positions, so same offset is applied to any positions given with same PrevPositions.
+	static void ApplyInertia(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMSolverTemplate& Template, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, TConstArrayView<FHGMSIMDReal> Frictions)
+	{
+		const FHGMSIMDReal sCopiedGravityScale = PhysicsContext.sGravityScale;
+		PhysicsContext.sGravityScale = HGMSIMDConstants::ZeroReal;
+		FHGMPhysicsLibrary::ApplyForces(Output, PhysicsContext, Positions, PrevPositions,
+									Template.WorldVelocityDampings, Template.WorldAngularVelocityDampings, Template.SimulationVelocityDampings, Template.SimulationAngularVelocityDampings, Template.MasterDampings,
+									Frictions, ParticleParameters);
+		PhysicsContext.sGravityScale = sCopiedGravityScale;
+	}
+
+
+	// ( 1 - Parameter ) ^ Exponent for each bone. Uniform parameter stays uniform.
+	static void CalculateSmallStepRetentions(const FHGMSIMDBoneParameter& Parameter, const FHGMSIMDReal& sExponent, FHGMSIMDBoneParameter& OutRetentions)
+	{
+		OutRetentions.bIsUniform = Parameter.bIsUniform;
+		OutRetentions.Values.Reset(Parameter.Values.Num());
+		for (const FHGMSIMDReal& sValue : Parameter.Values)
+		{
+			OutRetentions.Values.Emplace(FHGMMathLibrary::Pow(HGMSIMDConstants::OneReal - sValue, sExponent));
+		}
+	}
+
+
+	// Horizontal maximum of all lanes.
+	static FHGMReal ReduceMax(const FHGMSIMDReal& sValue)
+	{
+		TStaticArray<FHGMReal, 4> Values {};
+		FHGMSIMDLibrary::Store(sValue, Values);
+		return FMath::Max(FMath::Max(Values[0], Values[1]), FMath::Max(Values[2], Values[3]));
+	}
+
+
+	// Number of plain Gauss-Seidel iterations before Chebyshev acceleration starts.
+	// Convergence rate of these iterations is used to estimate spectral radius.
+	static constexpr int32 ChebyshevDelayIterationNum = 2;
+
+	// Upper limit of spectral radius to keep omega finite.
+	static constexpr FHGMReal ChebyshevMaxSpectralRadius = 0.95;
+
+	// Chebyshev semi-iterative acceleration. ( https://doi.org/10.1145/2816795.2818063 )
+	// q(k+1) = q(k-1) + Omega * (q^(k+1) - q(k-1))
+	// Returns maximum displacement of this iteration before acceleration.
+	static FHGMReal ChebyshevAccelerate(FHGMReal Omega, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters,
+										TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevIteratedPositions, TArrayView<FHGMSIMDVector3> CurrentIteratedPositions)
+	{
+		FHGMSIMDReal sOmegaMinusOne {};
+		FHGMSIMDLibrary::Load(sOmegaMinusOne, Omega - 1.0);
+
+		FHGMSIMDReal sMaxDisplacement = HGMSIMDConstants::ZeroReal;
+		for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
+		{
+			const FHGMSIMDVector3 sPosition = Positions[PackedIndex];
+			sMaxDisplacement = FHGMMathLibrary::Max(sMaxDisplacement, FHGMMathLibrary::Length(sPosition - CurrentIteratedPositions[PackedIndex]));
+
+			// Fixed bones and dummy bones are not accelerated.
+			const FHGMSIMDReal sWeight = sOmegaMinusOne * ParticleParameters[PackedIndex].sMovableWeight;
+			const FHGMSIMDVector3 sAcceleratedPosition = sPosition + (sPosition - PrevIteratedPositions[PackedIndex]) * sWeight;
+
+			Positions[PackedIndex] = sAcceleratedPosition;
+			PrevIteratedPositions[PackedIndex] = CurrentIteratedPositions[PackedIndex];
+			CurrentIteratedPositions[PackedIndex] = sAcceleratedPosition;
+		}
+
+		return ReduceMax(sMaxDisplacement);
 	}
 
 
@@ -249,30 +754,212 @@ namespace SolverInternal
 	}
 
 
-	static void CopyAnimationPositions(FComponentSpacePoseContext& Output, const TArray<FBoneReference>& Bones, TArray<FHGMSIMDVector3>& AnimationPositions)
+	static void CopyAnimationPositions(FComponentSpacePoseContext& Output, TConstArrayView<FBoneReference> Bones, TConstArrayView<FCompactPoseBoneIndex> CompactPoseBoneIndexes, TConstArrayView<FHGMSIMDVector3> Positions, TArray<FHGMSIMDVector3>& AnimationPositions)
 	{
 		for (int32 UnpackedBoneIndex = 0; UnpackedBoneIndex < Bones.Num(); ++UnpackedBoneIndex)
 		{
-			const FBoneReference& BoneReference = Bones[UnpackedBoneIndex];
-
-			if (!FHGMAnimationLibrary::IsValidBone(BoneReference))
+			if (Bones[UnpackedBoneIndex].BoneIndex == INDEX_NONE)
 			{
 				continue;
 			}
 
-			const FCompactPoseBoneIndex CompactBoneIndex(BoneReference.BoneIndex);
-			const FHGMTransform& AnimPoseTransform = Output.Pose.GetComponentSpaceTransform(CompactBoneIndex);
-
 			const FHGMSIMDIndex SIMDIndex(UnpackedBoneIndex);
-			FHGMSIMDLibrary::Load(AnimationPositions[SIMDIndex.PackedIndex], SIMDIndex.ComponentIndex, AnimPoseTransform.GetTranslation());
+			const FCompactPoseBoneIndex& CompactBoneIndex = CompactPoseBoneIndexes[UnpackedBoneIndex];
+
+			// Bone removed by LOD has no animation pose, so current position is used so as not to be pulled toward stale pose.
+			FHGMVector3 AnimPosePosition {};
+			if (CompactBoneIndex.IsValid())
+			{
+				AnimPosePosition = Output.Pose.GetComponentSpaceTransform(CompactBoneIndex).GetTranslation();
+			}
+			else
+			{
+				FHGMSIMDLibrary::Store(Positions[SIMDIndex.PackedIndex], SIMDIndex.ComponentIndex, AnimPosePosition);
+			}
+
+			FHGMSIMDLibrary::Load(AnimationPositions[SIMDIndex.PackedIndex], SIMDIndex.ComponentIndex, AnimPosePosition);
 		}
 	}
+
+
+	// Whether any bone moved sDistance or more from position at last collision detection.
+	static bool HasMovedSinceContactDetection(TConstArrayView<FHGMSIMDVector3> ContactDetectionPositions, TConstArrayView<FHGMSIMDVector3> Positions, const FHGMSIMDReal& sDistance)
+	{
+		const FHGMSIMDReal sDistanceSquared = sDistance * sDistance;
+		FHGMSIMDReal sMovedMask = ~HGMSIMDConstants::AllBitMask;
+		for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
+		{
+			sMovedMask |= FHGMMathLibrary::LengthSquared(Positions[PackedIndex] - ContactDetectionPositions[PackedIndex]) >= sDistanceSquared;
+		}
+
+		return FHGMSIMDLibrary::IsAnyMaskSet(sMovedMask);
+	}
 }
 
 
 // ---------------------------------------------------------------------------------------
 // DynamicBoneSolver
 // ---------------------------------------------------------------------------------------
+template<EHGMSolverFeature Features>
+FHGMReal FHGMDynamicBoneSolver::SolveConstraintIteration(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders,
+														const FHGMSIMDReal& sCollisionBlend, const FHGMSIMDReal& sColliderPenetrationDepth, bool bIsFirstIteration, bool bUseChebyshevAcceleration, FHGMReal ChebyshevOmega)
+{
+	// Collision detection.
+	// Speculative contacts are detected with margin and their separating planes are reused in following iterations.
+	// Colliders do not move during substep, so pair missing from cache cannot collide until some bone moves by margin.
+	const bool bUseSpeculativeContact = PhysicsContext.PhysicsSettings.bUseSpeculativeContact;
+	FHGMSIMDReal sContactMargin = HGMSIMDConstants::ZeroReal;
+	if (bUseSpeculativeContact)
+	{
+		FHGMSIMDLibrary::Load(sContactMargin, PhysicsContext.PhysicsSettings.SpeculativeContactMargin);
+	}
+
+	bool bShouldDetectContacts = bIsFirstIteration || !bUseSpeculativeContact || SolverInternal::HasMovedSinceContactDetection(ContactDetectionPositions, Positions, sContactMargin);
+	if (!bShouldDetectContacts)
+	{
+		// Side of each cached contact is updated, and contacts are detected again when some bone crossed its plane further than margin.
+		// Note: Bitwise OR so that all caches are updated.
+		bShouldDetectContacts |= FHGMCollisionLibrary::UpdateContactSides(BodyColliderContactCache, Positions, sContactMargin);
+		if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::EdgeCollider))
+		{
+			bShouldDetectContacts |= FHGMCollisionLibrary::UpdateContactSides(VerticalContactCache, Positions, sContactMargin);
+
+			if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::HorizontalEdgeCollider))
+			{
+				bShouldDetectContacts |= FHGMCollisionLibrary::UpdateContactSides(HorizontalContactCache, Positions, sContactMargin);
+			}
+		}
+		bShouldDetectContacts |= FHGMCollisionLibrary::UpdateContactSides(PlaneColliderContactCache, Positions, sContactMargin);
+	}
+
+	if (bShouldDetectContacts)
+	{
+		BodyColliderContactCache.Reset();
+		FHGMCollisionLibrary::CalculateBodyColliderContacts(Template->SimulationPlane, Template->BoneSphereColliderRadiuses, GetParticleParameters(), Positions, PrevPositions, BodyCollider, sContactMargin, BodyColliderContactCache);
+
+		if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::EdgeCollider))
+		{
+			VerticalContactCache.Reset();
+			FHGMCollisionLibrary::CalculateBodyColliderContactsForVerticalEdge(VerticalStructures, Positions, BodyCollider, sContactMargin, VerticalContactCache);
+
+			if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::HorizontalEdgeCollider))
+			{
+				HorizontalContactCache.Reset();
+				FHGMCollisionLibrary::CalculateBodyColliderContactsForHorizontalEdge(Template->SimulationPlane, PhysicsContext.PhysicsSettings.bLoopHorizontalStructure, Positions, BodyCollider, sContactMargin, HorizontalContactCache);
+			}
+		}
+
+		PlaneColliderContactCache.Reset();
+		FHGMCollisionLibrary::CalculatePlaneColliderContacts(PlaneColliders, Template->BoneSphereColliderRadiuses, GetParticleParameters(), Positions, sContactMargin, PlaneColliderContactCache);
+
+		if (bUseSpeculativeContact)
+		{
+			ContactDetectionPositions = Positions;
+
+			FHGMCollisionLibrary::StoreContactSides(BodyColliderContactCache, Positions);
+			FHGMCollisionLibrary::StoreContactSides(VerticalContactCache, Positions);
+			FHGMCollisionLibrary::StoreContactSides(HorizontalContactCache, Positions);
+			FHGMCollisionLibrary::StoreContactSides(PlaneColliderContactCache, Positions);
+		}
+	}
+
+	// Applying Constraints.
+	if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::RigidVerticalStructureConstraint))
+	{
+		FHGMConstraintLibrary::RigidVerticalStructuralConstraint(VerticalStructures, Positions, GetParticleParameters());
+	}
+	else if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::DirectVerticalStructureConstraint))
+	{
+		FHGMConstraintLibrary::DirectVerticalStructuralConstraint(VerticalStructures, PhysicsContext, Template->SimulationPlane, Positions, GetParticleParameters());
+	}
+	else
+	{
+		FHGMConstraintLibrary::VerticalStructuralConstraint(VerticalStructures, PhysicsContext, Positions, GetParticleParameters());
+	}
+
+	if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::TetherConstraint))
+	{
+		FHGMConstraintLibrary::TetherConstraint(Tethers, PhysicsContext, Positions, GetParticleParameters());
+	}
+
+	if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::HorizontalStructuralConstraint))
+	{
+		FHGMConstraintLibrary::HorizontalStructuralConstraint(HorizontalStructures, PhysicsContext, Template->SimulationPlane, Positions, HorizontalPositions, GetHorizontalParticleParameters());
+	}
+
+	if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::VerticalBendConstraint))
+	{
+		FHGMConstraintLibrary::VerticalBendConstraint(VerticalBendStructures, PhysicsContext, Positions, GetParticleParameters());
+	}
+
+	if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::HorizontalBendConstraint))
+	{
+		FHGMConstraintLibrary::HorizontalBendConstraint(HorizontalBendStructures, PhysicsContext, Template->SimulationPlane, Positions, HorizontalPositions, GetHorizontalParticleParameters());
+	}
+
+	if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::ShearConstraint))
+	{
+		FHGMConstraintLibrary::ShearConstraint(ShearStructures, PhysicsContext, Positions, GetParticleParameters());
+	}
+
+	// Chebyshev acceleration.
+	// Extrapolation is done before contacts, so that it does not push bones back into colliders.
+	FHGMReal ChebyshevMaxDisplacement = 0.0;
+	if (bUseChebyshevAcceleration)
+	{
+		ChebyshevMaxDisplacement = SolverInternal::ChebyshevAccelerate(ChebyshevOmega, GetParticleParameters(), Positions, ChebyshevPrevIteratedPositions, ChebyshevCurrentIteratedPositions);
+	}
+
+	// Solve contacts.
+	FHGMConstraintLibrary::ColliderContactConstraint(BodyColliderContactCache, sCollisionBlend, sColliderPenetrationDepth, Positions, GetParticleParameters());
+
+	if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::EdgeCollider))
+	{
+		FHGMConstraintLibrary::ColliderContactConstraint(VerticalContactCache, sCollisionBlend, sColliderPenetrationDepth, Positions, GetParticleParameters());
+
+		if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::HorizontalEdgeCollider))
+		{
+			FHGMConstraintLibrary::ColliderContactConstraint(HorizontalContactCache, sCollisionBlend, sColliderPenetrationDepth, Positions, GetParticleParameters());
+		}
+	}
+
+	FHGMConstraintLibrary::ColliderContactConstraint(PlaneColliderContactCache, sCollisionBlend, sColliderPenetrationDepth, Positions, GetParticleParameters());
+
+	// Calculate frictions.
+	// Frictions follow contacts, so they are recalculated whenever contacts are detected again.
+	if (bShouldDetectContacts)
+	{
+		FHGMPhysicsLibrary::ResetFriction(ActualFrictions);
+
+		FHGMPhysicsLibrary::CalculateFriction(Template->Frictions, BodyColliderContactCache, ActualFrictions);
+
+		if constexpr (EnumHasAnyFlags(Features, EHGMSolverFeature::EdgeCollider))
+		{
+			FHGMPhysicsLibrary::CalculateFriction(Template->Frictions, VerticalContactCache, ActualFrictions);
+		}
+
+		FHGMPhysicsLibrary::CalculateFriction(Template->Frictions, PlaneColliderContactCache, ActualFrictions);
+	}
+
+	return ChebyshevMaxDisplacement;
+}
+
+
+template<uint32... FeatureCombinations>
+FHGMDynamicBoneSolver::FSolveConstraintIterationFunction FHGMDynamicBoneSolver::SelectSolveConstraintIteration(EHGMSolverFeature Features, TIntegerSequence<uint32, FeatureCombinations...>)
+{
+	static const FSolveConstraintIterationFunction SolveConstraintIterationFunctions[] =
+	{
+		&FHGMDynamicBoneSolver::SolveConstraintIteration<StaticCast<EHGMSolverFeature>(FeatureCombinations)>...
+	};
+
+	return SolveConstraintIterationFunctions[StaticCast<uint32>(Features)];
+}
+
+
+// ---------------------------------------------------------------------------------------
+// SolverTemplate
+// ---------------------------------------------------------------------------------------
 #define GATHER_SETTINGS_PARAMETERS(Parameter, Curve, Dist) \
 { \
 	const FRichCurve* RichCurve = Curve.GetRichCurveConst(); \
@@ -292,56 +979,182 @@ namespace SolverInternal
 } \
 
 
-bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, const TArray<FHGMChainSetting>& ChainSettings, FHGMPhysicsSettings& PhysicsSettings, FHGMPhysicsContext& PhysicsContext)
+uint64 FHGMSolverTemplate::MakeKey(const FBoneContainer& RequiredBones, const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings)
 {
-	SCOPE_CYCLE_COUNTER(STAT_SolverInitialize);
+	// Reference pose depends on mesh. Required bones of LOD do not affect template, since solver remaps them per instance.
+	// Hash of reference skeleton is included, so that template built before reimport of mesh is not matched.
+	const FString AssetPath = GetPathNameSafe(RequiredBones.GetAsset());
+	uint64 Key = CityHash64(reinterpret_cast<const char*>(*AssetPath), AssetPath.Len() * sizeof(TCHAR));
+	Key = SolverInternal::HashValue(FHGMAnimationLibrary::HashReferenceSkeleton(RequiredBones.GetReferenceSkeleton()), Key);
 
-	bHasInitialized = false;
+	Key = SolverInternal::HashTemplateSettings(PhysicsSettings, Key);
 
-	// Initialize SimulationRootBone.
-	const FReferenceSkeleton& RefSkeleton = RequiredBones.GetReferenceSkeleton();
-	if (PhysicsSettings.bUseSimulationRootBone)
+	Key = SolverInternal::HashValue(ChainSettings.Num(), Key);
+	for (const FHGMChainSetting& ChainSetting : ChainSettings)
 	{
-		if (!PhysicsSettings.SimulationRootBone.Initialize(RequiredBones))
+		Key = SolverInternal::HashTemplateSettings(ChainSetting, Key);
+	}
+
+	return Key;
+}
+
+
+TSharedPtr<const FHGMSolverTemplate> FHGMSolverTemplate::FindOrCreate(const FBoneContainer& RequiredBones, const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings, const TSharedPtr<const FHGMSolverTemplate>& CookedTemplate)
+{
+	const uint64 Key = MakeKey(RequiredBones, ChainSettings, PhysicsSettings);
+	const TSharedPtr<const FHGMReferenceSkeletonCache> RefSkeletonCache = FHGMAnimationLibrary::FindOrCreateReferenceSkeletonCache(RequiredBones);
+
+	FHGMGatheredChains GatheredChains {};
+	if (!GatherChains(RequiredBones, *RefSkeletonCache, ChainSettings, GatheredChains))
+	{
+		return nullptr;
+	}
+
+	return FindOrCreate(Key, GatheredChains, RefSkeletonCache, ChainSettings, PhysicsSettings, CookedTemplate);
+}
+
+
+TSharedPtr<const FHGMSolverTemplate> FHGMSolverTemplate::FindOrCreate(uint64 Key, const FHGMGatheredChains& GatheredChains, const TSharedPtr<const FHGMReferenceSkeletonCache>& RefSkeletonCache,
+																	const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings, const TSharedPtr<const FHGMSolverTemplate>& CookedTemplate)
+{
+	// Cooked template is used as is when it was built from same mesh and settings.
+	if (CookedTemplate.IsValid())
+	{
+		if (CookedTemplate->Key == Key)
 		{
-			FString SkeletonName {};
-			if (USkeleton* SkeletonAsset = RequiredBones.GetSkeletonAsset())
-			{
-				SkeletonName = GetNameSafe(SkeletonAsset);
-			}
+			return CookedTemplate;
+		}
 
-			HGM_LOG(Error, TEXT("SimulationRootBone was not exist in skeleton: %s ."), *SkeletonName);
-			return false;
+		HGM_LOG(Warning, TEXT("Solver data does not match mesh or its reference skeleton. ( e.g. Mesh was reimported after solver data was saved. ) Solver is built at runtime."));
+	}
+
+	if (!SolverInternal::CVarShareSolverTemplate.GetValueOnAnyThread())
+	{
+		TSharedPtr<FHGMSolverTemplate> NewTemplate = MakeShared<FHGMSolverTemplate>();
+		if (!NewTemplate->Initialize(GatheredChains, RefSkeletonCache, ChainSettings, PhysicsSettings))
+		{
+			return nullptr;
 		}
+
+		NewTemplate->Key = Key;
+
+		return NewTemplate;
 	}
 
-	// Initialize LocalGravity.
-	if (PhysicsSettings.GravitySettings.bUseBoneSpaceGravity)
+	// Animation nodes are initialized on worker threads.
+	// Only first instance of key builds template, and instances initialized at same time wait for its result.
+	// Template is built outside lock, so that templates of other keys are not blocked meanwhile.
+	TPromise<TSharedPtr<const FHGMSolverTemplate>> BuildPromise {};
+	TSharedFuture<TSharedPtr<const FHGMSolverTemplate>> BuildingTemplate {};
 	{
-		if (!PhysicsSettings.GravitySettings.DrivingBone.Initialize(RequiredBones))
+		FScopeLock Lock(&SolverInternal::SolverTemplatesCriticalSection);
+
+		if (const SolverInternal::FSolverTemplateEntry* CachedEntry = SolverInternal::SolverTemplates.Find(Key))
 		{
-			FString SkeletonName {};
-			if (USkeleton* SkeletonAsset = RequiredBones.GetSkeletonAsset())
+			if (TSharedPtr<const FHGMSolverTemplate> SharedTemplate = CachedEntry->Template.Pin())
 			{
-				SkeletonName = GetNameSafe(SkeletonAsset);
+				return SharedTemplate;
 			}
 
-			HGM_LOG(Error, TEXT("DrivingBone was not exist in skeleton: %s ."), *SkeletonName);
+			BuildingTemplate = CachedEntry->BuildingTemplate;
+		}
+
+		if (!BuildingTemplate.IsValid())
+		{
+			// Remove templates whose instances were all destroyed.
+			for (auto It = SolverInternal::SolverTemplates.CreateIterator(); It; ++It)
+			{
+				if (!It.Value().Template.IsValid() && !It.Value().BuildingTemplate.IsValid())
+				{
+					It.RemoveCurrent();
+				}
+			}
+
+			SolverInternal::SolverTemplates.Add(Key, SolverInternal::FSolverTemplateEntry { {}, BuildPromise.GetFuture().Share() });
+		}
+	}
+
+	if (BuildingTemplate.IsValid())
+	{
+		return BuildingTemplate.Get();
+	}
+
+	TSharedPtr<FHGMSolverTemplate> NewTemplate = MakeShared<FHGMSolverTemplate>();
+	if (NewTemplate->Initialize(GatheredChains, RefSkeletonCache, ChainSettings, PhysicsSettings))
+	{
+		NewTemplate->Key = Key;
+	}
+	else
+	{
+		NewTemplate.Reset();
+	}
+
+	{
+		FScopeLock Lock(&SolverInternal::SolverTemplatesCriticalSection);
+
+		// Entry is never removed while it is building. Failed key is removed so that next instance tries again.
+		if (NewTemplate.IsValid())
+		{
+			SolverInternal::FSolverTemplateEntry& Entry = SolverInternal::SolverTemplates.FindChecked(Key);
+			Entry.Template = NewTemplate;
+			Entry.BuildingTemplate = TSharedFuture<TSharedPtr<const FHGMSolverTemplate>>();
+		}
+		else
+		{
+			SolverInternal::SolverTemplates.Remove(Key);
+		}
+	}
+
+	BuildPromise.SetValue(NewTemplate);
+
+	return NewTemplate;
+}
+
+
+bool FHGMSolverTemplate::GatherChains(const FBoneContainer& RequiredBones, const FHGMReferenceSkeletonCache& RefSkeletonCache, const TArray<FHGMChainSetting>& ChainSettings, FHGMGatheredChains& OutGatheredChains)
+{
+	const FReferenceSkeleton& RefSkeleton = RequiredBones.GetReferenceSkeleton();
+
+	OutGatheredChains.Bones.SetNum(ChainSettings.Num());
+	OutGatheredChains.Positions.SetNum(ChainSettings.Num());
+	for (int32 ChainIndex = 0; ChainIndex < ChainSettings.Num(); ++ChainIndex)
+	{
+		const FHGMChainSetting& ChainSetting = ChainSettings[ChainIndex];
+		const bool bGatherChainSuccessfully = SolverInternal::GatherChain(RequiredBones, RefSkeleton, RefSkeletonCache, ChainSetting.ExcludeBones,
+			RefSkeleton.FindBoneIndex(ChainSetting.RootBone.BoneName), OutGatheredChains.Bones[ChainIndex], OutGatheredChains.Positions[ChainIndex]);
+
+		if (!bGatherChainSuccessfully)
+		{
+			HGM_LOG(Error, TEXT("Chain collection failed. Bones may have been specified that are not included in mesh."));
 			return false;
 		}
 	}
 
-	// Gather chain from chain settings.
+	return true;
+}
+
+
+bool FHGMSolverTemplate::Initialize(const FHGMGatheredChains& GatheredChains, const TSharedPtr<const FHGMReferenceSkeletonCache>& RefSkeletonCache, const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SolverTemplateInitialize);
+
+	RefSkeletonHash = RefSkeletonCache->RefSkeletonHash;
+
+	// Chains are extended by dummy bones below, so gathered chains are copied.
 	TArray<FHGMChainSetting> CopiedChainSettings = ChainSettings;
 	SimulationPlane.UnpackedHorizontalBoneNum = CopiedChainSettings.Num();
-	TArray<TArray<FHGMVector3>> UnpackedChainPositions {};
-	TArray<TArray<FBoneReference>> UnpackedChainBones {};
+	TArray<TArray<FHGMVector3>> UnpackedChainPositions = GatheredChains.Positions;
+	TArray<TArray<FBoneReference>> UnpackedChainBones = GatheredChains.Bones;
 	TArray<TArray<FHGMReal>> UnpackedNormalizedBoneLengthsArray {};
 	TArray<TArray<FHGMReal>> UnpackedDummyChainBoneMasks {};
 	TArray<int32> UnpackedPlanarConstraintAxes {};
 
-	UnpackedChainPositions.SetNum(SimulationPlane.UnpackedHorizontalBoneNum);
-	UnpackedChainBones.SetNum(SimulationPlane.UnpackedHorizontalBoneNum);
+	if (UnpackedChainBones.Num() != SimulationPlane.UnpackedHorizontalBoneNum)
+	{
+		HGM_LOG(Error, TEXT("Gathered chains do not match chain settings."));
+		return false;
+	}
+
 	UnpackedNormalizedBoneLengthsArray.SetNum(SimulationPlane.UnpackedHorizontalBoneNum);
 	UnpackedDummyChainBoneMasks.SetNum(SimulationPlane.UnpackedHorizontalBoneNum);
 	const bool bUseAnimPosePlanarConstraint = PhysicsSettings.bUseAnimPoseConstraint && PhysicsSettings.bUseAnimPoseConstraintPlanar;
@@ -352,16 +1165,7 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 
 	for (int32 ChainIndex = 0; ChainIndex < SimulationPlane.UnpackedHorizontalBoneNum; ++ChainIndex)
 	{
-		FHGMChainSetting& ChainSetting = CopiedChainSettings[ChainIndex];
-		const bool bGatherChainSuccessfully = SolverInternal::GatherChain(RequiredBones, RefSkeleton, ChainSetting.ExcludeBones,
-			RefSkeleton.FindBoneIndex(ChainSetting.RootBone.BoneName), UnpackedChainBones[ChainIndex], UnpackedChainPositions[ChainIndex]);
-
-		if (!bGatherChainSuccessfully)
-		{
-			HGM_LOG(Error, TEXT("Chain collection failed. Bones may have been specified that are not included in mesh."));
-			return false;
-		}
-
+		FHGMChainSetting& ChainSetting = CopiedChainSettings[ChainIndex];
 		const int32 BoneMaxNum = UnpackedChainBones[ChainIndex].Num();
 		if (BoneMaxNum <= 1)
 		{
@@ -399,6 +1203,7 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 	TArray<TArray<FHGMReal>> UnpackedAnimPoseConstraintRadiusDampingsArray {};
 	TArray<TArray<FHGMReal>> UnpackedAnimPoseConstraintAnglesArray {};
 	TArray<TArray<FHGMReal>> UnpackedAnimPoseConstraintAngleDampingsArray {};
+	TArray<TArray<FHGMReal>> UnpackedTetherStiffnessesArray {};
 
 	UnpackedRadiusesArray.SetNum(BoneLengthArrayNum);
 	UnpackedFrictionsArray.SetNum(BoneLengthArrayNum);
@@ -414,6 +1219,7 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 	UnpackedAnimPoseConstraintRadiusDampingsArray.SetNum(BoneLengthArrayNum);
 	UnpackedAnimPoseConstraintAnglesArray.SetNum(BoneLengthArrayNum);
 	UnpackedAnimPoseConstraintAngleDampingsArray.SetNum(BoneLengthArrayNum);
+	UnpackedTetherStiffnessesArray.SetNum(BoneLengthArrayNum);
 
 	const bool bEnableAnimPoseConstraintMovableRadius = PhysicsSettings.bUseAnimPoseConstraint && PhysicsSettings.bUseAnimPoseConstraintMovableRadius;
 	const bool bEnableAnimPoseConstraintLimitAngle = PhysicsSettings.bUseAnimPoseConstraint && PhysicsSettings.bUseAnimPoseConstraintLimitAngle;
@@ -575,6 +1381,12 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 				GATHER_SETTINGS_PARAMETERS(PhysicsSettings.AnimPoseConstraintLimitAngleSettings.Damping, PhysicsSettings.AnimPoseConstraintLimitAngleSettings.DampingMultiplierCurve, UnpackedAnimPoseConstraintAngleDampingsArray);
 			}
 		}
+
+		// TetherConstraint :
+		if (PhysicsSettings.bUseTetherConstraint)
+		{
+			GATHER_SETTINGS_PARAMETERS(PhysicsSettings.TetherConstraintSettings.Stiffness, PhysicsSettings.TetherConstraintSettings.MultiplierCurve, UnpackedTetherStiffnessesArray);
+		}
 	}
 
 	// Creates simulation plane that is multiple of 4 x 4.
@@ -633,6 +1445,11 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 			UnpackedAnimPoseConstraintAngleDampingsArray[ChainIndex] += DummyZeroReals;
 		}
 
+		if (PhysicsSettings.bUseTetherConstraint)
+		{
+			UnpackedTetherStiffnessesArray[ChainIndex] += DummyZeroReals;
+		}
+
 		UnpackedMassesArray[ChainIndex] += DummyOneReals;
 	}
 
@@ -679,6 +1496,11 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 				UnpackedAnimPoseConstraintAngleDampingsArray.Emplace(DummyZeroReals);
 			}
 
+			if (PhysicsSettings.bUseTetherConstraint)
+			{
+				UnpackedTetherStiffnessesArray.Emplace(DummyZeroReals);
+			}
+
 			UnpackedMassesArray.Emplace(DummyOneReals);
 
 			if (bUseAnimPosePlanarConstraint)
@@ -696,20 +1518,29 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 	SimulationPlane.ActualUnpackedHorizontalBoneNum = ChainSettings.Num();
 
 	Bones.Reset(UnpackedPositionNum);
-	Positions.Reset(PackedPositionNum);
-	FixedBlends.Reset(PackedPositionNum);
-	DummyBoneMasks.Reset(PackedPositionNum);
-	BoneSphereColliderRadiuses.Reset(PackedPositionNum);
-	Frictions.Reset(PackedPositionNum);
-	InverseMasses.Reset(PackedPositionNum);
-	WorldVelocityDampings.Reset(PackedPositionNum);
-	WorldAngularVelocityDampings.Reset(PackedPositionNum);
-	SimulationVelocityDampings.Reset(PackedPositionNum);
-	SimulationAngularVelocityDampings.Reset(PackedPositionNum);
-	MasterDampings.Reset(PackedPositionNum);
+	ReferencePositions.Reset(PackedPositionNum);
+	BoneSphereColliderRadiuses.Values.Reset(PackedPositionNum);
+	Frictions.Values.Reset(PackedPositionNum);
+	WorldVelocityDampings.Values.Reset(PackedPositionNum);
+	WorldAngularVelocityDampings.Values.Reset(PackedPositionNum);
+	SimulationVelocityDampings.Values.Reset(PackedPositionNum);
+	SimulationAngularVelocityDampings.Values.Reset(PackedPositionNum);
+	MasterDampings.Values.Reset(PackedPositionNum);
 	RelativeLimitAngles.Reset(PackedPositionNum);
 	AnimPoseConstraintMovableRadiuses.Reset(PackedPositionNum);
 	AnimPoseConstraintLimitAngles.Reset(PackedPositionNum);
+
+	// Packed into ParticleParameters after all bones are gathered.
+	TArray<FHGMSIMDReal> FixedBlends {};
+	TArray<FHGMSIMDReal> DummyBoneMasks {};
+	TArray<FHGMSIMDReal> InverseMasses {};
+	FixedBlends.Reserve(PackedPositionNum);
+	DummyBoneMasks.Reserve(PackedPositionNum);
+	InverseMasses.Reserve(PackedPositionNum);
+
+	TArray<FHGMSIMDReal> TetherCompliances {};
+	TetherCompliances.Reserve(PhysicsSettings.bUseTetherConstraint ? PackedPositionNum : 0);
+
 	for (int32 VerticalChainBoneIndex = 0; VerticalChainBoneIndex < SimulationPlane.UnpackedVerticalBoneNum; ++VerticalChainBoneIndex)
 	{
 		for (int32 HorizontalChainIndexBase = 0; HorizontalChainIndexBase < SimulationPlane.UnpackedHorizontalBoneNum; HorizontalChainIndexBase += 4)
@@ -731,6 +1562,7 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 			TStaticArray<FHGMReal, 4> UnpackedAnimPoseConstraintRadiusDampings {};
 			TStaticArray<FHGMReal, 4> UnpackedAnimPoseConstraintAngles {};
 			TStaticArray<FHGMReal, 4> UnpackedAnimPoseConstraintAngleDampings {};
+			TStaticArray<FHGMReal, 4> UnpackedTetherCompliances {};
 			for (int32 Offset = 0; Offset < 4; ++Offset)
 			{
 				UnpackedPositions[Offset] = UnpackedChainPositions[HorizontalChainIndexBase + Offset][VerticalChainBoneIndex];
@@ -763,6 +1595,11 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 
 				}
 
+				if (PhysicsSettings.bUseTetherConstraint)
+				{
+					UnpackedTetherCompliances[Offset] = SolverInternal::ConvertStiffnessToCompliance(UnpackedTetherStiffnessesArray[HorizontalChainIndexBase + Offset][VerticalChainBoneIndex]);
+				}
+
 				if (VerticalChainBoneIndex == 0)
 				{
 					const FHGMChainSetting& ChainSetting = CopiedChainSettings[HorizontalChainIndexBase + Offset];
@@ -779,7 +1616,7 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 
 			FHGMSIMDVector3 sPosition {};
 			FHGMSIMDLibrary::Load(sPosition, UnpackedPositions);
-			Positions.Emplace(sPosition);
+			ReferencePositions.Emplace(sPosition);
 
 			FHGMSIMDReal sDummyBoneMask {};
 			FHGMSIMDLibrary::Load(sDummyBoneMask, UnpackedDummyBoneMasks);
@@ -791,31 +1628,31 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 
 			FHGMSIMDReal sRadius {};
 			FHGMSIMDLibrary::Load(sRadius, UnpackedRadiuses);
-			BoneSphereColliderRadiuses.Emplace(sRadius);
+			BoneSphereColliderRadiuses.Values.Emplace(sRadius);
 
 			FHGMSIMDReal sFriction {};
 			FHGMSIMDLibrary::Load(sFriction, UnpackedFrictions);
-			Frictions.Emplace(sFriction);
+			Frictions.Values.Emplace(sFriction);
 
 			FHGMSIMDReal sWorldVelocityDamping {};
 			FHGMSIMDLibrary::Load(sWorldVelocityDamping, UnpackedWorldVelocityDampings );
-			WorldVelocityDampings.Emplace(sWorldVelocityDamping);
+			WorldVelocityDampings.Values.Emplace(sWorldVelocityDamping);
 
 			FHGMSIMDReal sWorldAngularVelocityDamping {};
 			FHGMSIMDLibrary::Load(sWorldAngularVelocityDamping, UnpackedWorldAngularVelocityDampings );
-			WorldAngularVelocityDampings .Emplace(sWorldAngularVelocityDamping);
+			WorldAngularVelocityDampings.Values.Emplace(sWorldAngularVelocityDamping);
 
 			FHGMSIMDReal sSimulationVelocityDamping {};
 			FHGMSIMDLibrary::Load(sSimulationVelocityDamping, UnpackedSimulationVelocityDampings );
-			SimulationVelocityDampings.Emplace(sSimulationVelocityDamping);
+			SimulationVelocityDampings.Values.Emplace(sSimulationVelocityDamping);
 
 			FHGMSIMDReal sSimulationAngularVelocityDamping {};
 			FHGMSIMDLibrary::Load(sSimulationAngularVelocityDamping, UnpackedSimulationAngularVelocityDampings );
-			SimulationAngularVelocityDampings .Emplace(sSimulationAngularVelocityDamping);
+			SimulationAngularVelocityDampings.Values.Emplace(sSimulationAngularVelocityDamping);
 
 			FHGMSIMDReal sMasterDamping {};
 			FHGMSIMDLibrary::Load(sMasterDamping, UnpackedMasterDampings);
-			MasterDampings.Emplace(sMasterDamping);
+			MasterDampings.Values.Emplace(sMasterDamping);
 
 			FHGMSIMDReal sMass {};
 			FHGMSIMDLibrary::Load(sMass, UnpackedMasses);
@@ -846,6 +1683,13 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 				FHGMSIMDLibrary::Load(sAnimPoseConstraintLimitAngle.sDamping, UnpackedAnimPoseConstraintAngleDampings);
 				AnimPoseConstraintLimitAngles.Emplace(sAnimPoseConstraintLimitAngle);
 			}
+
+			if (PhysicsSettings.bUseTetherConstraint)
+			{
+				FHGMSIMDReal sTetherCompliance {};
+				FHGMSIMDLibrary::Load(sTetherCompliance, UnpackedTetherCompliances);
+				TetherCompliances.Emplace(sTetherCompliance);
+			}
 		}
 	}
 
@@ -860,44 +1704,315 @@ bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, cons
 		}
 	}
 
-	ReferencePositions = AnimPosePositions = PrevPositions = Positions;
-	ActualFrictions.Init(HGMSIMDConstants::ZeroReal, Positions.Num());
+	FHGMConstraintLibrary::MakeParticleParameters(InverseMasses, FixedBlends, DummyBoneMasks, ParticleParameters);
+
+	// Most settings have no multiplier curve, so parameters shared by all bones are kept as single register.
+	SolverInternal::CompressUniformParameter(ParticleParameters, BoneSphereColliderRadiuses);
+	SolverInternal::CompressUniformParameter(ParticleParameters, Frictions);
+	SolverInternal::CompressUniformParameter(ParticleParameters, WorldVelocityDampings);
+	SolverInternal::CompressUniformParameter(ParticleParameters, WorldAngularVelocityDampings);
+	SolverInternal::CompressUniformParameter(ParticleParameters, SimulationVelocityDampings);
+	SolverInternal::CompressUniformParameter(ParticleParameters, SimulationAngularVelocityDampings);
+	SolverInternal::CompressUniformParameter(ParticleParameters, MasterDampings);
 
 	// Make structures.
 	VerticalStructures.Reset(SimulationPlane.PackedHorizontalBoneNum * SimulationPlane.UnpackedVerticalBoneNum);
-	FHGMConstraintLibrary::MakeVerticalStructure(SimulationPlane, Positions, VerticalStructures);
+	FHGMConstraintLibrary::MakeVerticalStructure(SimulationPlane, ReferencePositions, VerticalStructures);
 
 	if (PhysicsSettings.bUseHorizontalStructuralConstraint)
 	{
 		HorizontalStructures.Reset(SimulationPlane.PackedHorizontalBoneNum * SimulationPlane.UnpackedVerticalBoneNum);
-		FHGMConstraintLibrary::MakeHorizontalStructure(SimulationPlane, Positions, PhysicsSettings.bLoopHorizontalStructure, HorizontalStructures);
+		FHGMConstraintLibrary::MakeHorizontalStructure(SimulationPlane, ReferencePositions, PhysicsSettings.bLoopHorizontalStructure, HorizontalStructures);
+	}
+
+	if (PhysicsSettings.bUseTetherConstraint)
+	{
+		FHGMConstraintLibrary::MakeTetherStructure(SimulationPlane, VerticalStructures, TetherCompliances, Tethers);
 	}
 
 	if (PhysicsSettings.bUseVerticalBendConstraint)
 	{
-		FHGMConstraintLibrary::MakeVerticalBendStructure(SimulationPlane, Positions, VerticalBendStructures);
+		FHGMConstraintLibrary::MakeVerticalBendStructure(SimulationPlane, ReferencePositions, VerticalBendStructures);
 	}
 
 	if (PhysicsSettings.bUseHorizontalBendConstraint)
 	{
-		FHGMConstraintLibrary::MakeHorizontalBendStructure(SimulationPlane, Positions, HorizontalBendStructures);
+		FHGMConstraintLibrary::MakeHorizontalBendStructure(SimulationPlane, ReferencePositions, HorizontalBendStructures);
 	}
 
 	if (PhysicsSettings.bUseShearConstraint)
 	{
-		FHGMConstraintLibrary::MakeShearStructure(SimulationPlane, Positions, PhysicsSettings.bLoopHorizontalStructure, ShearStructures);
+		FHGMConstraintLibrary::MakeShearStructure(SimulationPlane, ReferencePositions, PhysicsSettings.bLoopHorizontalStructure, ShearStructures);
+	}
+
+	// Make horizontal-major layout.
+	HorizontalSimulationPlane = SimulationPlane;
+	FHGMSolverLibrary::Transpose(HorizontalSimulationPlane);
+
+	TArray<FHGMSIMDReal> HorizontalInverseMasses {};
+	TArray<FHGMSIMDReal> HorizontalFixedBlends {};
+	TArray<FHGMSIMDReal> HorizontalDummyBoneMasks {};
+	HorizontalInverseMasses.SetNum(InverseMasses.Num());
+	HorizontalFixedBlends.SetNum(FixedBlends.Num());
+	HorizontalDummyBoneMasks.SetNum(DummyBoneMasks.Num());
+	FHGMSolverLibrary::Transpose<FHGMSIMDReal, FHGMReal>(SimulationPlane, InverseMasses, HorizontalInverseMasses);
+	FHGMSolverLibrary::Transpose<FHGMSIMDReal, FHGMReal>(SimulationPlane, FixedBlends, HorizontalFixedBlends);
+	FHGMSolverLibrary::Transpose<FHGMSIMDReal, FHGMReal>(SimulationPlane, DummyBoneMasks, HorizontalDummyBoneMasks);
+	FHGMConstraintLibrary::MakeParticleParameters(HorizontalInverseMasses, HorizontalFixedBlends, HorizontalDummyBoneMasks, HorizontalParticleParameters);
+
+	return true;
+}
+
+
+void FHGMSolverTemplate::Serialize(FArchive& Ar)
+{
+	Ar << Key;
+
+	SolverInternal::SerializeElement(Ar, SimulationPlane);
+	SolverInternal::SerializeElement(Ar, HorizontalSimulationPlane);
+
+	int32 BoneNum = Bones.Num();
+	Ar << BoneNum;
+	if (Ar.IsLoading())
+	{
+		Bones.SetNum(BoneNum);
+	}
+
+	// Bone indices are indices of mesh, which do not depend on LOD.
+	for (FBoneReference& Bone : Bones)
+	{
+		int32 BoneIndex = Bone.BoneIndex;
+		int32 CompactPoseBoneIndex = Bone.CachedCompactPoseIndex.GetInt();
+		Ar << Bone.BoneName;
+		Ar << BoneIndex;
+		Ar << CompactPoseBoneIndex;
+		Bone.BoneIndex = BoneIndex;
+		Bone.CachedCompactPoseIndex = FCompactPoseBoneIndex(CompactPoseBoneIndex);
+	}
+
+	SolverInternal::SerializeArray(Ar, ReferencePositions);
+	SolverInternal::SerializeArray(Ar, ParticleParameters);
+	SolverInternal::SerializeBoneParameter(Ar, Frictions);
+	SolverInternal::SerializeBoneParameter(Ar, WorldVelocityDampings);
+	SolverInternal::SerializeBoneParameter(Ar, WorldAngularVelocityDampings);
+	SolverInternal::SerializeBoneParameter(Ar, SimulationVelocityDampings);
+	SolverInternal::SerializeBoneParameter(Ar, SimulationAngularVelocityDampings);
+	SolverInternal::SerializeBoneParameter(Ar, MasterDampings);
+	SolverInternal::SerializeBoneParameter(Ar, BoneSphereColliderRadiuses);
+
+	SolverInternal::SerializeArray(Ar, HorizontalParticleParameters);
+
+	SolverInternal::SerializeArray(Ar, VerticalStructures);
+	SolverInternal::SerializeArray(Ar, HorizontalStructures);
+	SolverInternal::SerializeArray(Ar, VerticalBendStructures);
+	SolverInternal::SerializeArray(Ar, HorizontalBendStructures);
+	SolverInternal::SerializeArray(Ar, ShearStructures);
+	SolverInternal::SerializeArray(Ar, Tethers);
+	SolverInternal::SerializeArray(Ar, RelativeLimitAngles);
+	SolverInternal::SerializeArray(Ar, AnimPoseConstraintMovableRadiuses);
+	SolverInternal::SerializeArray(Ar, AnimPoseConstraintLimitAngles);
+	SolverInternal::SerializeArray(Ar, AnimPosePlanarConstraintAxes);
+}
+
+
+// ---------------------------------------------------------------------------------------
+// DynamicBoneSolver
+// ---------------------------------------------------------------------------------------
+bool FHGMDynamicBoneSolver::Initialize(const FBoneContainer& RequiredBones, const TArray<FHGMChainSetting>& ChainSettings, FHGMPhysicsSettings& PhysicsSettings, FHGMPhysicsContext& PhysicsContext, const TSharedPtr<const FHGMSolverTemplate>& CookedTemplate)
+{
+	// Build or share data that does not depend on instance.
+	const TSharedPtr<const FHGMSolverTemplate> SolverTemplate = FHGMSolverTemplate::FindOrCreate(RequiredBones, ChainSettings, PhysicsSettings, CookedTemplate);
+
+	return InitializeWithTemplate(RequiredBones, SolverTemplate, PhysicsSettings, PhysicsContext);
+}
+
+
+bool FHGMDynamicBoneSolver::InitializeWithTemplate(const FBoneContainer& RequiredBones, const TSharedPtr<const FHGMSolverTemplate>& SolverTemplate, FHGMPhysicsSettings& PhysicsSettings, FHGMPhysicsContext& PhysicsContext)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SolverInitialize);
+
+	bHasInitialized = false;
+
+	// Initialize SimulationRootBone.
+	if (PhysicsSettings.bUseSimulationRootBone)
+	{
+		if (!PhysicsSettings.SimulationRootBone.Initialize(RequiredBones))
+		{
+			FString SkeletonName {};
+			if (USkeleton* SkeletonAsset = RequiredBones.GetSkeletonAsset())
+			{
+				SkeletonName = GetNameSafe(SkeletonAsset);
+			}
+
+			HGM_LOG(Error, TEXT("SimulationRootBone was not exist in skeleton: %s ."), *SkeletonName);
+			return false;
+		}
+	}
+
+	// Initialize LocalGravity.
+	if (PhysicsSettings.GravitySettings.bUseBoneSpaceGravity)
+	{
+		if (!PhysicsSettings.GravitySettings.DrivingBone.Initialize(RequiredBones))
+		{
+			FString SkeletonName {};
+			if (USkeleton* SkeletonAsset = RequiredBones.GetSkeletonAsset())
+			{
+				SkeletonName = GetNameSafe(SkeletonAsset);
+			}
+
+			HGM_LOG(Error, TEXT("DrivingBone was not exist in skeleton: %s ."), *SkeletonName);
+			return false;
+		}
+	}
+
+	Template = SolverTemplate;
+	if (!Template.IsValid())
+	{
+		return false;
 	}
 
+	Positions = PrevPositions = AnimPosePositions = Template->ReferencePositions;
+	SubstepStartPositions = InterpolatedPositions = Template->ReferencePositions;
+	ChebyshevPrevIteratedPositions = ChebyshevCurrentIteratedPositions = Template->ReferencePositions;
+	ActualFrictions.Init(HGMSIMDConstants::ZeroReal, Positions.Num());
+
+	HorizontalPositions.SetNum(Positions.Num());
+	FHGMSolverLibrary::Transpose<FHGMSIMDVector3, FHGMVector3>(Template->SimulationPlane, Positions, HorizontalPositions);
+
+	// Lambdas are accumulated per instance, so structures are copied from template.
+	VerticalStructures = Template->VerticalStructures;
+	HorizontalStructures = Template->HorizontalStructures;
+	VerticalBendStructures = Template->VerticalBendStructures;
+	HorizontalBendStructures = Template->HorizontalBendStructures;
+	ShearStructures = Template->ShearStructures;
+	Tethers = Template->Tethers;
+
 	// Initialize physics context.
 	PhysicsContext.PhysicsSettings = PhysicsSettings;
+	PhysicsContext.TimeAccumulator = 0.0;
 	SolverInternal::ConvertStiffnessesToCompliances(PhysicsSettings, PhysicsContext);
 
+	// Select constraint iteration compiled for enabled features.
+	SolverFeatures = EHGMSolverFeature::None;
+	if (PhysicsSettings.bUseEdgeCollider)
+	{
+		SolverFeatures |= EHGMSolverFeature::EdgeCollider;
+
+		if (PhysicsSettings.bUseHorizontalEdgeCollider && !HorizontalStructures.IsEmpty())
+		{
+			SolverFeatures |= EHGMSolverFeature::HorizontalEdgeCollider;
+		}
+	}
+
+	if (PhysicsSettings.bUseTetherConstraint)
+	{
+		SolverFeatures |= EHGMSolverFeature::TetherConstraint;
+	}
+
+	if (PhysicsSettings.bUseHorizontalStructuralConstraint)
+	{
+		SolverFeatures |= EHGMSolverFeature::HorizontalStructuralConstraint;
+	}
+
+	if (PhysicsSettings.bUseVerticalBendConstraint)
+	{
+		SolverFeatures |= EHGMSolverFeature::VerticalBendConstraint;
+	}
+
+	if (PhysicsSettings.bUseHorizontalBendConstraint)
+	{
+		SolverFeatures |= EHGMSolverFeature::HorizontalBendConstraint;
+	}
+
+	if (PhysicsSettings.bUseShearConstraint)
+	{
+		SolverFeatures |= EHGMSolverFeature::ShearConstraint;
+	}
+
+	// Rigid vertical structure takes priority over solve mode.
+	if (PhysicsSettings.bUseRigidVerticalStructureConstraint)
+	{
+		SolverFeatures |= EHGMSolverFeature::RigidVerticalStructureConstraint;
+	}
+	else if (PhysicsSettings.VerticalStructureSolveMode == EHGMVerticalStructureSolveMode::Direct)
+	{
+		SolverFeatures |= EHGMSolverFeature::DirectVerticalStructureConstraint;
+	}
+
+	SolveConstraintIterationFunction = SelectSolveConstraintIteration(SolverFeatures, TMakeIntegerSequence<uint32, StaticCast<uint32>(EHGMSolverFeature::CombinationNum)>());
+
+#if STATS
+	SolverPipelineStatId = FDynamicStats::CreateStatId<FStatGroup_STATGROUP_Hagoromo>(FString::Printf(TEXT("Solver Pipeline 0x%03X"), StaticCast<uint32>(SolverFeatures)));
+#endif
+
+	UpdateRequiredBones(RequiredBones, PhysicsContext);
+
 	bHasInitialized = true;
 
 	return true;
 }
 
 
+void FHGMDynamicBoneSolver::UpdateRequiredBones(const FBoneContainer& RequiredBones, FHGMPhysicsContext& PhysicsContext)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SolverUpdateRequiredBones);
+
+	if (!Template.IsValid())
+	{
+		return;
+	}
+
+	// Bones removed by LOD become dummy bones of this instance.
+	// They follow their parent without forces, collisions and influence on other bones, and continue from there when LOD returns.
+	TArray<FHGMSIMDReal> RemovedBoneMasks {};
+	RemovedBoneMasks.Init(HGMSIMDConstants::ZeroReal, Template->ParticleParameters.Num());
+	bool bHasRemovedBone = false;
+
+	CompactPoseBoneIndexes.SetNumUninitialized(Template->Bones.Num());
+	for (int32 UnpackedBoneIndex = 0; UnpackedBoneIndex < Template->Bones.Num(); ++UnpackedBoneIndex)
+	{
+		const int32 BoneIndex = Template->Bones[UnpackedBoneIndex].BoneIndex;
+		if (BoneIndex == INDEX_NONE)
+		{
+			CompactPoseBoneIndexes[UnpackedBoneIndex] = FCompactPoseBoneIndex(INDEX_NONE);
+			continue;
+		}
+
+		if (!RequiredBones.Contains(StaticCast<FBoneIndexType>(BoneIndex)))
+		{
+			CompactPoseBoneIndexes[UnpackedBoneIndex] = FCompactPoseBoneIndex(INDEX_NONE);
+			FHGMSIMDLibrary::Load(RemovedBoneMasks[UnpackedBoneIndex / 4], UnpackedBoneIndex % 4, 1.0);
+			bHasRemovedBone = true;
+			continue;
+		}
+
+		CompactPoseBoneIndexes[UnpackedBoneIndex] = RequiredBones.MakeCompactPoseIndex(FMeshPoseBoneIndex(BoneIndex));
+	}
+
+	// Template is read directly while all bones are required.
+	LODParticleParameters.Reset();
+	LODHorizontalParticleParameters.Reset();
+	if (bHasRemovedBone)
+	{
+		SolverInternal::MaskRemovedBones(Template->ParticleParameters, RemovedBoneMasks, LODParticleParameters);
+
+		FHGMSolverLibrary::Transpose<FHGMSIMDReal, FHGMReal>(Template->SimulationPlane, RemovedBoneMasks);
+		SolverInternal::MaskRemovedBones(Template->HorizontalParticleParameters, RemovedBoneMasks, LODHorizontalParticleParameters);
+	}
+
+	// Bones of settings are not required by LOD either, and are skipped while invalid.
+	if (PhysicsContext.PhysicsSettings.bUseSimulationRootBone)
+	{
+		PhysicsContext.PhysicsSettings.SimulationRootBone.Initialize(RequiredBones);
+	}
+
+	if (PhysicsContext.PhysicsSettings.GravitySettings.bUseBoneSpaceGravity)
+	{
+		PhysicsContext.PhysicsSettings.GravitySettings.DrivingBone.Initialize(RequiredBones);
+	}
+}
+
+
 void FHGMDynamicBoneSolver::PreSimulate(FComponentSpacePoseContext& Output, const FHGMPhysicsSettings& PhysicsSettings, FHGMPhysicsContext& PhysicsContext, int32 AnimationCurveNumber)
 {
 	SCOPE_CYCLE_COUNTER(STAT_SolverPreSimulate);
@@ -912,79 +2027,194 @@ void FHGMDynamicBoneSolver::PreSimulate(FComponentSpacePoseContext& Output, cons
 	if (PhysicsContext.PhysicsSettings.bUseSimulationRootBone)
 	{
 		SolverInternal::UpdateSimulationRootBoneTransform(Output, PhysicsContext);
-		SolverInternal::ApplySimulationRootBone(PhysicsContext, Positions, PrevPositions);
+		SolverInternal::ApplySimulationRootBone(PhysicsContext, Positions, PrevPositions, SubstepStartPositions);
 	}
 
-	SolverInternal::CopyAnimationPositions(Output, Bones, AnimPosePositions);
+	SolverInternal::CopyAnimationPositions(Output, Template->Bones, CompactPoseBoneIndexes, Positions, AnimPosePositions);
 }
 
 
-void FHGMDynamicBoneSolver::Simulate(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, const FHGMBodyCollider& PrevBodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders)
+void FHGMDynamicBoneSolver::Simulate(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders)
 {
 	SCOPE_CYCLE_COUNTER(STAT_SolverSimulate);
 
-	//----------------------------------------------------------
-	// Add forces
-	//----------------------------------------------------------
-	FHGMPhysicsLibrary::ApplyForces(Output, PhysicsContext, Positions, PrevPositions,
-								WorldVelocityDampings, WorldAngularVelocityDampings, SimulationVelocityDampings, SimulationAngularVelocityDampings, MasterDampings,
-								ActualFrictions, FixedBlends, DummyBoneMasks);
+	if (!PhysicsContext.PhysicsSettings.bUseFixedTimeStep)
+	{
+		SimulateStep(Output, PhysicsContext, BodyCollider, PlaneColliders);
+		INC_DWORD_STAT(STAT_SolverSubsteps);
+		return;
+	}
+
+	// Consume accumulated time with fixed time step.
+	const FHGMReal FixedTimeStep = SolverInternal::GetFixedTimeStep(PhysicsContext.PhysicsSettings);
+	int32 SubstepNum = FMath::FloorToInt32(PhysicsContext.TimeAccumulator / FixedTimeStep);
+	if (SubstepNum > PhysicsContext.PhysicsSettings.MaxSubsteps)
+	{
+		// Discard time that can not be consumed so that load does not keep increasing after hitch.
+		SubstepNum = PhysicsContext.PhysicsSettings.MaxSubsteps;
+		PhysicsContext.TimeAccumulator = StaticCast<FHGMReal>(SubstepNum) * FixedTimeStep;
+	}
+	PhysicsContext.TimeAccumulator = FHGMMathLibrary::Max<FHGMReal>(PhysicsContext.TimeAccumulator - StaticCast<FHGMReal>(SubstepNum) * FixedTimeStep, 0.0);
+
+	// Inertia moves Positions but not SubstepStartPositions, so it is also applied to SubstepStartPositions
+	// whenever it is applied after they were captured. Otherwise interpolation pops by offset of inertia.
+	if (SubstepNum == 0)
+	{
+		// Movement of actor must be reflected even in frames without substep.
+		SolverInternal::ApplyInertia(Output, PhysicsContext, *Template, GetParticleParameters(), Positions, PrevPositions, ActualFrictions);
+		SolverInternal::ApplyInertia(Output, PhysicsContext, *Template, GetParticleParameters(), SubstepStartPositions, PrevPositions, ActualFrictions);
+	}
+
+	for (int32 SubstepIndex = 0; SubstepIndex < SubstepNum; ++SubstepIndex)
+	{
+		PhysicsContext.sInertiaScale = SubstepIndex == 0 ? HGMSIMDConstants::OneReal : HGMSIMDConstants::ZeroReal;
+
+		if (SubstepIndex == SubstepNum - 1)
+		{
+			SubstepStartPositions = Positions;
+
+			// Inertia of this frame is applied in first substep, which is also last one.
+			if (SubstepIndex == 0)
+			{
+				SolverInternal::ApplyInertia(Output, PhysicsContext, *Template, GetParticleParameters(), SubstepStartPositions, PrevPositions, ActualFrictions);
+			}
+		}
+
+		SimulateStep(Output, PhysicsContext, BodyCollider, PlaneColliders);
+	}
+	PhysicsContext.sInertiaScale = HGMSIMDConstants::OneReal;
+
+	INC_DWORD_STAT_BY(STAT_SolverSubsteps, SubstepNum);
+
+	// Interpolate between last two substeps by remaining time.
+	// Fixed bones follow current animation pose regardless of interpolation.
+	FHGMSIMDReal sInterpolationAlpha {};
+	FHGMSIMDLibrary::Load(sInterpolationAlpha, FHGMMathLibrary::Clamp<FHGMReal>(PhysicsContext.TimeAccumulator / FixedTimeStep, 0.0, 1.0));
+	for (int32 PackedIndex = 0; PackedIndex < Positions.Num(); ++PackedIndex)
+	{
+		const FHGMSIMDVector3 sInterpolatedPosition = FHGMMathLibrary::Lerp(SubstepStartPositions[PackedIndex], Positions[PackedIndex], sInterpolationAlpha);
+		InterpolatedPositions[PackedIndex] = FHGMMathLibrary::Lerp(sInterpolatedPosition, AnimPosePositions[PackedIndex], GetParticleParameters()[PackedIndex].sFixedBlend);
+	}
+}
+
+
+void FHGMDynamicBoneSolver::SimulateStep(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders)
+{
+	if (!PhysicsContext.PhysicsSettings.bUseSmallSteps)
+	{
+		SimulateSubstep(Output, PhysicsContext, BodyCollider, PlaneColliders, PhysicsContext.PhysicsSettings.SolverIterations);
+		return;
+	}
+
+	// Small Steps :
+	// Instead of iterating constraints SolverIterations times, step is divided into SolverIterations substeps with one iteration each.
+	// See https://mmacklin.com/smallsteps.pdf .
+	const int32 SmallStepNum = FHGMMathLibrary::Max(PhysicsContext.PhysicsSettings.SolverIterations, 1);
+	FHGMSIMDReal sSmallStepNum {};
+	FHGMSIMDLibrary::Load(sSmallStepNum, StaticCast<FHGMReal>(SmallStepNum));
+
+	const FHGMSIMDReal sCopiedDeltaTime = PhysicsContext.sDeltaTime;
+	const FHGMSIMDReal sCopiedPrevDeltaTime = PhysicsContext.sPrevDeltaTime;
+	const FHGMSIMDReal sCopiedInertiaScale = PhysicsContext.sInertiaScale;
+
+	PhysicsContext.sDeltaTime = sCopiedDeltaTime / sSmallStepNum;
+	PhysicsContext.sPrevDeltaTime = sCopiedPrevDeltaTime / sSmallStepNum;
+	const FHGMSIMDReal sVelocityRetentionExponent = HGMSIMDConstants::OneReal / sSmallStepNum;
+	SolverInternal::CalculateSmallStepRetentions(Template->MasterDampings, sVelocityRetentionExponent, PhysicsContext.SmallStepMasterDampingRetentions);
+	SolverInternal::CalculateSmallStepRetentions(Template->Frictions, sVelocityRetentionExponent, PhysicsContext.SmallStepFrictionRetentions);
+	for (int32 SmallStepIndex = 0; SmallStepIndex < SmallStepNum; ++SmallStepIndex)
+	{
+		PhysicsContext.sInertiaScale = SmallStepIndex == 0 ? sCopiedInertiaScale : HGMSIMDConstants::ZeroReal;
+		SimulateSubstep(Output, PhysicsContext, BodyCollider, PlaneColliders, 1);
+		PhysicsContext.sPrevDeltaTime = PhysicsContext.sDeltaTime;
+	}
+
+	PhysicsContext.sDeltaTime = sCopiedDeltaTime;
+	PhysicsContext.sPrevDeltaTime = sCopiedPrevDeltaTime;
+	PhysicsContext.sInertiaScale = sCopiedInertiaScale;
+}
 
 
+void FHGMDynamicBoneSolver::SimulateSubstep(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders, int32 IterationNum)
+{
 	//----------------------------------------------------------
-	// Update positions
+	// Add forces and update positions
 	//----------------------------------------------------------
-	FHGMPhysicsLibrary::VerletIntegrate(PhysicsContext, Positions, PrevPositions, ActualFrictions, MasterDampings, FixedBlends, DummyBoneMasks);
+	if (SolverInternal::CVarFusedIntegration.GetValueOnAnyThread() != 0)
+	{
+		FHGMPhysicsLibrary::IntegrateForces(Output, PhysicsContext, Positions, PrevPositions, AnimPosePositions,
+										Template->WorldVelocityDampings, Template->WorldAngularVelocityDampings, Template->SimulationVelocityDampings, Template->SimulationAngularVelocityDampings, Template->MasterDampings,
+										ActualFrictions, GetParticleParameters());
+	}
+	else
+	{
+		FHGMPhysicsLibrary::ApplyForces(Output, PhysicsContext, Positions, PrevPositions,
+									Template->WorldVelocityDampings, Template->WorldAngularVelocityDampings, Template->SimulationVelocityDampings, Template->SimulationAngularVelocityDampings, Template->MasterDampings,
+									ActualFrictions, GetParticleParameters());
+		FHGMPhysicsLibrary::VerletIntegrate(PhysicsContext, Positions, PrevPositions, ActualFrictions, Template->MasterDampings, GetParticleParameters());
+		FHGMConstraintLibrary::FixedBlendConstraint(Positions, PrevPositions, AnimPosePositions, GetParticleParameters());
+	}
 
 
 	//----------------------------------------------------------
 	// Solve constraints and collision detection
 	//----------------------------------------------------------
-	FHGMConstraintLibrary::FixedBlendConstraint(Positions, PrevPositions, AnimPosePositions, FixedBlends);
 
 	if (PhysicsContext.PhysicsSettings.bUseRelativeLimitAngleConstraint)
 	{
-		FHGMConstraintLibrary::RelativeLimitAngleConstraint(SimulationPlane, VerticalStructures, RelativeLimitAngles, AnimPosePositions, Positions, DummyBoneMasks);
+		FHGMConstraintLibrary::RelativeLimitAngleConstraint(Template->SimulationPlane, VerticalStructures, Template->RelativeLimitAngles, AnimPosePositions, Positions, GetParticleParameters());
 	}
 
 	if (PhysicsContext.PhysicsSettings.bUseAnimPoseConstraint)
 	{
 		if (PhysicsContext.PhysicsSettings.bUseAnimPoseConstraintMovableRadius)
 		{
-			FHGMConstraintLibrary::AnimPoseMovableRadiusConstraint(AnimPoseConstraintMovableRadiuses, AnimPosePositions, Positions);
+			FHGMConstraintLibrary::AnimPoseMovableRadiusConstraint(Template->AnimPoseConstraintMovableRadiuses, AnimPosePositions, Positions);
 		}
 
 		if (PhysicsContext.PhysicsSettings.bUseAnimPoseConstraintLimitAngle)
 		{
-			FHGMConstraintLibrary::AnimPoseLimitAngleConstraint(VerticalStructures, AnimPoseConstraintLimitAngles, AnimPosePositions, Positions);
+			FHGMConstraintLibrary::AnimPoseLimitAngleConstraint(VerticalStructures, Template->AnimPoseConstraintLimitAngles, AnimPosePositions, Positions);
 		}
 
 		if (PhysicsContext.PhysicsSettings.bUseAnimPoseConstraintPlanar)
 		{
-			FHGMConstraintLibrary::AnimPosePlanarConstraint(AnimPosePlanarConstraintAxes, VerticalStructures, SimulationPlane, Output, Bones, AnimPosePositions, Positions);
+			FHGMConstraintLibrary::AnimPosePlanarConstraint(Template->AnimPosePlanarConstraintAxes, VerticalStructures, Template->SimulationPlane, Output, CompactPoseBoneIndexes, AnimPosePositions, Positions);
 		}
 	}
 
-	FHGMConstraintLibrary::ResetLambda<FHGMSIMDStructure>(VerticalStructures);
+	// Lambda is accumulated with compliance divided by squared delta time, so it is rescaled by change of delta time.
+	const bool bUseWarmStart = PhysicsContext.PhysicsSettings.bUseWarmStart;
+	FHGMSIMDReal sWarmStartScale {};
+	FHGMSIMDLibrary::Load(sWarmStartScale, PhysicsContext.PhysicsSettings.WarmStartRelaxation);
+	const FHGMSIMDReal sDeltaTimeChangeFactor = PhysicsContext.sDeltaTime / PhysicsContext.sPrevDeltaTime;
+	sWarmStartScale *= sDeltaTimeChangeFactor * sDeltaTimeChangeFactor;
+
+	SolverInternal::InitializeLambda<FHGMSIMDStructure>(VerticalStructures, bUseWarmStart, sWarmStartScale);
 
 	if (PhysicsContext.PhysicsSettings.bUseHorizontalStructuralConstraint)
 	{
-		FHGMConstraintLibrary::ResetLambda<FHGMSIMDStructure>(HorizontalStructures);
+		SolverInternal::InitializeLambda<FHGMSIMDStructure>(HorizontalStructures, bUseWarmStart, sWarmStartScale);
+	}
+
+	if (PhysicsContext.PhysicsSettings.bUseTetherConstraint)
+	{
+		SolverInternal::InitializeLambda<FHGMSIMDTether>(Tethers, bUseWarmStart, sWarmStartScale);
 	}
 
 	if (PhysicsContext.PhysicsSettings.bUseVerticalBendConstraint)
 	{
-		FHGMConstraintLibrary::ResetLambda<FHGMSIMDStructure>(VerticalBendStructures);
+		SolverInternal::InitializeLambda<FHGMSIMDStructure>(VerticalBendStructures, bUseWarmStart, sWarmStartScale);
 	}
 
 	if (PhysicsContext.PhysicsSettings.bUseHorizontalBendConstraint)
 	{
-		FHGMConstraintLibrary::ResetLambda<FHGMSIMDStructure>(HorizontalBendStructures);
+		SolverInternal::InitializeLambda<FHGMSIMDStructure>(HorizontalBendStructures, bUseWarmStart, sWarmStartScale);
 	}
 
 	if (PhysicsContext.PhysicsSettings.bUseShearConstraint)
 	{
-		FHGMConstraintLibrary::ResetLambda<FHGMSIMDShearStructure>(ShearStructures);
+		SolverInternal::InitializeLambda<FHGMSIMDShearStructure>(ShearStructures, bUseWarmStart, sWarmStartScale);
 	}
 
 	FHGMSIMDReal sCollisionBlend {};
@@ -993,94 +2223,81 @@ void FHGMDynamicBoneSolver::Simulate(FComponentSpacePoseContext& Output, FHGMPhy
 	FHGMSIMDReal sColliderPenetrationDepth {};
 	FHGMSIMDLibrary::Load(sColliderPenetrationDepth, PhysicsContext.PhysicsSettings.ColliderPenetrationDepth);
 
-	for (int32 IterationCount = 0; IterationCount < PhysicsContext.PhysicsSettings.SolverIterations; ++IterationCount)
-	{
-		// Collision detection.
-		// #OPTIMIZE
-		//  - Add mechanism to cache contacts to reduce number of calculations. However, caches should be considered carefully as fabric penetration is likely to occur.
-		//  - Implement Acceleration Structure. Care should be taken not to increase load by footing.
-		BodyColliderContactCache.Reset();
-		FHGMCollisionLibrary::CalculateBodyColliderContacts(BoneSphereColliderRadiuses, Positions, PrevPositions, BodyCollider, PrevBodyCollider, BodyColliderContactCache);
-
-		if (PhysicsContext.PhysicsSettings.bUseEdgeCollider)
-		{
-			VerticalContactCache.Reset();
-			FHGMCollisionLibrary::CalculateBodyColliderContactsForVerticalEdge(VerticalStructures, Positions, BodyCollider, VerticalContactCache);
-
-			if (PhysicsContext.PhysicsSettings.bUseHorizontalEdgeCollider && !HorizontalStructures.IsEmpty())
-			{
-				HorizontalContactCache.Reset();
-				FHGMCollisionLibrary::CalculateBodyColliderContactsForHorizontalEdge(SimulationPlane, HorizontalStructures, Positions, BodyCollider, HorizontalContactCache);
-			}
-		}
+	const bool bUseEarlyTermination = PhysicsContext.PhysicsSettings.bUseEarlyTermination && IterationNum > 1;
+	const int32 MinIterationNum = FMath::Clamp(PhysicsContext.PhysicsSettings.MinSolverIterations, 1, IterationNum);
 
-		PlaneColliderContactCache.Reset();
-		FHGMCollisionLibrary::CalculatePlaneColliderContacts(PlaneColliders, BoneSphereColliderRadiuses, Positions, PlaneColliderContactCache);
+	const bool bUseChebyshevAcceleration = PhysicsContext.PhysicsSettings.bUseChebyshevAcceleration && IterationNum > SolverInternal::ChebyshevDelayIterationNum;
+	const bool bUseAutoSpectralRadius = PhysicsContext.PhysicsSettings.ChebyshevSpectralRadius <= 0.0;
+	FHGMReal SpectralRadius = FMath::Min(PhysicsContext.PhysicsSettings.ChebyshevSpectralRadius, SolverInternal::ChebyshevMaxSpectralRadius);
+	FHGMReal Omega = 1.0;
+	FHGMReal PrevMaxDisplacement = 0.0;
+	bool bHasChebyshevDiverged = false;
+	if (bUseChebyshevAcceleration)
+	{
+		ChebyshevPrevIteratedPositions = Positions;
+		ChebyshevCurrentIteratedPositions = Positions;
+	}
 
-		// Applying Constraints.
-		if (PhysicsContext.PhysicsSettings.bUseRigidVerticalStructureConstraint)
-		{
-			FHGMConstraintLibrary::RigidVerticalStructuralConstraint(VerticalStructures, Positions, FixedBlends);
-		}
-		else
-		{
-			FHGMConstraintLibrary::VerticalStructuralConstraint(VerticalStructures, PhysicsContext, Positions, InverseMasses, FixedBlends, DummyBoneMasks);
-		}
+#if STATS
+	FScopeCycleCounter SolverPipelineCycleCounter(SolverPipelineStatId);
+#endif
 
-		if (PhysicsContext.PhysicsSettings.bUseHorizontalStructuralConstraint)
-		{
-			FHGMConstraintLibrary::HorizontalStructuralConstraint(HorizontalStructures, PhysicsContext, SimulationPlane, Positions, InverseMasses, FixedBlends, DummyBoneMasks);
-		}
+	int32 IterationCount = 0;
+	while (IterationCount < IterationNum)
+	{
+		PhysicsContext.sMaxConstraintError = HGMSIMDConstants::ZeroReal;
 
-		if (PhysicsContext.PhysicsSettings.bUseVerticalBendConstraint)
+		// Chebyshev acceleration.
+		if (bUseChebyshevAcceleration)
 		{
-			FHGMConstraintLibrary::VerticalBendConstraint(VerticalBendStructures, PhysicsContext, Positions, InverseMasses, FixedBlends, DummyBoneMasks);
+			if (IterationCount < SolverInternal::ChebyshevDelayIterationNum || bHasChebyshevDiverged)
+			{
+				Omega = 1.0;
+			}
+			else if (IterationCount == SolverInternal::ChebyshevDelayIterationNum)
+			{
+				Omega = 2.0 / (2.0 - SpectralRadius * SpectralRadius);
+			}
+			else
+			{
+				Omega = 4.0 / (4.0 - SpectralRadius * SpectralRadius * Omega);
+			}
 		}
 
-		if (PhysicsContext.PhysicsSettings.bUseHorizontalBendConstraint)
-		{
-			FHGMConstraintLibrary::HorizontalBendConstraint(HorizontalBendStructures, PhysicsContext, SimulationPlane, Positions, InverseMasses, FixedBlends, DummyBoneMasks);
-		}
+		const FHGMReal MaxDisplacement = (this->*SolveConstraintIterationFunction)(Output, PhysicsContext, BodyCollider, PlaneColliders, sCollisionBlend, sColliderPenetrationDepth, IterationCount == 0, bUseChebyshevAcceleration, Omega);
 
-		if (PhysicsContext.PhysicsSettings.bUseShearConstraint)
+		if (bUseChebyshevAcceleration)
 		{
-			FHGMConstraintLibrary::ShearConstraint(ShearStructures, PhysicsContext, SimulationPlane, Positions, InverseMasses, FixedBlends, DummyBoneMasks);
-		}
-
-		// Solve contacts.
-		FHGMConstraintLibrary::ColliderContactConstraint(BodyColliderContactCache, sCollisionBlend, sColliderPenetrationDepth, Positions, FixedBlends, DummyBoneMasks);
+			// Estimate spectral radius from convergence rate of plain iterations.
+			if (bUseAutoSpectralRadius && IterationCount == SolverInternal::ChebyshevDelayIterationNum - 1)
+			{
+				SpectralRadius = PrevMaxDisplacement > UE_SMALL_NUMBER ? FMath::Clamp(MaxDisplacement / PrevMaxDisplacement, 0.0, SolverInternal::ChebyshevMaxSpectralRadius) : 0.0;
+			}
 
-		if (PhysicsContext.PhysicsSettings.bUseEdgeCollider)
-		{
-			FHGMConstraintLibrary::ColliderContactConstraint(VerticalContactCache, sCollisionBlend, sColliderPenetrationDepth, Positions, FixedBlends, DummyBoneMasks);
-			if (PhysicsContext.PhysicsSettings.bUseHorizontalEdgeCollider && !HorizontalStructures.IsEmpty())
+			// Fall back to plain Gauss-Seidel if acceleration makes iterations diverge.
+			if (IterationCount > SolverInternal::ChebyshevDelayIterationNum && MaxDisplacement > PrevMaxDisplacement)
 			{
-				FScopedTranspose ScopedTranspose(&SimulationPlane);
-				ScopedTranspose.Add(&Positions);
-				ScopedTranspose.Add(&FixedBlends);
-				ScopedTranspose.Add(&DummyBoneMasks);
-				ScopedTranspose.Execute();
-				FHGMConstraintLibrary::ColliderContactConstraint(HorizontalContactCache, sCollisionBlend, sColliderPenetrationDepth, Positions, FixedBlends, DummyBoneMasks);
+				bHasChebyshevDiverged = true;
 			}
+
+			PrevMaxDisplacement = MaxDisplacement;
 		}
 
-		FHGMConstraintLibrary::ColliderContactConstraint(PlaneColliderContactCache, sCollisionBlend, sColliderPenetrationDepth, Positions, FixedBlends, DummyBoneMasks);
+		++IterationCount;
 
-		// Calculate frictions.
-		if (IterationCount == 0)
+		// Residual-driven early termination.
+		if (bUseEarlyTermination && IterationCount >= MinIterationNum)
 		{
-			FHGMPhysicsLibrary::ResetFriction(ActualFrictions);
-
-			FHGMPhysicsLibrary::CalculateFriction(Frictions, BodyColliderContactCache, ActualFrictions);
-
-			if (PhysicsContext.PhysicsSettings.bUseEdgeCollider)
+			const FHGMReal MaxConstraintError = SolverInternal::ReduceMax(PhysicsContext.sMaxConstraintError);
+			if (MaxConstraintError < PhysicsContext.PhysicsSettings.ResidualTolerance)
 			{
-				FHGMPhysicsLibrary::CalculateFriction(Frictions, VerticalContactCache, ActualFrictions);
+				break;
 			}
-
-			FHGMPhysicsLibrary::CalculateFriction(Frictions, PlaneColliderContactCache, ActualFrictions);
 		}
 	}
+
+	INC_DWORD_STAT_BY(STAT_SolverIterations, IterationCount);
+	INC_DWORD_STAT(STAT_SolverIterationLoops);
 }
 
 
@@ -1088,10 +2305,19 @@ void FHGMDynamicBoneSolver::OutputSimulateResult(FHGMPhysicsContext& PhysicsCont
 {
 	SCOPE_CYCLE_COUNTER(STAT_SolverOutputSimulateResult);
 
-	const FBoneContainer& BoneContainer =  Output.Pose.GetPose().GetBoneContainer();
+	// With fixed time step, positions interpolated between substeps are output.
+	const TArray<FHGMSIMDVector3>& ResultPositions = PhysicsContext.PhysicsSettings.bUseFixedTimeStep ? InterpolatedPositions : Positions;
+
+	// Weight of physics result against animation pose.
+	const FHGMReal OutputAlpha = PhysicsContext.Alpha * PhysicsContext.FadeInAlpha;
 
-	TArray<TStaticArray<FHGMQuaternion, 4>> PrevBoneQuaternions {};
-	PrevBoneQuaternions.SetNum(SimulationPlane.PackedHorizontalBoneNum);
+	FHGMScopedScratchMemory ScratchMemory {};
+	TArray<TStaticArray<FHGMQuaternion, 4>, TMemStackAllocator<>> PrevBoneQuaternions {};
+	PrevBoneQuaternions.SetNum(Template->SimulationPlane.PackedHorizontalBoneNum);
+
+	// Chain cut by LOD right below its root has no parent quaternion.
+	TArray<TStaticArray<bool, 4>, TMemStackAllocator<>> HasPrevBoneQuaternions {};
+	HasPrevBoneQuaternions.SetNumZeroed(Template->SimulationPlane.PackedHorizontalBoneNum);
 
 	for (int32 VerticalStructureIndex = 0; VerticalStructureIndex < VerticalStructures.Num(); ++VerticalStructureIndex)
 	{
@@ -1103,82 +2329,88 @@ void FHGMDynamicBoneSolver::OutputSimulateResult(FHGMPhysicsContext& PhysicsCont
 		TStaticArray<int32, 4> SecondBoneIndexes {};
 		FHGMSIMDLibrary::Store(VerticalStructure.sSecondBoneUnpackedIndex, SecondBoneIndexes);
 
-		const int32 PackedHorizontalIndex = VerticalStructureIndex % SimulationPlane.PackedHorizontalBoneNum;
+		const int32 PackedHorizontalIndex = VerticalStructureIndex % Template->SimulationPlane.PackedHorizontalBoneNum;
 		for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
 		{
 			const int32 FirstBoneIndex = FirstBoneIndexes[ComponentIndex];
-			const FBoneReference& FirstBone = Bones[FirstBoneIndex];
+			const FCompactPoseBoneIndex& FirstBoneCompactIndex = CompactPoseBoneIndexes[FirstBoneIndex];
 
-			if (!FirstBone.IsValidToEvaluate())
+			if (!FirstBoneCompactIndex.IsValid())
 			{
 				continue;
 			}
 
-			const FCompactPoseBoneIndex FirstBoneCompactIndex = FirstBone.GetCompactPoseIndex(BoneContainer);
 			const FHGMTransform& OriginalFirstBoneTransform = Output.Pose.GetComponentSpaceTransform(FirstBoneCompactIndex);
 
 			FHGMVector3 FirstBonePosition {};
-			FHGMSIMDLibrary::Store(Positions[VerticalStructure.FirstBonePackedIndex], ComponentIndex, FirstBonePosition);
+			FHGMSIMDLibrary::Store(ResultPositions[VerticalStructure.FirstBonePackedIndex], ComponentIndex, FirstBonePosition);
 
 			const int32 SecondBoneIndex = SecondBoneIndexes[ComponentIndex];
-			const FBoneReference& SecondBone = Bones[SecondBoneIndex];
-			if (!SecondBone.IsValidToEvaluate())
+			const FCompactPoseBoneIndex& SecondBoneCompactIndex = CompactPoseBoneIndexes[SecondBoneIndex];
+			if (!SecondBoneCompactIndex.IsValid())
 			{
-				const FHGMTransform BoneTransform(PrevBoneQuaternions[PackedHorizontalIndex][ComponentIndex], FirstBonePosition, OriginalFirstBoneTransform.GetScale3D());
+				// Last bone of chain cut by LOD outputs same posture as parent like tip bone.
+				const FHGMQuaternion BoneQuaternion = HasPrevBoneQuaternions[PackedHorizontalIndex][ComponentIndex] ? PrevBoneQuaternions[PackedHorizontalIndex][ComponentIndex] : OriginalFirstBoneTransform.GetRotation();
+				FHGMTransform BoneTransform(BoneQuaternion, FirstBonePosition, OriginalFirstBoneTransform.GetScale3D());
+
+				if (OutputAlpha < 1.0)
+				{
+					BoneTransform.BlendWith(OriginalFirstBoneTransform, 1.0 - OutputAlpha);
+				}
+
 				OutBoneTransforms.Add(FBoneTransform(FirstBoneCompactIndex, BoneTransform));
 				continue;
 			}
 
-			const FCompactPoseBoneIndex SecondBoneCompactIndex = SecondBone.GetCompactPoseIndex(BoneContainer);
 			const FHGMTransform& OriginalSecondBoneTransform = Output.Pose.GetComponentSpaceTransform(SecondBoneCompactIndex);
 
 			const FHGMVector3 OriginalPrimaryVector = OriginalSecondBoneTransform.GetTranslation() - OriginalFirstBoneTransform.GetTranslation();
 
 			FHGMVector3 SecondBonePosition {};
-			FHGMSIMDLibrary::Store(Positions[VerticalStructure.SecondBonePackedIndex], ComponentIndex, SecondBonePosition);
+			FHGMSIMDLibrary::Store(ResultPositions[VerticalStructure.SecondBonePackedIndex], ComponentIndex, SecondBonePosition);
 
 			const FHGMVector3 BonePrimaryVector = SecondBonePosition - FirstBonePosition;
 			const FHGMQuaternion BoneQuaternion = FHGMQuaternion::FindBetweenVectors(OriginalPrimaryVector, BonePrimaryVector) * OriginalFirstBoneTransform.GetRotation();
 			FHGMTransform BoneTransform(BoneQuaternion, FirstBonePosition, OriginalFirstBoneTransform.GetScale3D());
 
-			if (PhysicsContext.Alpha < 1.0)
+			if (OutputAlpha < 1.0)
 			{
-				BoneTransform.BlendWith(OriginalFirstBoneTransform, 1.0 - PhysicsContext.Alpha);
+				BoneTransform.BlendWith(OriginalFirstBoneTransform, 1.0 - OutputAlpha);
 			}
 
 			OutBoneTransforms.Add(FBoneTransform(FirstBoneCompactIndex, BoneTransform));
 
 			PrevBoneQuaternions[PackedHorizontalIndex][ComponentIndex] = BoneQuaternion;
+			HasPrevBoneQuaternions[PackedHorizontalIndex][ComponentIndex] = true;
 		}
 	}
 
 	// Tip bone outputs same posture as parent because no pair exists.
-	for (int32 LeafVerticalStructureIndex = VerticalStructures.Num() - SimulationPlane.PackedHorizontalBoneNum; LeafVerticalStructureIndex < VerticalStructures.Num(); ++LeafVerticalStructureIndex)
+	for (int32 LeafVerticalStructureIndex = VerticalStructures.Num() - Template->SimulationPlane.PackedHorizontalBoneNum; LeafVerticalStructureIndex < VerticalStructures.Num(); ++LeafVerticalStructureIndex)
 	{
 		const FHGMSIMDStructure& VerticalStructure = VerticalStructures[LeafVerticalStructureIndex];
-		const int32 PackedHorizontalIndex = LeafVerticalStructureIndex % SimulationPlane.PackedHorizontalBoneNum;
+		const int32 PackedHorizontalIndex = LeafVerticalStructureIndex % Template->SimulationPlane.PackedHorizontalBoneNum;
 
 		TStaticArray<int32, 4> LeafBoneIndexes {};
 		FHGMSIMDLibrary::Store(VerticalStructure.sSecondBoneUnpackedIndex, LeafBoneIndexes);
 		for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
 		{
 			const int32 LeafBoneIndex = LeafBoneIndexes[ComponentIndex];
-			const FBoneReference& LeafBone = Bones[LeafBoneIndex];
-			if (!LeafBone.IsValidToEvaluate())
+			const FCompactPoseBoneIndex& LeafBoneCompactIndex = CompactPoseBoneIndexes[LeafBoneIndex];
+			if (!LeafBoneCompactIndex.IsValid())
 			{
 				continue;
 			}
 
-			const FCompactPoseBoneIndex LeafBoneCompactIndex = LeafBone.GetCompactPoseIndex(BoneContainer);
 			const FHGMTransform& OriginalLeafBoneTransform = Output.Pose.GetComponentSpaceTransform(LeafBoneCompactIndex);
 
 			FHGMVector3 LeafBonePosition {};
-			FHGMSIMDLibrary::Store(Positions[VerticalStructure.SecondBonePackedIndex], ComponentIndex, LeafBonePosition);
+			FHGMSIMDLibrary::Store(ResultPositions[VerticalStructure.SecondBonePackedIndex], ComponentIndex, LeafBonePosition);
 			FHGMTransform BoneTransform(PrevBoneQuaternions[PackedHorizontalIndex][ComponentIndex], LeafBonePosition, OriginalLeafBoneTransform.GetScale3D());
 
-			if (PhysicsContext.Alpha < 1.0)
+			if (OutputAlpha < 1.0)
 			{
-				BoneTransform.BlendWith(OriginalLeafBoneTransform, 1.0 - PhysicsContext.Alpha);
+				BoneTransform.BlendWith(OriginalLeafBoneTransform, 1.0 - OutputAlpha);
 			}
 
 			OutBoneTransforms.Add(FBoneTransform(LeafBoneCompactIndex, BoneTransform));
@@ -1197,6 +2429,22 @@ void FHGMDynamicBoneSolver::OutputSimulateResult(FHGMPhysicsContext& PhysicsCont
 // ---------------------------------------------------------------------------------------
 // SolverLibrary
 // ---------------------------------------------------------------------------------------
+void FHGMScopedScratchMemory::UpdateHighWaterMark(int64 ByteCount)
+{
+	static std::atomic<int64> HighWaterMark = 0;
+
+	int64 CurrentHighWaterMark = HighWaterMark.load(std::memory_order_relaxed);
+	while (ByteCount > CurrentHighWaterMark)
+	{
+		if (HighWaterMark.compare_exchange_weak(CurrentHighWaterMark, ByteCount, std::memory_order_relaxed))
+		{
+			SET_MEMORY_STAT(STAT_SolverScratchMemoryHighWaterMark, ByteCount);
+			break;
+		}
+	}
+}
+
+
 void FHGMSolverLibrary::Transpose(FHGMSimulationPlane& SimulationPlane)
 {
 	const int32 CopiedUnpackedVerticalBoneNum = SimulationPlane.UnpackedVerticalBoneNum;
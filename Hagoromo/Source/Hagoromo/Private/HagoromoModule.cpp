@@ -1,15 +1,18 @@
 // Hagoromo : Copyright (c) 2025 nozoxa_0131, MIT License
 
 #include "HagoromoModule.h"
+#include "HGMAnimation.h"
 
 #include "Misc/ConfigContext.h"
 #include "Misc/ConfigCacheIni.h"
+#include "UObject/UObjectGlobals.h"
 
 DEFINE_LOG_CATEGORY(LogHagoromoRuntime);
 
 FString HGMGlobal::IniFileName {};
 FHGMReal HGMGlobal::TargetFrameRate = 60.0;
 
+DEFINE_STAT(STAT_CollisionBroadphase);
 DEFINE_STAT(STAT_CollisionCalculateBodyColliderContacts);
 DEFINE_STAT(STAT_CollisionCalculateBodyColliderContactsForVerticalEdge);
 DEFINE_STAT(STAT_CollisionCalculateBodyColliderContactsForHorizontalEdge);
@@ -17,6 +20,7 @@ DEFINE_STAT(STAT_CollisionCalculateBodyColliderContactsForHorizontalEdge);
 DEFINE_STAT(STAT_ConstraintVerticalStructuralConstraint);
 DEFINE_STAT(STAT_ConstraintHorizontalStructuralConstraint);
 DEFINE_STAT(STAT_ConstraintShearConstraint);
+DEFINE_STAT(STAT_ConstraintTetherConstraint);
 DEFINE_STAT(STAT_ConstraintVerticalBendConstraint);
 DEFINE_STAT(STAT_ConstraintHorizontalBendConstraint);
 DEFINE_STAT(STAT_ConstraintRelativeLimitAngleConstraint);
@@ -26,12 +30,20 @@ DEFINE_STAT(STAT_ConstraintAnimPosePlanarConstraint);
 
 DEFINE_STAT(STAT_PhysicsApplyForces);
 DEFINE_STAT(STAT_PhysicsVerletIntegrate);
+DEFINE_STAT(STAT_PhysicsIntegrateForces);
 
 DEFINE_STAT(STAT_SolverInitialize);
+DEFINE_STAT(STAT_SolverUpdateRequiredBones);
+DEFINE_STAT(STAT_SolverTemplateInitialize);
 DEFINE_STAT(STAT_SolverPreSimulate);
 DEFINE_STAT(STAT_SolverSimulate);
 DEFINE_STAT(STAT_SolverOutputSimulateResult);
 
+DEFINE_STAT(STAT_SolverSubsteps);
+DEFINE_STAT(STAT_SolverIterations);
+DEFINE_STAT(STAT_SolverIterationLoops);
+DEFINE_STAT(STAT_SolverScratchMemoryHighWaterMark);
+
 #define LOCTEXT_NAMESPACE "FHagoromoModule"
 
 
@@ -47,11 +59,16 @@ void FHagoromoModule::StartupModule()
 		GConfig->GetDouble(TEXT("/Script/Hagoromo.HagoromoSettings"), TEXT("TargetFrameRate"), HGMGlobal::TargetFrameRate, HGMGlobal::IniFileName);
 #endif
 	}
+
+	// Caches shared between nodes are pruned on game thread, where unloaded assets can be resolved safely.
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(&FHGMAnimationLibrary::PruneReferenceSkeletonCaches);
 }
 
 
 void FHagoromoModule::ShutdownModule()
 {
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	PostGarbageCollectHandle.Reset();
 }
 
 
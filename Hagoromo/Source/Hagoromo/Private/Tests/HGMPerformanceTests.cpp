@@ -0,0 +1,271 @@
+// Hagoromo : Copyright (c) 2025 nozoxa_0131, MIT License
+
+#include "Misc/AutomationTest.h"
+#include "HGMPhysics.h"
+#include "HGMConstraints.h"
+#include "HGMCollision.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+// Specify an internal linkage as unnamed space may not work depending on unity build.
+namespace PerformanceTestInternal
+{
+	static constexpr int32 VerticalBoneNum = 12;
+	static constexpr int32 MeasureNum = 2000;
+
+
+	// Chains hang down from row at interval, and bones are placed at interval in each chain.
+	// Bones of first row are fixed like root bones of actual chains.
+	struct FChainGrid
+	{
+		FChainGrid(int32 ChainNum)
+		{
+			SimulationPlane.UnpackedVerticalBoneNum = VerticalBoneNum;
+			SimulationPlane.PackedVerticalBoneNum = VerticalBoneNum;
+			SimulationPlane.UnpackedHorizontalBoneNum = ChainNum;
+			SimulationPlane.PackedHorizontalBoneNum = ChainNum / 4;
+			SimulationPlane.ActualUnpackedHorizontalBoneNum = ChainNum;
+
+			const int32 PackedBoneNum = SimulationPlane.PackedHorizontalBoneNum * VerticalBoneNum;
+			TArray<FHGMSIMDReal> InverseMasses {};
+			TArray<FHGMSIMDReal> FixedBlends {};
+			TArray<FHGMSIMDReal> DummyBoneMasks {};
+			InverseMasses.Init(HGMSIMDConstants::OneReal, PackedBoneNum);
+			FixedBlends.Init(HGMSIMDConstants::ZeroReal, PackedBoneNum);
+			DummyBoneMasks.Init(HGMSIMDConstants::ZeroReal, PackedBoneNum);
+
+			for (int32 PackedIndex = 0; PackedIndex < PackedBoneNum; ++PackedIndex)
+			{
+				const int32 VerticalIndex = PackedIndex / SimulationPlane.PackedHorizontalBoneNum;
+				const int32 FirstChainIndex = (PackedIndex % SimulationPlane.PackedHorizontalBoneNum) * 4;
+
+				TStaticArray<FHGMVector3, 4> BonePositions {};
+				for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
+				{
+					BonePositions[ComponentIndex] = FHGMVector3((FirstChainIndex + ComponentIndex) * 10.0, 0.0, VerticalIndex * -10.0);
+				}
+
+				FHGMSIMDVector3 sPosition {};
+				FHGMSIMDLibrary::Load(sPosition, BonePositions);
+				Positions.Emplace(sPosition);
+
+				if (VerticalIndex == 0)
+				{
+					FixedBlends[PackedIndex] = HGMSIMDConstants::OneReal;
+				}
+			}
+
+			PrevPositions = Positions;
+			AnimPosePositions = Positions;
+			Frictions.Init(HGMSIMDConstants::ZeroReal, PackedBoneNum);
+			FHGMConstraintLibrary::MakeParticleParameters(InverseMasses, FixedBlends, DummyBoneMasks, ParticleParameters);
+		}
+
+		FHGMSimulationPlane SimulationPlane {};
+		TArray<FHGMSIMDVector3> Positions {};
+		TArray<FHGMSIMDVector3> PrevPositions {};
+		TArray<FHGMSIMDVector3> AnimPosePositions {};
+		TArray<FHGMSIMDReal> Frictions {};
+		TArray<FHGMSIMDParticleParameter> ParticleParameters {};
+	};
+
+
+	static FHGMSIMDBoneParameter MakeUniformBoneParameter(FHGMReal Value)
+	{
+		FHGMSIMDBoneParameter BoneParameter {};
+		BoneParameter.Values.Emplace(FHGMSIMDLibrary::LoadConstant(Value));
+		BoneParameter.bIsUniform = true;
+		return BoneParameter;
+	}
+
+
+	// Spheres and capsules scattered around chains, so that part of them is out of reach of each 4 chains.
+	static void MakeBodyCollider(int32 ColliderNum, const FChainGrid& Grid, FHGMBodyCollider& OutBodyCollider)
+	{
+		const FHGMVector3 Min(-50.0, -20.0, -(VerticalBoneNum * 10.0) - 50.0);
+		const FHGMVector3 Max(Grid.SimulationPlane.UnpackedHorizontalBoneNum * 10.0 + 50.0, 20.0, 50.0);
+		const FHGMReal Radius = 8.0;
+
+		FRandomStream RandomStream(ColliderNum);
+		auto RandomPoint = [&]()
+		{
+			return FHGMVector3(RandomStream.FRandRange(Min.X, Max.X), RandomStream.FRandRange(Min.Y, Max.Y), RandomStream.FRandRange(Min.Z, Max.Z));
+		};
+
+		for (int32 ColliderIndex = 0; ColliderIndex < ColliderNum; ++ColliderIndex)
+		{
+			const FHGMVector3 StartPoint = RandomPoint();
+			if (ColliderIndex % 2 == 0)
+			{
+				const FHGMSphereCollider SphereCollider { StartPoint, Radius };
+				OutBodyCollider.SIMDSphereColliders.Emplace(SphereCollider);
+				OutBodyCollider.PrevSIMDSphereColliders.Emplace(SphereCollider);
+				OutBodyCollider.SphereColliderBounds.Add({ StartPoint - FHGMVector3(Radius), StartPoint + FHGMVector3(Radius) });
+			}
+			else
+			{
+				const FHGMVector3 EndPoint = StartPoint + FHGMVector3(20.0, 0.0, 0.0);
+				const FHGMCapsuleCollider CapsuleCollider { StartPoint, EndPoint, Radius };
+				OutBodyCollider.SIMDCapsuleColliders.Emplace(CapsuleCollider);
+				OutBodyCollider.PrevSIMDCapsuleColliders.Emplace(CapsuleCollider);
+				OutBodyCollider.CapsuleColliderBounds.Add({ StartPoint.ComponentMin(EndPoint) - FHGMVector3(Radius), StartPoint.ComponentMax(EndPoint) + FHGMVector3(Radius) });
+			}
+		}
+	}
+
+
+	// Average time of one call in microseconds.
+	template<typename FunctionType>
+	static double MeasureMicroseconds(FunctionType&& Function)
+	{
+		// Warm up caches before measurement.
+		Function();
+
+		const double StartSeconds = FPlatformTime::Seconds();
+		for (int32 Count = 0; Count < MeasureNum; ++Count)
+		{
+			Function();
+		}
+
+		return (FPlatformTime::Seconds() - StartSeconds) * 1000000.0 / MeasureNum;
+	}
+
+
+	static bool IsNearlyEqual(TConstArrayView<FHGMSIMDVector3> A, TConstArrayView<FHGMSIMDVector3> B, FHGMReal Tolerance)
+	{
+		for (int32 PackedIndex = 0; PackedIndex < A.Num(); ++PackedIndex)
+		{
+			TStaticArray<FHGMVector3, 4> VectorsA {};
+			TStaticArray<FHGMVector3, 4> VectorsB {};
+			FHGMSIMDLibrary::Store(A[PackedIndex], VectorsA);
+			FHGMSIMDLibrary::Store(B[PackedIndex], VectorsB);
+			for (int32 ComponentIndex = 0; ComponentIndex < 4; ++ComponentIndex)
+			{
+				if (!VectorsA[ComponentIndex].Equals(VectorsB[ComponentIndex], Tolerance))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+}
+
+
+// Fused IntegrateForces() against ApplyForces(), VerletIntegrate() and FixedBlendConstraint() in separate passes.
+// Results of both must match, since fusion only changes order of memory access.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHGMIntegrateForcesPerformanceTest, "Hagoromo.Performance.IntegrateForces", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FHGMIntegrateForcesPerformanceTest::RunTest(const FString& Parameters)
+{
+	using namespace PerformanceTestInternal;
+
+	// Output is read only by bone space gravity, which is not used here.
+	FComponentSpacePoseContext Output(nullptr);
+	FHGMPhysicsContext PhysicsContext {};
+	const FHGMSIMDBoneParameter Dampings = MakeUniformBoneParameter(0.0);
+	const FHGMSIMDBoneParameter MasterDampings = MakeUniformBoneParameter(0.1);
+
+	for (const int32 ChainNum : { 16, 64, 256 })
+	{
+		FChainGrid SeparateGrid(ChainNum);
+		FChainGrid FusedGrid(ChainNum);
+
+		auto IntegrateSeparately = [&]()
+		{
+			FHGMPhysicsLibrary::ApplyForces(Output, PhysicsContext, SeparateGrid.Positions, SeparateGrid.PrevPositions, Dampings, Dampings, Dampings, Dampings, MasterDampings, SeparateGrid.Frictions, SeparateGrid.ParticleParameters);
+			FHGMPhysicsLibrary::VerletIntegrate(PhysicsContext, SeparateGrid.Positions, SeparateGrid.PrevPositions, SeparateGrid.Frictions, MasterDampings, SeparateGrid.ParticleParameters);
+			FHGMConstraintLibrary::FixedBlendConstraint(SeparateGrid.Positions, SeparateGrid.PrevPositions, SeparateGrid.AnimPosePositions, SeparateGrid.ParticleParameters);
+		};
+
+		auto IntegrateFused = [&]()
+		{
+			FHGMPhysicsLibrary::IntegrateForces(Output, PhysicsContext, FusedGrid.Positions, FusedGrid.PrevPositions, FusedGrid.AnimPosePositions, Dampings, Dampings, Dampings, Dampings, MasterDampings, FusedGrid.Frictions, FusedGrid.ParticleParameters);
+		};
+
+		// Compared after single step, since rounding of both differs slightly and accumulates over steps.
+		IntegrateSeparately();
+		IntegrateFused();
+		TestTrue(FString::Printf(TEXT("%d chains : Positions of fused pass match separate passes"), ChainNum), IsNearlyEqual(FusedGrid.Positions, SeparateGrid.Positions, 0.001));
+		TestTrue(FString::Printf(TEXT("%d chains : PrevPositions of fused pass match separate passes"), ChainNum), IsNearlyEqual(FusedGrid.PrevPositions, SeparateGrid.PrevPositions, 0.001));
+
+		const double SeparateMicroseconds = MeasureMicroseconds(IntegrateSeparately);
+		const double FusedMicroseconds = MeasureMicroseconds(IntegrateFused);
+		AddInfo(FString::Printf(TEXT("%d chains x %d bones : Separate %.3f us, Fused %.3f us ( x%.2f )"), ChainNum, VerticalBoneNum, SeparateMicroseconds, FusedMicroseconds, SeparateMicroseconds / FMath::Max(FusedMicroseconds, UE_DOUBLE_SMALL_NUMBER)));
+	}
+
+	return true;
+}
+
+
+// Body collider contacts with and without broadphase, and contacts of vertical and horizontal edges, by number of colliders.
+// Broadphase only culls pairs that cannot collide, so number of contacts must not change.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHGMBodyColliderContactsPerformanceTest, "Hagoromo.Performance.BodyColliderContacts", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FHGMBodyColliderContactsPerformanceTest::RunTest(const FString& Parameters)
+{
+	using namespace PerformanceTestInternal;
+
+	IConsoleVariable* CVarColliderBroadphase = IConsoleManager::Get().FindConsoleVariable(TEXT("p.Hagoromo.ColliderBroadphase"));
+	if (!TestNotNull(TEXT("p.Hagoromo.ColliderBroadphase is registered"), CVarColliderBroadphase))
+	{
+		return false;
+	}
+	const int32 OriginalColliderBroadphase = CVarColliderBroadphase->GetInt();
+
+	FChainGrid Grid(16);
+	const FHGMSIMDBoneParameter BoneSphereColliderRadiuses = MakeUniformBoneParameter(2.0);
+	const FHGMSIMDReal sContactMargin = FHGMSIMDLibrary::LoadConstant(1.0);
+
+	TArray<FHGMSIMDStructure> VerticalStructures {};
+	FHGMConstraintLibrary::MakeVerticalStructure(Grid.SimulationPlane, Grid.Positions, VerticalStructures);
+
+	TArray<FHGMSIMDColliderContact> Contacts {};
+	for (const int32 ColliderNum : { 4, 16, 64 })
+	{
+		FHGMBodyCollider BodyCollider {};
+		MakeBodyCollider(ColliderNum, Grid, BodyCollider);
+
+		auto CalculateBodyColliderContacts = [&]()
+		{
+			Contacts.Reset();
+			FHGMCollisionLibrary::CalculateBodyColliderContacts(Grid.SimulationPlane, BoneSphereColliderRadiuses, Grid.ParticleParameters, Grid.Positions, Grid.PrevPositions, BodyCollider, sContactMargin, Contacts);
+		};
+
+		CVarColliderBroadphase->Set(0, ECVF_SetByCode);
+		CalculateBodyColliderContacts();
+		const int32 ContactNumWithoutBroadphase = Contacts.Num();
+		const double WithoutBroadphaseMicroseconds = MeasureMicroseconds(CalculateBodyColliderContacts);
+
+		CVarColliderBroadphase->Set(1, ECVF_SetByCode);
+		CalculateBodyColliderContacts();
+		const int32 ContactNumWithBroadphase = Contacts.Num();
+		const double WithBroadphaseMicroseconds = MeasureMicroseconds(CalculateBodyColliderContacts);
+
+		TestEqual(FString::Printf(TEXT("%d colliders : Number of contacts with broadphase"), ColliderNum), ContactNumWithBroadphase, ContactNumWithoutBroadphase);
+
+		const double VerticalEdgeMicroseconds = MeasureMicroseconds([&]()
+		{
+			Contacts.Reset();
+			FHGMCollisionLibrary::CalculateBodyColliderContactsForVerticalEdge(VerticalStructures, Grid.Positions, BodyCollider, sContactMargin, Contacts);
+		});
+
+		const double HorizontalEdgeMicroseconds = MeasureMicroseconds([&]()
+		{
+			Contacts.Reset();
+			FHGMCollisionLibrary::CalculateBodyColliderContactsForHorizontalEdge(Grid.SimulationPlane, false, Grid.Positions, BodyCollider, sContactMargin, Contacts);
+		});
+
+		AddInfo(FString::Printf(TEXT("%d colliders : Broadphase off %.3f us, on %.3f us ( x%.2f ), %d contacts"),
+								ColliderNum, WithoutBroadphaseMicroseconds, WithBroadphaseMicroseconds, WithoutBroadphaseMicroseconds / FMath::Max(WithBroadphaseMicroseconds, UE_DOUBLE_SMALL_NUMBER), ContactNumWithBroadphase));
+		AddInfo(FString::Printf(TEXT("%d colliders : Vertical edges %.3f us, Horizontal edges %.3f us"), ColliderNum, VerticalEdgeMicroseconds, HorizontalEdgeMicroseconds));
+	}
+
+	CVarColliderBroadphase->Set(OriginalColliderBroadphase, ECVF_SetByCode);
+
+	return true;
+}
+
+#endif
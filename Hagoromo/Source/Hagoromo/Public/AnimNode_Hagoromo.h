@@ -13,9 +13,13 @@
 #include "BonePose.h"
 #include "BoneControllers/AnimNode_SkeletalControlBase.h"
 #include "Animation/AnimInstanceProxy.h"
+#include "Tasks/Task.h"
 
 #include "AnimNode_Hagoromo.generated.h"
 
+class UHagoromoSolverData;
+class UHagoromoDistanceFieldData;
+
 
 USTRUCT(BlueprintType)
 struct HAGOROMO_API FAnimNode_Hagoromo : public FAnimNode_SkeletalControlBase
@@ -40,18 +44,22 @@ public:
 
 	/**
 	* 物理シミュレーションの対象にするチェーンの設定です。
+	* ソルバーデータを指定している場合は編集できず、ソルバーデータの設定が使用されます。
 	*
 	* This is setting of chain to be included in physics simulation.
+	* Not editable while solver data is set, since settings of solver data are used.
 	*/
-	UPROPERTY(EditDefaultsOnly, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Chain Settings", TitleProperty = "RootBone", DisplayPriority = "1"))
+	UPROPERTY(EditDefaultsOnly, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Chain Settings", TitleProperty = "RootBone", DisplayPriority = "1", EditCondition = "SolverData == nullptr"))
 	TArray<FHGMChainSetting> ChainSettings {};
 
 	/**
 	* 物理挙動を調整するためのパラメータです。
+	* ソルバーデータを指定している場合は編集できず、ソルバーデータの設定が使用されます。
 	*
 	* Parameters to adjust physical behavior.
+	* Not editable while solver data is set, since settings of solver data are used.
 	*/
-	UPROPERTY(EditDefaultsOnly, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo General Settings", DisplayPriority = "2"))
+	UPROPERTY(EditDefaultsOnly, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo General Settings", DisplayPriority = "2", EditCondition = "SolverData == nullptr"))
 	FHGMPhysicsSettings PhysicsSettings {};
 
 	/**
@@ -84,6 +92,30 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Animation Curve Number", UIMin = 0, ClampMin = 0, DisplayPriority = "0"))
 	int32 AnimationCurveNumber = 0;
 
+	/**
+	* エディタで構築済みのソルバーデータです。
+	* 指定した場合、チェーンの設定と物理挙動のパラメータはノードではなく当該アセットのものが使用されます。
+	* メッシュとスケルトンが一致する場合、実行時のソルバー構築が省略されます。
+	*
+	* Solver data built in editor.
+	* When set, chain settings and physics parameters of the asset are used instead of those of node.
+	* When mesh and its skeleton match, building solver at runtime is skipped.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Solver Data", DisplayPriority = "5"))
+	TObjectPtr<UHagoromoSolverData> SolverData = nullptr;
+
+	/**
+	* ボディコライダの物理アセットからエディタで構築済みの距離場データです。
+	* 距離場を持つボディとボーンのスフィアは、スフィアとカプセルの代わりに距離場で衝突判定を行います。
+	* エッジの衝突判定には引き続きスフィアとカプセルが使用されます。
+	*
+	* Distance field data built in editor from physics asset of body collider.
+	* Bone spheres collide with bodies that have distance field by distance field instead of spheres and capsules.
+	* Edges still collide with their spheres and capsules.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Distance Field For Body Collider", DisplayPriority = "6"))
+	TObjectPtr<UHagoromoDistanceFieldData> DistanceFieldForBodyCollider = nullptr;
+
 	FHGMPhysicsContext PhysicsContext {};
 
 	FHGMDynamicBoneSolver* Solver = nullptr;
@@ -94,8 +126,14 @@ public:
 	TArray<FHGMSIMDPlaneCollider> PlaneColliders {};
 
 private:
+	// Initialize solver according to p.Hagoromo.InitializationMode. Returns whether solver is ready to simulate.
+	bool UpdateInitialization(FComponentSpacePoseContext& Output);
+
 	bool bShouldInitialize = true;
 
+	// Solver template being built on background task. Animation pose passes through until it completes.
+	UE::Tasks::TTask<TSharedPtr<const FHGMSolverTemplate>> SolverTemplateTask {};
+
 #if ENABLE_ANIM_DRAW_DEBUG
 	void AnimDrawDebugHagoromo(FComponentSpacePoseContext& Output);
 #endif
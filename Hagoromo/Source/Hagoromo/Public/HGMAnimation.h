@@ -21,8 +21,38 @@ namespace HGMAnimationConstants
 }
 
 
+// Hierarchy and bind pose of reference skeleton, computed once and shared by all nodes using same asset.
+// Note: Index is bone index of reference skeleton.
+struct FHGMReferenceSkeletonCache
+{
+	FORCEINLINE TConstArrayView<int32> GetDirectChildBoneIndexes(int32 BoneIndex) const
+	{
+		const int32 ChildBoneIndexOffset = ChildBoneIndexOffsets[BoneIndex];
+		return TConstArrayView<int32>(ChildBoneIndexes.GetData() + ChildBoneIndexOffset, ChildBoneIndexOffsets[BoneIndex + 1] - ChildBoneIndexOffset);
+	}
+
+	// Children of BoneIndex are ChildBoneIndexes[ChildBoneIndexOffsets[BoneIndex]] to ChildBoneIndexes[ChildBoneIndexOffsets[BoneIndex + 1] - 1].
+	TArray<int32> ChildBoneIndexOffsets {};
+	TArray<int32> ChildBoneIndexes {};
+
+	TArray<FHGMTransform> ComponentSpaceRefTransforms {};
+
+	// Content hash of reference skeleton the cache was built from. ( See FHGMAnimationLibrary::HashReferenceSkeleton() )
+	uint64 RefSkeletonHash = 0;
+};
+
+
 struct FHGMAnimationLibrary
 {
+	// Returns cache of reference skeleton of BoneContainer, building it on first request.
+	static TSharedPtr<const FHGMReferenceSkeletonCache> FindOrCreateReferenceSkeletonCache(const FBoneContainer& BoneContainer);
+
+	// Removes caches of unloaded assets. Must be called on game thread. ( Called after garbage collection. )
+	static void PruneReferenceSkeletonCaches();
+
+	// Hash of bone names, hierarchy and reference pose. Same across sessions, so that it can also be stored in cooked data.
+	static uint64 HashReferenceSkeleton(const FReferenceSkeleton& RefSkeleton);
+
 	// Returns Bind Pose of component space.
 	FORCEINLINE static FHGMTransform GetComponentSpaceRefTransform(const FBoneContainer& BoneContainer, const FCompactPoseBoneIndex& CompactPoseBoneIndex)
 	{
@@ -9,17 +9,22 @@
 #include "HGMCollision.generated.h"
 
 class UPhysicsAsset;
+class UHagoromoDistanceFieldData;
+struct FKAggregateGeom;
 struct FHGMPhysicsContext;
 struct FHGMPhysicsSettings;
 struct FHGMSIMDStructure;
+struct FHGMSIMDParticleParameter;
 struct FHGMSimulationPlane;
 struct FComponentSpacePoseContext;
 
+// bEdgeOnly is set for shapes of body that has distance field. Bone spheres collide by distance field instead, but edges have no test against it.
 struct FHGMBoneSpaceSphereCollider
 {
 	FBoneReference DriverBone {};
 	FHGMVector3 Center { FHGMVector3::ZeroVector };
 	FHGMReal Radius { 0.0 };
+	bool bEdgeOnly = false;
 };
 
 
@@ -29,6 +34,29 @@ struct FHGMBoneSpaceCapsuleCollider
 	FHGMVector3 StartPoint { FHGMVector3::ZeroVector };
 	FHGMVector3 EndPoint { FHGMVector3::ZeroVector };
 	FHGMReal Radius { 0.0 };
+	bool bEdgeOnly = false;
+};
+
+
+// Signed distance to shapes of one body, sampled on grid in bone space.
+// Note: Distance of voxel (X, Y, Z) is stored in Distances[(Z * Resolution.Y + Y) * Resolution.X + X].
+struct FHGMDistanceField
+{
+	void Serialize(FArchive& Ar);
+
+	FName BoneName {};
+	// Bone space position of voxel (0, 0, 0).
+	FHGMVector3 Origin { FHGMVector3::ZeroVector };
+	FHGMReal VoxelSize { 1.0 };
+	FIntVector Resolution { FIntVector::ZeroValue };
+	TArray<float> Distances {};
+};
+
+
+struct FHGMBoneSpaceDistanceFieldCollider
+{
+	FBoneReference DriverBone {};
+	TSharedPtr<const FHGMDistanceField> DistanceField {};
 };
 
 
@@ -49,6 +77,14 @@ struct FHGMCapsuleCollider
 };
 
 
+struct FHGMDistanceFieldCollider
+{
+	// Transform from bone space of distance field to component space.
+	FHGMTransform Transform { FHGMTransform::Identity };
+	bool bEnabled = true;
+};
+
+
 struct FHGMSIMDSphereCollider
 {
 	FHGMSIMDSphereCollider()
@@ -98,6 +134,29 @@ struct FHGMSIMDCapsuleCollider
 };
 
 
+struct FHGMSIMDDistanceFieldCollider
+{
+	FHGMSIMDDistanceFieldCollider()
+	{
+	}
+
+	FHGMSIMDDistanceFieldCollider(const FHGMDistanceFieldCollider& DistanceFieldCollider, const FHGMDistanceField& DistanceField)
+		: DistanceField(&DistanceField)
+	{
+		FHGMSIMDLibrary::Load(this->sTransform, DistanceFieldCollider.Transform);
+		FHGMSIMDLibrary::Load(this->sOrigin, DistanceField.Origin);
+		FHGMSIMDLibrary::Load(this->sMaxGridPosition, FHGMVector3(DistanceField.Resolution - FIntVector(1)));
+		FHGMSIMDLibrary::Load(this->sInverseVoxelSize, 1.0 / DistanceField.VoxelSize);
+	}
+
+	FHGMSIMDTransform sTransform {};
+	FHGMSIMDVector3 sOrigin = FHGMSIMDVector3::ZeroVector;
+	FHGMSIMDVector3 sMaxGridPosition = FHGMSIMDVector3::ZeroVector;
+	FHGMSIMDReal sInverseVoxelSize = HGMSIMDConstants::ZeroReal;
+	const FHGMDistanceField* DistanceField = nullptr;
+};
+
+
 USTRUCT()
 struct FHGMPlaneCollider
 {
@@ -121,12 +180,36 @@ struct FHGMSIMDPlaneCollider
 };
 
 
+// Bounds of collider swept from previous frame, used by broadphase.
+struct FHGMColliderBounds
+{
+	FHGMVector3 Min { FHGMVector3::ZeroVector };
+	FHGMVector3 Max { FHGMVector3::ZeroVector };
+};
+
+
 struct FHGMBodyCollider
 {
 	TArray<FHGMBoneSpaceSphereCollider> BoneSpaceSphereColliders {};
 	TArray<FHGMBoneSpaceCapsuleCollider> BoneSpaceCapsuleColliders {};
+	TArray<FHGMBoneSpaceDistanceFieldCollider> BoneSpaceDistanceFieldColliders {};
 	TArray<FHGMSphereCollider> SphereColliders {};
 	TArray<FHGMCapsuleCollider> CapsuleColliders {};
+	TArray<FHGMDistanceFieldCollider> DistanceFieldColliders {};
+
+	// Enabled colliders of current and previous frame broadcast to registers once per frame for narrowphase.
+	// Note: Disabled colliders are removed, so index differs from SphereColliders, CapsuleColliders and DistanceFieldColliders.
+	// Note: Edge only colliders are appended after others without previous state and bounds.
+	//       Narrowphase of bone spheres only visits colliders that have bounds, while edges visit all colliders.
+	TArray<FHGMSIMDSphereCollider> SIMDSphereColliders {};
+	TArray<FHGMSIMDSphereCollider> PrevSIMDSphereColliders {};
+	TArray<FHGMColliderBounds> SphereColliderBounds {};
+	TArray<FHGMSIMDCapsuleCollider> SIMDCapsuleColliders {};
+	TArray<FHGMSIMDCapsuleCollider> PrevSIMDCapsuleColliders {};
+	TArray<FHGMColliderBounds> CapsuleColliderBounds {};
+	// Distance field is tested only at current position, so it has no previous state.
+	TArray<FHGMSIMDDistanceFieldCollider> SIMDDistanceFieldColliders {};
+	TArray<FHGMColliderBounds> DistanceFieldColliderBounds {};
 };
 
 
@@ -135,11 +218,16 @@ struct FHGMSIMDColliderContact
 {
 	int32 PackedIndex;
 	// Added to determine which bones to apply friction to.
+	// Note: Not set for components that are only within contact margin, since they are not touching yet.
+	//       Updated to current side of plane while speculative contact is reused.
 	FHGMSIMDReal sHitMask;
 	// Stores values that work without HitMask to reduce computational load by SIMD.
 	// For example, collision-free register stores ZeroVector, ZeroReal.
 	FHGMSIMDVector3 sSeparatingNormal;
 	FHGMSIMDReal sSeparatingOffset;
+	// Signed distance to separating plane at detection. ( Negative when penetrating. )
+	// Used to find bones that crossed plane of speculative contact while it is reused.
+	FHGMSIMDReal sDetectionSeparation;
 };
 
 
@@ -148,13 +236,20 @@ struct FHGMSIMDColliderContact
 // ---------------------------------------------------------------------------------------
 struct FHGMCollisionLibrary
 {
-	static void InitializeBodyColliderFromPhysicsAsset(const FBoneContainer& RequiredBones, UPhysicsAsset* PhysicsAsset, FHGMBodyCollider& OutBodyCollider);
+	static void InitializeBodyColliderFromPhysicsAsset(const FBoneContainer& RequiredBones, UPhysicsAsset* PhysicsAsset, const UHagoromoDistanceFieldData* DistanceFieldData, FHGMBodyCollider& OutBodyCollider);
+	static bool BuildDistanceField(FName BoneName, const FKAggregateGeom& AggGeom, FHGMReal VoxelSize, FHGMReal Padding, int32 MaxResolution, FHGMDistanceField& OutDistanceField);
+	static void UpdateBodyColliderRequiredBones(const FBoneContainer& RequiredBones, FHGMBodyCollider& BodyCollider);
 	static void UpdateBodyCollider(FComponentSpacePoseContext& Output, const FHGMPhysicsContext& PhysicsContext, FHGMBodyCollider& BodyCollider, FHGMBodyCollider& PrevBodyCollider);
-	static void CalculateBodyColliderContacts(TConstArrayView<FHGMSIMDReal> BoneSphereColliderRadiuses, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, const FHGMBodyCollider& BodyCollider, const FHGMBodyCollider& PrevBodyCollider, TArray<FHGMSIMDColliderContact>& OutContacts);
-	static void CalculateBodyColliderContactsForVerticalEdge(TConstArrayView<FHGMSIMDStructure> VerticalStructures, TArrayView<FHGMSIMDVector3> Positions, const FHGMBodyCollider& BodyCollider, TArray<FHGMSIMDColliderContact>& OutContacts);
-	static void CalculateBodyColliderContactsForHorizontalEdge(FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDStructure> HorizontalStructures, TArray<FHGMSIMDVector3>& Positions, const FHGMBodyCollider& BodyCollider, TArray<FHGMSIMDColliderContact>& OutContacts);
+	static void CalculateBodyColliderContacts(const FHGMSimulationPlane& SimulationPlane, const FHGMSIMDBoneParameter& BoneSphereColliderRadiuses, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, const FHGMBodyCollider& BodyCollider, const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDColliderContact>& OutContacts);
+	static void CalculateBodyColliderContactsForVerticalEdge(TConstArrayView<FHGMSIMDStructure> VerticalStructures, TArrayView<FHGMSIMDVector3> Positions, const FHGMBodyCollider& BodyCollider, const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDColliderContact>& OutContacts);
+	static void CalculateBodyColliderContactsForHorizontalEdge(const FHGMSimulationPlane& SimulationPlane, bool bLoopHorizontalStructure, TConstArrayView<FHGMSIMDVector3> Positions, const FHGMBodyCollider& BodyCollider, const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDColliderContact>& OutContacts);
+
+	// Side of separating plane is tracked per contact while speculative contacts are reused.
+	static void StoreContactSides(TArrayView<FHGMSIMDColliderContact> Contacts, TConstArrayView<FHGMSIMDVector3> Positions);
+	// Updates HitMask to side bones are on now, and returns whether some bone crossed plane from separated side by more than contact margin.
+	static bool UpdateContactSides(TArrayView<FHGMSIMDColliderContact> Contacts, TConstArrayView<FHGMSIMDVector3> Positions, const FHGMSIMDReal& sContactMargin);
 
 	static void InitializePlaneColliders(const FBoneContainer& RequiredBones, TArrayView<FHGMPlaneCollider> PlaneColliders, TArray<FHGMSIMDPlaneCollider>& OutPlaneColliders);
 	static void UpdatePlaneColliders(FComponentSpacePoseContext& Output, TConstArrayView<FHGMPlaneCollider> PlaneColliders, TArrayView<FHGMSIMDPlaneCollider> OutUpdatedPlaneColliders);
-	static void CalculatePlaneColliderContacts(TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders, TConstArrayView<FHGMSIMDReal> BoneSphereColliderRadiuses, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDColliderContact>& OutContacts);
+	static void CalculatePlaneColliderContacts(TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders, const FHGMSIMDBoneParameter& BoneSphereColliderRadiuses, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters, TArray<FHGMSIMDVector3>& Positions, const FHGMSIMDReal& sContactMargin, TArray<FHGMSIMDColliderContact>& OutContacts);
 };
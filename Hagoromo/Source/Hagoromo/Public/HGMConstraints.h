@@ -10,6 +10,7 @@ struct FHGMSimulationPlane;
 struct FHGMSIMDRelativeLimitAngle;
 struct FHGMSIMDAnimPoseConstraintMovableRadius;
 struct FHGMSIMDAnimPoseConstraintLimitAngle;
+struct FHGMSIMDTether;
 struct FComponentSpacePoseContext;
 
 
@@ -24,8 +25,16 @@ struct FHGMSIMDStructure
 };
 
 
+// Diagonal link between adjacent chains.
+// The bone on the right chain is read by shifting components of PackedIndex and NextPackedIndex one to the left.
+// NextPackedIndex is -1 for the bone on the left chain, and both packed indexes are -1 when shift can not be used. ( Gathered by unpacked index. )
 struct FHGMSIMDShearStructure
 {
+	int32 FirstBonePackedIndex = -1;
+	int32 FirstBoneNextPackedIndex = -1;
+	int32 SecondBonePackedIndex = -1;
+	int32 SecondBoneNextPackedIndex = -1;
+	FHGMSIMDReal sActiveMask = HGMSIMDConstants::AllBitMask;
 	FHGMSIMDInt sFirstBoneUnpackedIndex = HGMSIMDConstants::MinusOneInt;
 	FHGMSIMDInt sSecondBoneUnpackedIndex = HGMSIMDConstants::MinusOneInt;
 	FHGMSIMDReal sLength = HGMSIMDConstants::OneReal;
@@ -33,11 +42,25 @@ struct FHGMSIMDShearStructure
 };
 
 
+// Per-bone parameters read by integration, constraints and contacts, packed into one block per packed bone.
+// Cold parameters such as frictions and dampings stay in separated arrays.
+// Note: Four FHGMSIMDReal fill one cache line with float, and two cache lines with double.
+struct alignas(64) FHGMSIMDParticleParameter
+{
+	FHGMSIMDReal sInverseMass = HGMSIMDConstants::OneReal;
+	FHGMSIMDReal sFixedBlend = HGMSIMDConstants::ZeroReal;
+	FHGMSIMDReal sDummyBoneMask = HGMSIMDConstants::ZeroReal;
+
+	// ( 1 - FixedBlend ) * ( 1 - DummyBoneMask ). Both do not change after initialization, so it is computed once.
+	FHGMSIMDReal sMovableWeight = HGMSIMDConstants::OneReal;
+};
+
+
 struct FHGMConstraintLibrary
 {
-	static void FixedBlendConstraint(TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDVector3>& PrevPositions, const TArray<FHGMSIMDVector3>& AnimPositions, const TArray<FHGMSIMDReal>& FixedBlends);
+	static void FixedBlendConstraint(TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDVector3>& PrevPositions, const TArray<FHGMSIMDVector3>& AnimPositions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
-	static void ColliderContactConstraint(const TArray<FHGMSIMDColliderContact>& Contacts, const FHGMSIMDReal& sCollisionBlend, const FHGMSIMDReal& sColliderPenetrationDepth, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks);
+	static void ColliderContactConstraint(const TArray<FHGMSIMDColliderContact>& Contacts, const FHGMSIMDReal& sCollisionBlend, const FHGMSIMDReal& sColliderPenetrationDepth, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
 	// Zero clear lambda used by XPBD.
 	template<typename T>
@@ -49,26 +72,46 @@ struct FHGMConstraintLibrary
 		}
 	}
 
+	// Scale lambda used by XPBD to carry it over to next step. ( Warm Start )
+	template<typename T>
+	FORCEINLINE static void ScaleLambda(TArrayView<T> StructureDataArray, const FHGMSIMDReal& sScale)
+	{
+		for (T& StructureData : StructureDataArray)
+		{
+			StructureData.sLambda *= sScale;
+		}
+	}
+
+	static void MakeParticleParameters(TConstArrayView<FHGMSIMDReal> InverseMasses, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks, TArray<FHGMSIMDParticleParameter>& OutParticleParameters);
+
 	static void MakeVerticalStructure(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDVector3> Positions, TArray<FHGMSIMDStructure>& OutVerticalStructures);
-	static void VerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> InverseMasses, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks);
+	static void VerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
-	static void RigidVerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> FixedBlends);
+	// Solve each vertical chain as tridiagonal system with Thomas algorithm, 4 chains at once.
+	static void DirectVerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, const FHGMSimulationPlane& SimulationPlane, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
+	static void RigidVerticalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
+
+	// Horizontal structures are sorted by color ( even links, odd links, and link closing odd loop ), so adjacent structures do not depend on each other.
 	static void MakeHorizontalStructure(FHGMSimulationPlane& SimulationPlane, TArray<FHGMSIMDVector3>& Positions, bool bLoopHorizontalStructure, TArray<FHGMSIMDStructure>& OutHorizontalStructures);
-	static void HorizontalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, FHGMSimulationPlane& SimulationPlane, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDReal>& InverseMasses, TArray<FHGMSIMDReal>& FixedBlends, TArray<FHGMSIMDReal>& DummyBoneMasks);
+	static void HorizontalStructuralConstraint(TArrayView<FHGMSIMDStructure> Structures, FHGMPhysicsContext& PhysicsContext, const FHGMSimulationPlane& SimulationPlane, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> HorizontalPositions, TConstArrayView<FHGMSIMDParticleParameter> HorizontalParticleParameters);
 
+	// Shear structures are sorted by color ( diagonal direction x row parity ), so structures of same color never share a bone.
 	static void MakeShearStructure(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDVector3> Positions, bool bLoopHorizontalStructure, TArray<FHGMSIMDShearStructure>& OutShearStructures);
-	static void ShearConstraint(TArrayView<FHGMSIMDShearStructure> Shears, FHGMPhysicsContext& PhysicsContext, const FHGMSimulationPlane& SimulationPlane, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> InverseMasses, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks);
+	static void ShearConstraint(TArrayView<FHGMSIMDShearStructure> Shears, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
+
+	static void MakeTetherStructure(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDStructure> VerticalStructures, TConstArrayView<FHGMSIMDReal> TetherCompliances, TArray<FHGMSIMDTether>& OutTethers);
+	static void TetherConstraint(TArrayView<FHGMSIMDTether> Tethers, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
 	static void MakeVerticalBendStructure(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDVector3> Positions, TArray<FHGMSIMDStructure>& OutVerticalBendStructures);
-	static void VerticalBendConstraint(TArrayView<FHGMSIMDStructure> BendStructures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDReal> InverseMasses, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks);
+	static void VerticalBendConstraint(TArrayView<FHGMSIMDStructure> BendStructures, FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
 	static void MakeHorizontalBendStructure(FHGMSimulationPlane& SimulationPlane, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDStructure>& OutHorizontalBendStructures);
-	static void HorizontalBendConstraint(TArrayView<FHGMSIMDStructure> HorizontalBendStructures, FHGMPhysicsContext& PhysicsContext, FHGMSimulationPlane& SimulationPlane, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDReal>& InverseMasses, TArray<FHGMSIMDReal>& FixedBlends, TArray<FHGMSIMDReal>& DummyBoneMasks);
+	static void HorizontalBendConstraint(TArrayView<FHGMSIMDStructure> HorizontalBendStructures, FHGMPhysicsContext& PhysicsContext, const FHGMSimulationPlane& SimulationPlane, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> HorizontalPositions, TConstArrayView<FHGMSIMDParticleParameter> HorizontalParticleParameters);
 
-	static void RelativeLimitAngleConstraint(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDStructure> VerticalStructures, TConstArrayView<FHGMSIMDRelativeLimitAngle> RelativeLimitAngles, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArray<FHGMSIMDVector3>& Positions, TConstArrayView<FHGMSIMDReal> DummyBoneMasks);
+	static void RelativeLimitAngleConstraint(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<FHGMSIMDStructure> VerticalStructures, TConstArrayView<FHGMSIMDRelativeLimitAngle> RelativeLimitAngles, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArray<FHGMSIMDVector3>& Positions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
 	static void AnimPoseMovableRadiusConstraint(TConstArrayView<FHGMSIMDAnimPoseConstraintMovableRadius> MovableRadiuses, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArrayView<FHGMSIMDVector3> Positions);
 	static void AnimPoseLimitAngleConstraint(TConstArrayView<FHGMSIMDStructure> VerticalStructures, TConstArrayView<FHGMSIMDAnimPoseConstraintLimitAngle> LimitAngles, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArrayView<FHGMSIMDVector3> Positions);
-	static void AnimPosePlanarConstraint(TConstArrayView<FHGMSIMDInt> PlanarConstraintAxes, TConstArrayView<FHGMSIMDStructure> VerticalStructures, const FHGMSimulationPlane& SimulationPlane, FComponentSpacePoseContext& Output, TArrayView<FBoneReference> Bones, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArrayView<FHGMSIMDVector3> Positions);
+	static void AnimPosePlanarConstraint(TConstArrayView<FHGMSIMDInt> PlanarConstraintAxes, TConstArrayView<FHGMSIMDStructure> VerticalStructures, const FHGMSimulationPlane& SimulationPlane, FComponentSpacePoseContext& Output, TConstArrayView<FCompactPoseBoneIndex> CompactPoseBoneIndexes, TConstArrayView<FHGMSIMDVector3> AnimPosePositions, TArrayView<FHGMSIMDVector3> Positions);
 };
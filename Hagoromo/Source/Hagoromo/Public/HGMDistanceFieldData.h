@@ -0,0 +1,81 @@
+// Hagoromo : Copyright (c) 2025 nozoxa_0131, MIT License
+
+#pragma once
+
+#include "HGMCollision.h"
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "UObject/ObjectSaveContext.h"
+
+#include "HGMDistanceFieldData.generated.h"
+
+class UPhysicsAsset;
+
+
+// Signed distance fields of bodies of physics asset, baked in editor and saved with asset.
+// Body collider tests bone spheres against distance field of body instead of its shapes.
+UCLASS(BlueprintType)
+class HAGOROMO_API UHagoromoDistanceFieldData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// UObject interface
+	virtual void Serialize(FArchive& Ar) override;
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	// End of UObject interface
+
+	TSharedPtr<const FHGMDistanceField> FindDistanceField(FName BoneName) const;
+
+#if WITH_EDITOR
+	// Bake distance field of every body of PhysicsAsset from its sphere, capsule and box shapes.
+	bool BuildDistanceFields();
+#endif
+
+	/**
+	* 距離場を構築する対象の物理アセットです。
+	* アニメーションノードのボディコライダーと同じ物理アセットを指定してください。
+	*
+	* Physics asset that distance fields are built for.
+	* Specify same physics asset as body collider of anim node.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Physics Asset", DisplayPriority = "0"))
+	TObjectPtr<UPhysicsAsset> PhysicsAsset = nullptr;
+
+	/**
+	* ボクセルの大きさです。(cm)
+	* 小さいほど形状を正確に表現しますが、メモリを消費します。
+	*
+	* Size of voxel. (cm)
+	* Smaller value represents shapes more accurately, but consumes more memory.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Voxel Size", ClampMin = "0.1", DisplayPriority = "1"))
+	double VoxelSize = 1.0;
+
+	/**
+	* 形状の周囲に確保する余白です。(cm)
+	* ボーンのスフィアコライダーの半径より大きくしてください。
+	*
+	* Padding around shapes. (cm)
+	* Set it larger than radius of bone sphere collider.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Padding", ClampMin = "0.0", DisplayPriority = "2"))
+	double Padding = 4.0;
+
+	/**
+	* 各軸の最大ボクセル数です。
+	* 超える場合はボクセルが大きくなります。
+	*
+	* Maximum number of voxels on each axis.
+	* Voxel is enlarged when it is exceeded.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Max Resolution", ClampMin = "2", ClampMax = "128", DisplayPriority = "3"))
+	int32 MaxResolution = 32;
+
+private:
+	TArray<TSharedPtr<FHGMDistanceField>> DistanceFields {};
+};
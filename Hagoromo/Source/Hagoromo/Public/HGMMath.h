@@ -615,6 +615,26 @@ struct FHGMSIMDIndex
 };
 
 
+// Per-bone parameter packed in 4-element units.
+// When every bone has same value, only single register is stored and shared by all bones.
+struct FHGMSIMDBoneParameter
+{
+	FORCEINLINE const FHGMSIMDReal& operator[](int32 PackedIndex) const
+	{
+		return Values[bIsUniform ? 0 : PackedIndex];
+	}
+
+	// Index is not checked against number of bones, so caller must know the parameter is uniform.
+	FORCEINLINE const FHGMSIMDReal& GetUniformValue() const
+	{
+		return Values[0];
+	}
+
+	TArray<FHGMSIMDReal> Values {};
+	bool bIsUniform = false;
+};
+
+
 struct HAGOROMO_API FHGMSIMDLibrary
 {
 	// Memory --> Register.
@@ -849,6 +869,29 @@ struct HAGOROMO_API FHGMSIMDLibrary
 		return FHGMSIMDLibrary::Select(FHGMSIMDLibrary::CastIntToReal(Mask), sQ1, sQ2);
 	}
 
+	// Shift components one to the left and fill last component with first component of B.
+	// ( e.g. A = (0, 1, 2, 3), B = (4, 5, 6, 7) --> (1, 2, 3, 4) )
+	FORCEINLINE static FHGMSIMDReal ShiftComponentsLeft(const FHGMSIMDReal& A, const FHGMSIMDReal& B)
+	{
+		const FHGMSIMDReal Temp = VectorShuffle(A, B, 3, 3, 0, 0);
+		return VectorShuffle(A, Temp, 1, 2, 0, 2);
+	}
+
+	// Inverse of ShiftComponentsLeft(). Writes V back to components that were shifted out of A and B.
+	// A and B may refer to same register.
+	FORCEINLINE static void UnshiftComponentsLeft(const FHGMSIMDReal& V, FHGMSIMDReal& A, FHGMSIMDReal& B)
+	{
+		const FHGMSIMDReal TempA = VectorShuffle(A, V, 0, 0, 0, 0);
+		A = VectorShuffle(TempA, V, 0, 2, 1, 2);
+
+		const FHGMSIMDReal TempB = VectorShuffle(V, B, 3, 3, 1, 1);
+		B = VectorShuffle(TempB, B, 0, 2, 2, 3);
+	}
+
+	static FHGMSIMDVector3 ShiftComponentsLeft(const FHGMSIMDVector3& V, const FHGMSIMDVector3& W);
+
+	static void UnshiftComponentsLeft(const FHGMSIMDVector3& V, FHGMSIMDVector3& A, FHGMSIMDVector3& B);
+
 	// Returns true if any of the per-component masks obtained by FHGMSIMDReal::operator>() etc. are valid.
 	FORCEINLINE static bool IsAnyMaskSet(const FHGMSIMDReal& Mask)
 	{
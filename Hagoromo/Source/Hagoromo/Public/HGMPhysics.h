@@ -12,11 +12,16 @@ struct FHGMSIMDColliderContact;
 struct FHGMPhysicsLibrary
 {
 	static void ApplyForces(FComponentSpacePoseContext& Output, const FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions,
-						TConstArrayView<FHGMSIMDReal> WorldVelocityDampings, TConstArrayView<FHGMSIMDReal> WorldAngularVelocityDampings, TConstArrayView<FHGMSIMDReal> SimulationVelocityDampings, TConstArrayView<FHGMSIMDReal> SimulationAngularVelocityDampings, TConstArrayView<FHGMSIMDReal> MasterDampings,
-						TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks);
+						const FHGMSIMDBoneParameter& WorldVelocityDampings, const FHGMSIMDBoneParameter& WorldAngularVelocityDampings, const FHGMSIMDBoneParameter& SimulationVelocityDampings, const FHGMSIMDBoneParameter& SimulationAngularVelocityDampings, const FHGMSIMDBoneParameter& MasterDampings,
+						TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
-	static void VerletIntegrate(const FHGMPhysicsContext& PhysicsContext, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDVector3>& PrevPositions, TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDReal> MasterDampings, TConstArrayView<FHGMSIMDReal> FixedBlends, TConstArrayView<FHGMSIMDReal> DummyBoneMasks);
+	// ApplyForces(), VerletIntegrate() and FixedBlendConstraint() fused into single pass.
+	static void IntegrateForces(FComponentSpacePoseContext& Output, const FHGMPhysicsContext& PhysicsContext, TArrayView<FHGMSIMDVector3> Positions, TArrayView<FHGMSIMDVector3> PrevPositions, TConstArrayView<FHGMSIMDVector3> AnimPosePositions,
+							const FHGMSIMDBoneParameter& WorldVelocityDampings, const FHGMSIMDBoneParameter& WorldAngularVelocityDampings, const FHGMSIMDBoneParameter& SimulationVelocityDampings, const FHGMSIMDBoneParameter& SimulationAngularVelocityDampings, const FHGMSIMDBoneParameter& MasterDampings,
+							TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
+
+	static void VerletIntegrate(const FHGMPhysicsContext& PhysicsContext, TArray<FHGMSIMDVector3>& Positions, TArray<FHGMSIMDVector3>& PrevPositions, TConstArrayView<FHGMSIMDReal> Frictions, const FHGMSIMDBoneParameter& MasterDampings, TConstArrayView<FHGMSIMDParticleParameter> ParticleParameters);
 
 	static void ResetFriction(TArray<FHGMSIMDReal>& Frictions);
-	static void CalculateFriction(TConstArrayView<FHGMSIMDReal> Frictions, TConstArrayView<FHGMSIMDColliderContact> ColliderContacts, TArray<FHGMSIMDReal>& sOutFrictions);
+	static void CalculateFriction(const FHGMSIMDBoneParameter& Frictions, TConstArrayView<FHGMSIMDColliderContact> ColliderContacts, TArray<FHGMSIMDReal>& sOutFrictions);
 };
@@ -0,0 +1,68 @@
+// Hagoromo : Copyright (c) 2025 nozoxa_0131, MIT License
+
+#pragma once
+
+#include "HGMSolvers.h"
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "UObject/ObjectSaveContext.h"
+
+#include "HGMSolverData.generated.h"
+
+class USkeletalMesh;
+
+
+// Solver template built when asset is cooked and saved with cooked asset.
+// Anim node referencing this asset uses chain settings and physics settings of this asset instead of its own,
+// and skips building solver at runtime when reference skeleton of mesh matches.
+UCLASS(BlueprintType)
+class HAGOROMO_API UHagoromoSolverData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// UObject interface
+	virtual void Serialize(FArchive& Ar) override;
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#endif
+	// End of UObject interface
+
+	FORCEINLINE TSharedPtr<const FHGMSolverTemplate> GetSolverTemplate() const
+	{
+		return SolverTemplate;
+	}
+
+#if WITH_EDITOR
+	// Build solver template with all bones of SkeletalMesh as required bones.
+	bool BuildSolverTemplate();
+#endif
+
+	/**
+	* ソルバーを構築する対象のスケルタルメッシュです。
+	*
+	* Skeletal mesh that solver is built for.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Skeletal Mesh", DisplayPriority = "0"))
+	TObjectPtr<USkeletalMesh> SkeletalMesh = nullptr;
+
+	/**
+	* チェーンの設定です。参照しているアニメーションノードではノードの設定の代わりに使用されます。
+	*
+	* Chain settings. Used instead of settings of anim node that references this asset.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo Chain Settings", TitleProperty = "RootBone", DisplayPriority = "1"))
+	TArray<FHGMChainSetting> ChainSettings {};
+
+	/**
+	* 物理挙動のパラメータです。参照しているアニメーションノードではノードの設定の代わりに使用されます。
+	*
+	* Physics parameters. Used instead of settings of anim node that references this asset.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Hagoromo Settings", meta = (DisplayName = "Hagoromo General Settings", DisplayPriority = "2"))
+	FHGMPhysicsSettings PhysicsSettings {};
+
+private:
+	TSharedPtr<FHGMSolverTemplate> SolverTemplate {};
+};
@@ -9,11 +9,14 @@
 #include "CoreMinimal.h"
 #include "Curves/CurveFloat.h"
 #include "BonePose.h"
+#include "Misc/MemStack.h"
+#include "Templates/IntegerSequence.h"
 
 #include "HGMSolvers.generated.h"
 
 struct FHGMBodyCollider;
 struct FHGMSIMDStructure;
+struct FHGMReferenceSkeletonCache;
 
 struct FComponentSpacePoseContext;
 
@@ -319,6 +322,42 @@ struct FHGMSIMDRelativeLimitAngle
 };
 
 
+USTRUCT()
+struct FHGMTetherConstraintSettings
+{
+	GENERATED_BODY()
+
+	/**
+	* 根元のボーンとの距離制約の剛性を 0.0 ～ 1.0 で指定します。
+	*
+	* Specify stiffness of distance constraint to root bone from 0.0 to 1.0.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 0.0, ClampMin = 0.0, UIMax = 1.0, ClampMax = 1.0))
+	double Stiffness = 1.0;
+
+	/**
+	* ボーン単位で Stiffness を調整するためのカーブです。
+	* 横軸はボーンの長さの比率 0.0 ～ 1.0 に対応しています。
+	* 縦軸は Stiffness に乗算する値です。
+	*
+	* Curves for adjusting Stiffness on a per-bone basis.
+	* Horizontal axis corresponds to bone length ratio 0.0 to 1.0.
+	* Vertical axis is value to be multiplied by Stiffness.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "")
+	FRuntimeFloatCurve MultiplierCurve {};
+};
+
+struct FHGMSIMDTether
+{
+	int32 RootBonePackedIndex = -1;
+	int32 BonePackedIndex = -1;
+	FHGMSIMDReal sLength = HGMSIMDConstants::OneReal;
+	FHGMSIMDReal sCompliance = HGMSIMDConstants::ZeroReal;
+	FHGMSIMDReal sLambda = HGMSIMDConstants::ZeroReal;
+};
+
+
 USTRUCT()
 struct FHGMMassSettings
 {
@@ -561,6 +600,17 @@ struct FHGMChainSetting
 };
 
 
+UENUM()
+enum class EHGMVerticalStructureSolveMode : uint8
+{
+	// Solve each constraint of chain in turn and converge by iterations.
+	Iterative,
+
+	// Solve all constraints of chain at once as tridiagonal system.
+	Direct,
+};
+
+
 USTRUCT()
 struct FHGMPhysicsSettings
 {
@@ -602,6 +652,18 @@ struct FHGMPhysicsSettings
 	UPROPERTY(EditDefaultsOnly, Category = "")
 	bool bUseRigidVerticalStructureConstraint = false;
 
+	/**
+	* 縦方向の距離制約の解き方です。
+	*   - [Iterative] 制約を1つずつ解き、反復によって収束させます。
+	*   - [Direct] チェーン全体の制約を三重対角行列として一度に解きます。少ない反復回数でも伸びにくくなるため、髪や長いリボンに適しています。
+	*
+	* How to solve vertical distance constraints.
+	*   - [Iterative] Solve constraints one by one and converge by iterations.
+	*   - [Direct] Solve constraints of entire chain at once as tridiagonal system. Chain is less stretched even with few iterations, suitable for hair and long ribbons.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (EditCondition = "!bUseRigidVerticalStructureConstraint", EditConditionHides))
+	EHGMVerticalStructureSolveMode VerticalStructureSolveMode = EHGMVerticalStructureSolveMode::Iterative;
+
 	/**
 	* チェーンの横方向の距離制約を有効にします。
 	* スカートやマントなどに利用すると布が横に伸びすぎることがなくなり、見映えが良くなります。
@@ -676,6 +738,21 @@ struct FHGMPhysicsSettings
 	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 0.0, ClampMin = 0.0, UIMax = 1.0, ClampMax = 1.0, EditCondition = "bUseShearConstraint", EditConditionHides))
 	double ShearStiffness = 0.004;
 
+	/**
+	* 各ボーンとチェーンの根元のボーンとの間に最大距離の制約を追加します。( Long Range Attachment )
+	* 長いチェーンでも少ない反復回数で伸びにくくなります。
+	* 最大距離は初期化時のポーズでのチェーンに沿った長さです。根元のボーンが固定されていない場合は機能しません。
+	*
+	* Add maximum distance constraints between each bone and root bone of chain. ( Long Range Attachment )
+	* Long chains are less stretched even with few iterations.
+	* Maximum distance is length along chain in pose at initialization. Does not work if root bone is not fixed.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "")
+	bool bUseTetherConstraint = false;
+
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (DisplayName = "Tether Constraint", EditCondition = "bUseTetherConstraint", EditConditionHides))
+	FHGMTetherConstraintSettings TetherConstraintSettings {};
+
 	/**
 	* アニメーションポーズへの距離制約を有効にします。
 	* アニメーションポーズ( 元の形状 )を維持しながら物理効果を乗せたい場合に利用してください。
@@ -804,6 +881,28 @@ struct FHGMPhysicsSettings
 	UPROPERTY(EditDefaultsOnly, Category = "", meta = (EditCondition = "bUseHorizontalStructuralConstraint && bUseEdgeCollider", EditConditionHides))
 	bool bUseHorizontalEdgeCollider = false;
 
+	/**
+	* 衝突判定をサブステップの最初の反復でのみ行い、以降の反復では検出した接触を再利用します。
+	* SpeculativeContactMargin だけ広げて判定するため、近くにあるコライダも接触として保持されます。
+	* いずれかのボーンが判定時から SpeculativeContactMargin 以上移動した場合は再判定します。
+	*
+	* Collision detection is done only at first iteration of substep, and detected contacts are reused in following iterations.
+	* Detection is expanded by SpeculativeContactMargin, so nearby colliders are also kept as contacts.
+	* Collision is detected again if any bone moved SpeculativeContactMargin or more since detection.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (EditCondition = "!bUseSmallSteps", EditConditionHides))
+	bool bUseSpeculativeContact = false;
+
+	/**
+	* 接触を保持する距離です。(cm)
+	* 大きいほど再判定が減りますが、接触の数が増えます。
+	*
+	* Distance within which contacts are kept. (cm)
+	* Larger value reduces re-detection, but increases number of contacts.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 0.0, ClampMin = 0.0, EditCondition = "bUseSpeculativeContact && !bUseSmallSteps", EditConditionHides))
+	double SpeculativeContactMargin = 1.0;
+
 	/**
 	* 摩擦を 0.0 ～ 1.0 で指定します。
 	* 摩擦はシミュレーション対象のボーンがキャラクター等のボディコライダに衝突したときに発生します。
@@ -963,6 +1062,124 @@ struct FHGMPhysicsSettings
 	*/
 	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 1.0, ClampMin = 1.0))
 	int32 SolverIterations = 8;
+
+	/**
+	* 反復処理の代わりにサブステップでシミュレーションを行います。( Small Steps )
+	* 1回の積分に対して SolverIterations 回の反復を行う代わりに、経過時間を SolverIterations 個に分割してそれぞれ1回ずつ積分と制約の解決を行います。
+	* 同じ計算量でもより硬い布を表現しやすくなるため、SolverIterations を減らせる可能性があります。
+	*
+	* Simulate with substeps instead of iterations. ( Small Steps )
+	* Instead of SolverIterations iterations per integration, elapsed time is divided into SolverIterations substeps, each with one integration and one constraint solve.
+	* Stiffer cloth is easier to achieve with same computational cost, so SolverIterations may be reduced.
+	* See https://mmacklin.com/smallsteps.pdf .
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "")
+	bool bUseSmallSteps = false;
+
+	/**
+	* 制約の誤差が ResidualTolerance を下回った時点で反復を打ち切ります。
+	* 布が安定している間は反復回数が減るため、処理負荷が軽減されます。
+	* SolverIterations は反復回数の上限として扱われます。
+	*
+	* Stop iterations once constraint error falls below ResidualTolerance.
+	* Number of iterations decreases while cloth is settled, reducing processing load.
+	* SolverIterations is treated as upper limit of iterations.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (EditCondition = "!bUseSmallSteps", EditConditionHides))
+	bool bUseEarlyTermination = false;
+
+	/**
+	* 反復を打ち切る制約の誤差の閾値です。(cm)
+	* 全ての構造、ベンド、シアー制約の伸びの最大値がこの値を下回ると反復を終了します。
+	*
+	* Threshold of constraint error to stop iterations. (cm)
+	* Iterations end when maximum stretch of all structural, bend and shear constraints falls below this value.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 0.0, ClampMin = 0.0, EditCondition = "bUseEarlyTermination && !bUseSmallSteps", EditConditionHides))
+	double ResidualTolerance = 0.01;
+
+	/**
+	* 誤差に関わらず必ず実行する反復回数です。
+	*
+	* Number of iterations always executed regardless of error.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 1, ClampMin = 1, EditCondition = "bUseEarlyTermination && !bUseSmallSteps", EditConditionHides))
+	int32 MinSolverIterations = 2;
+
+	/**
+	* XPBD のラグランジュ乗数を前回のステップから引き継ぎます。( Warm Start )
+	* 静止に近い布では少ない反復回数で同程度の誤差に収束するため、SolverIterations を減らせる可能性があります。
+	*
+	* Carry over XPBD Lagrange multipliers from previous step. ( Warm Start )
+	* Nearly static cloth converges to same error with fewer iterations, so SolverIterations may be reduced.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "")
+	bool bUseWarmStart = false;
+
+	/**
+	* 引き継ぐラグランジュ乗数に掛ける係数です。
+	* 値を下げるほど安定しますが、Warm Start の効果は弱くなります。
+	*
+	* Factor multiplied to carried over Lagrange multipliers.
+	* Lower value, more stable, but effect of Warm Start becomes weaker.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 0.0, UIMax = 1.0, ClampMin = 0.0, ClampMax = 1.0, EditCondition = "bUseWarmStart", EditConditionHides))
+	double WarmStartRelaxation = 0.8;
+
+	/**
+	* チェビシェフ法で反復処理の収束を加速します。
+	* 長いチェーンが伸びてしまう場合でも、少ない SolverIterations で改善できる可能性があります。
+	* 反復が発散し始めた場合は自動的に通常の反復に戻ります。
+	*
+	* Accelerate convergence of iterations with Chebyshev method.
+	* Even if long chains are stretched, it may improve with fewer SolverIterations.
+	* Automatically falls back to normal iterations if iterations start to diverge.
+	* See https://doi.org/10.1145/2816795.2818063 .
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (EditCondition = "!bUseSmallSteps", EditConditionHides))
+	bool bUseChebyshevAcceleration = false;
+
+	/**
+	* チェビシェフ法で使用するスペクトル半径の推定値です。
+	* 0 の場合は最初の反復の収束率から自動的に推定します。
+	*
+	* Estimated spectral radius used by Chebyshev method.
+	* If 0, it is estimated automatically from convergence rate of first iterations.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 0.0, UIMax = 0.95, ClampMin = 0.0, ClampMax = 0.95, EditCondition = "bUseChebyshevAcceleration && !bUseSmallSteps", EditConditionHides))
+	double ChebyshevSpectralRadius = 0.0;
+
+	/**
+	* 固定タイムステップでシミュレーションを行います。
+	* フレームの経過時間を蓄積し、FixedTimeStepRate の間隔でサブステップを実行します。
+	* フレームレートによって剛性や処理負荷が変化しなくなります。
+	* 出力されるポーズは直近の2つのサブステップの結果を補間したものになります。
+	*
+	* Simulate with fixed time step.
+	* Elapsed frame time is accumulated and substeps are executed at intervals of FixedTimeStepRate.
+	* Stiffness and processing load no longer change with frame rate.
+	* Output pose is interpolated from results of last two substeps.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "")
+	bool bUseFixedTimeStep = false;
+
+	/**
+	* 1秒あたりのサブステップの回数です。
+	*
+	* Number of substeps per second.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 1.0, ClampMin = 1.0, EditCondition = "bUseFixedTimeStep", EditConditionHides))
+	double FixedTimeStepRate = 60.0;
+
+	/**
+	* 1フレームで実行するサブステップの最大回数です。
+	* ヒッチ等で上限を超えた分の時間は破棄されます。
+	*
+	* Maximum number of substeps executed in one frame.
+	* Time exceeding the limit due to hitches etc. is discarded.
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "", meta = (UIMin = 1, ClampMin = 1, EditCondition = "bUseFixedTimeStep", EditConditionHides))
+	int32 MaxSubsteps = 4;
 };
 
 
@@ -980,16 +1197,143 @@ struct FHGMPhysicsContext
 	FHGMSIMDReal sPrevDeltaTime = FHGMSIMDLibrary::LoadConstant(0.016);
 	FHGMSIMDReal sDeltaTimeExponent = HGMSIMDConstants::OneReal;
 
+	// Elapsed time not yet consumed by fixed time step.
+	FHGMReal TimeAccumulator = 0.0;
+
+	// Forces caused by movement of actor and SimulationRootBone are displacement per frame.
+	// When frame is split into substeps, they are applied only once.
+	FHGMSIMDReal sInertiaScale = HGMSIMDConstants::OneReal;
+	FHGMSIMDReal sGravityScale = HGMSIMDConstants::OneReal;
+
+	// Master damping and friction are fractions of velocity removed per step.
+	// Small Steps divides step into N steps, so retained velocity is raised to 1 / N in each of them so that damping does not compound.
+	// Retained velocities ( 1 - Damping ) ^ ( 1 / N ) are computed once per step and read by all small steps.
+	FHGMSIMDBoneParameter SmallStepMasterDampingRetentions {};
+	FHGMSIMDBoneParameter SmallStepFrictionRetentions {};
+
+	// Largest constraint error of current iteration. Used for residual-driven early termination.
+	FHGMSIMDReal sMaxConstraintError = HGMSIMDConstants::ZeroReal;
+
 	FHGMReal Alpha = 1.0;
 
+	// Ramped up from zero after deferred initialization so that physics does not pop in.
+	FHGMReal FadeInAlpha = 1.0;
+
 	bool bIsFirstUpdate = true;
 };
 
 
+// Features branched in constraint iteration.
+// Constraint iteration is compiled for each combination, and matching one is selected at initialization.
+enum class EHGMSolverFeature : uint32
+{
+	None = 0,
+	EdgeCollider = 1 << 0,
+	HorizontalEdgeCollider = 1 << 1,
+	TetherConstraint = 1 << 2,
+	HorizontalStructuralConstraint = 1 << 3,
+	VerticalBendConstraint = 1 << 4,
+	HorizontalBendConstraint = 1 << 5,
+	ShearConstraint = 1 << 6,
+	RigidVerticalStructureConstraint = 1 << 7,
+	DirectVerticalStructureConstraint = 1 << 8,
+
+	CombinationNum = 1 << 9,
+};
+ENUM_CLASS_FLAGS(EHGMSolverFeature);
+
+
+// Bones and reference positions of each chain.
+// Only gathering them reads reference skeleton of mesh, so template can be built from them without keeping mesh alive.
+struct FHGMGatheredChains
+{
+	TArray<TArray<FBoneReference>> Bones {};
+	TArray<TArray<FHGMVector3>> Positions {};
+};
+
+
+// Data of solver that is determined only by skeleton, chain settings and physics settings.
+// It is immutable after initialization and shared by all solver instances that have same key, so that
+// topology, rest lengths and per-bone parameters are built and kept in memory once.
+struct FHGMSolverTemplate
+{
+public:
+	// Hash of mesh, its reference skeleton and settings that template is built from. Template is shared by all LODs of mesh.
+	// Only settings read by Initialize() are hashed.
+	static uint64 MakeKey(const FBoneContainer& RequiredBones, const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings);
+
+	// Returns CookedTemplate when its key matches, cached template when one with same key is alive, otherwise builds new one.
+	static TSharedPtr<const FHGMSolverTemplate> FindOrCreate(const FBoneContainer& RequiredBones, const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings, const TSharedPtr<const FHGMSolverTemplate>& CookedTemplate = nullptr);
+
+	// Key, reference skeleton cache and chains are resolved by caller, so that this can be called from background task without touching UObject.
+	static TSharedPtr<const FHGMSolverTemplate> FindOrCreate(uint64 Key, const FHGMGatheredChains& GatheredChains, const TSharedPtr<const FHGMReferenceSkeletonCache>& RefSkeletonCache,
+															const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings, const TSharedPtr<const FHGMSolverTemplate>& CookedTemplate = nullptr);
+
+	// Reads reference skeleton of RequiredBones.
+	// Note: Caller must keep asset of RequiredBones from being garbage collected until this returns.
+	static bool GatherChains(const FBoneContainer& RequiredBones, const FHGMReferenceSkeletonCache& RefSkeletonCache, const TArray<FHGMChainSetting>& ChainSettings, FHGMGatheredChains& OutGatheredChains);
+
+	bool Initialize(const FHGMGatheredChains& GatheredChains, const TSharedPtr<const FHGMReferenceSkeletonCache>& RefSkeletonCache, const TArray<FHGMChainSetting>& ChainSettings, const FHGMPhysicsSettings& PhysicsSettings);
+
+	// Every field is written explicitly and registers are unpacked to scalars, so data is shared by builds of any precision and byte order.
+	void Serialize(FArchive& Ar);
+
+	uint64 Key = 0;
+
+	// Hash of reference skeleton that template is built from. ( See FHGMAnimationLibrary::HashReferenceSkeleton() )
+	uint64 RefSkeletonHash = 0;
+
+	FHGMSimulationPlane SimulationPlane {};
+
+	// Note: Index is not packed for SIMD.
+	TArray<FBoneReference> Bones {};
+
+	// Note: Index is packed for SIMD.
+	TArray<FHGMSIMDVector3> ReferencePositions {};
+
+	// Inverse mass, fixed blend, dummy bone mask and movable weight in one block per packed bone.
+	// Every hot kernel reads them only from here.
+	TArray<FHGMSIMDParticleParameter> ParticleParameters {};
+
+	FHGMSIMDBoneParameter Frictions {};
+	FHGMSIMDBoneParameter WorldVelocityDampings {};
+	FHGMSIMDBoneParameter WorldAngularVelocityDampings {};
+	FHGMSIMDBoneParameter SimulationVelocityDampings {};
+	FHGMSIMDBoneParameter SimulationAngularVelocityDampings {};
+	FHGMSIMDBoneParameter MasterDampings {};
+	FHGMSIMDBoneParameter BoneSphereColliderRadiuses {};
+
+	// Horizontal-major layout used by horizontal processing.
+	// Static parameters are transposed once at initialization.
+	FHGMSimulationPlane HorizontalSimulationPlane {};
+	TArray<FHGMSIMDParticleParameter> HorizontalParticleParameters {};
+
+	// Constraints at rest. Solver copies them because lambdas are accumulated per instance.
+	TArray<FHGMSIMDStructure> VerticalStructures {};
+	TArray<FHGMSIMDStructure> HorizontalStructures {};
+	TArray<FHGMSIMDStructure> VerticalBendStructures {};
+	TArray<FHGMSIMDStructure> HorizontalBendStructures {};
+	TArray<FHGMSIMDShearStructure> ShearStructures {};
+	TArray<FHGMSIMDTether> Tethers {};
+	TArray<FHGMSIMDRelativeLimitAngle> RelativeLimitAngles {};
+	TArray<FHGMSIMDAnimPoseConstraintMovableRadius> AnimPoseConstraintMovableRadiuses {};
+	TArray<FHGMSIMDAnimPoseConstraintLimitAngle> AnimPoseConstraintLimitAngles {};
+	TArray<FHGMSIMDInt> AnimPosePlanarConstraintAxes {};
+};
+
+
 struct FHGMDynamicBoneSolver
 {
 public:
-	bool Initialize(const FBoneContainer& RequiredBones, const TArray<FHGMChainSetting>& ChainSettings, FHGMPhysicsSettings& PhysicsSettings, FHGMPhysicsContext& PhysicsContext);
+	// CookedTemplate is prebuilt data of UHagoromoSolverData. It is used instead of building when it matches settings.
+	bool Initialize(const FBoneContainer& RequiredBones, const TArray<FHGMChainSetting>& ChainSettings, FHGMPhysicsSettings& PhysicsSettings, FHGMPhysicsContext& PhysicsContext, const TSharedPtr<const FHGMSolverTemplate>& CookedTemplate = nullptr);
+
+	// Per-instance part of Initialize() with template prepared in advance, e.g. on background task.
+	bool InitializeWithTemplate(const FBoneContainer& RequiredBones, const TSharedPtr<const FHGMSolverTemplate>& SolverTemplate, FHGMPhysicsSettings& PhysicsSettings, FHGMPhysicsContext& PhysicsContext);
+
+	// Re-resolve compact pose indices when required bones change by LOD. Positions and velocities are kept.
+	// Bones removed by LOD are simulated as dummy bones until they are required again.
+	void UpdateRequiredBones(const FBoneContainer& RequiredBones, FHGMPhysicsContext& PhysicsContext);
 
 	FORCEINLINE bool HasInitialized() const
 	{
@@ -998,32 +1342,45 @@ public:
 
 	void PreSimulate(FComponentSpacePoseContext& Output, const FHGMPhysicsSettings& PhysicsSettings, FHGMPhysicsContext& PhysicsContext, int32 AnimationCurveNumber);
 
-	void Simulate(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, const FHGMBodyCollider& PrevBodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders);
+	void Simulate(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders);
 
 	void OutputSimulateResult(FHGMPhysicsContext& PhysicsContext, FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms);
 
-	FHGMSimulationPlane SimulationPlane {};
+	// Particle parameters of this instance. Those of template unless LOD removes bones.
+	FORCEINLINE TConstArrayView<FHGMSIMDParticleParameter> GetParticleParameters() const
+	{
+		return LODParticleParameters.IsEmpty() ? TConstArrayView<FHGMSIMDParticleParameter>(Template->ParticleParameters) : TConstArrayView<FHGMSIMDParticleParameter>(LODParticleParameters);
+	}
 
-	// Note: Index is not packed for SIMD.
-	TArray<FBoneReference> Bones {};
+	FORCEINLINE TConstArrayView<FHGMSIMDParticleParameter> GetHorizontalParticleParameters() const
+	{
+		return LODHorizontalParticleParameters.IsEmpty() ? TConstArrayView<FHGMSIMDParticleParameter>(Template->HorizontalParticleParameters) : TConstArrayView<FHGMSIMDParticleParameter>(LODHorizontalParticleParameters);
+	}
+
+	// Shared data that does not change per instance.
+	TSharedPtr<const FHGMSolverTemplate> Template {};
+
+	// Compact pose index of each bone of template for current required bones.
+	// Note: Index is unpacked. Invalid for dummy bones and bones removed by LOD, which are not read from and written to pose.
+	TArray<FCompactPoseBoneIndex> CompactPoseBoneIndexes {};
+
+	// Copy of particle parameters of template with bones removed by LOD turned into dummy bones.
+	// Empty while all bones are required.
+	TArray<FHGMSIMDParticleParameter> LODParticleParameters {};
+	TArray<FHGMSIMDParticleParameter> LODHorizontalParticleParameters {};
 
 	// Note: Index is packed for SIMD.
 	TArray<FHGMSIMDVector3> Positions {};
 	TArray<FHGMSIMDVector3> PrevPositions {};
-	TArray<FHGMSIMDVector3> ReferencePositions {};
 	TArray<FHGMSIMDVector3> AnimPosePositions {};
-	TArray<FHGMSIMDReal> BoneLengthRates {};
-	TArray<FHGMSIMDReal> DummyBoneMasks {};
-	TArray<FHGMSIMDReal> FixedBlends {};
-	TArray<FHGMSIMDReal> Frictions {};
+	TArray<FHGMSIMDVector3> SubstepStartPositions {};
+	TArray<FHGMSIMDVector3> InterpolatedPositions {};
+	TArray<FHGMSIMDVector3> ChebyshevPrevIteratedPositions {};
+	TArray<FHGMSIMDVector3> ChebyshevCurrentIteratedPositions {};
 	TArray<FHGMSIMDReal> ActualFrictions {};
-	TArray<FHGMSIMDReal> WorldVelocityDampings {};
-	TArray<FHGMSIMDReal> WorldAngularVelocityDampings {};
-	TArray<FHGMSIMDReal> SimulationVelocityDampings {};
-	TArray<FHGMSIMDReal> SimulationAngularVelocityDampings {};
-	TArray<FHGMSIMDReal> MasterDampings {};
-	TArray<FHGMSIMDReal> BoneSphereColliderRadiuses {};
-	TArray<FHGMSIMDReal> InverseMasses {};
+
+	// Positions synced to horizontal-major layout of template.
+	TArray<FHGMSIMDVector3> HorizontalPositions {};
 
 	// Contact cache.
 	TArray<FHGMSIMDColliderContact> BodyColliderContactCache {};
@@ -1031,18 +1388,44 @@ public:
 	TArray<FHGMSIMDColliderContact> HorizontalContactCache {};
 	TArray<FHGMSIMDColliderContact> PlaneColliderContactCache {};
 
-	// Constraints.
+	// Positions at last collision detection, used to detect again once any bone moved by speculative contact margin.
+	TArray<FHGMSIMDVector3> ContactDetectionPositions {};
+
+	// Constraints copied from template. They hold lambdas of this instance.
 	TArray<FHGMSIMDStructure> VerticalStructures {};
 	TArray<FHGMSIMDStructure> HorizontalStructures {};
 	TArray<FHGMSIMDStructure> VerticalBendStructures {};
 	TArray<FHGMSIMDStructure> HorizontalBendStructures {};
 	TArray<FHGMSIMDShearStructure> ShearStructures {};
-	TArray<FHGMSIMDRelativeLimitAngle> RelativeLimitAngles {};
-	TArray<FHGMSIMDAnimPoseConstraintMovableRadius> AnimPoseConstraintMovableRadiuses {};
-	TArray<FHGMSIMDAnimPoseConstraintLimitAngle> AnimPoseConstraintLimitAngles {};
-	TArray<FHGMSIMDInt> AnimPosePlanarConstraintAxes {};
+	TArray<FHGMSIMDTether> Tethers {};
 
 private:
+	using FSolveConstraintIterationFunction = FHGMReal (FHGMDynamicBoneSolver::*)(FComponentSpacePoseContext&, FHGMPhysicsContext&, const FHGMBodyCollider&, TConstArrayView<FHGMSIMDPlaneCollider>, const FHGMSIMDReal&, const FHGMSIMDReal&, bool, bool, FHGMReal);
+
+	// Advance simulation by PhysicsContext.sDeltaTime.
+	void SimulateStep(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders);
+
+	// Integrate once and solve constraints IterationNum times.
+	void SimulateSubstep(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders, int32 IterationNum);
+
+	// Collision detection, constraints and contacts of one iteration.
+	// Features are resolved at compile time so that iteration does not branch on settings.
+	// When bUseChebyshevAcceleration, constraints are accelerated by ChebyshevOmega before contacts are solved and displacement of iteration is returned.
+	template<EHGMSolverFeature Features>
+	FHGMReal SolveConstraintIteration(FComponentSpacePoseContext& Output, FHGMPhysicsContext& PhysicsContext, const FHGMBodyCollider& BodyCollider, TConstArrayView<FHGMSIMDPlaneCollider> PlaneColliders,
+									const FHGMSIMDReal& sCollisionBlend, const FHGMSIMDReal& sColliderPenetrationDepth, bool bIsFirstIteration, bool bUseChebyshevAcceleration, FHGMReal ChebyshevOmega);
+
+	template<uint32... FeatureCombinations>
+	static FSolveConstraintIterationFunction SelectSolveConstraintIteration(EHGMSolverFeature Features, TIntegerSequence<uint32, FeatureCombinations...>);
+
+	EHGMSolverFeature SolverFeatures = EHGMSolverFeature::None;
+	FSolveConstraintIterationFunction SolveConstraintIterationFunction = nullptr;
+
+#if STATS
+	// Cycle stat named after selected feature combination.
+	TStatId SolverPipelineStatId {};
+#endif
+
 	bool bHasInitialized = false;
 };
 
@@ -1050,6 +1433,31 @@ private:
 // ---------------------------------------------------------------------------------------
 // SolverLibrary
 // ---------------------------------------------------------------------------------------
+// Scope of scratch memory on thread-local FMemStack.
+// Arrays using TMemStackAllocator inside scope are released at once when scope ends without touching global allocator,
+// and peak usage is reported to STAT_SolverScratchMemoryHighWaterMark.
+struct FHGMScopedScratchMemory
+{
+public:
+	FHGMScopedScratchMemory()
+		: Mark(FMemStack::Get())
+		, StartByteCount(FMemStack::Get().GetByteCount())
+	{
+	}
+
+	~FHGMScopedScratchMemory()
+	{
+		UpdateHighWaterMark(static_cast<int64>(FMemStack::Get().GetByteCount()) - StartByteCount);
+	}
+
+private:
+	static void UpdateHighWaterMark(int64 ByteCount);
+
+	FMemMark Mark;
+	int64 StartByteCount = 0;
+};
+
+
 struct FHGMSolverLibrary
 {
 	static void Transpose(FHGMSimulationPlane& SimulationPlane);
@@ -1057,7 +1465,19 @@ struct FHGMSolverLibrary
 	template<typename SIMDType, typename ComponentType>
 	static void Transpose(const FHGMSimulationPlane& SimulationPlane, TArray<SIMDType>& Values)
 	{
-		auto Gather = [](SIMDType& S0, SIMDType& S1, SIMDType& S2, SIMDType& S3, int32 Index) -> SIMDType
+		FHGMScopedScratchMemory ScratchMemory {};
+		const TArray<SIMDType, TMemStackAllocator<>> SourceValues(Values);
+		Transpose<SIMDType, ComponentType>(SimulationPlane, SourceValues, Values);
+	}
+
+	// Transpose into preallocated buffer without allocation.
+	// OutTransposedValues must have same number of elements as Values and must not alias Values.
+	template<typename SIMDType, typename ComponentType>
+	static void Transpose(const FHGMSimulationPlane& SimulationPlane, TConstArrayView<SIMDType> Values, TArrayView<SIMDType> OutTransposedValues)
+	{
+		check(Values.Num() == OutTransposedValues.Num());
+
+		auto Gather = [](const SIMDType& S0, const SIMDType& S1, const SIMDType& S2, const SIMDType& S3, int32 Index) -> SIMDType
 		{
 			TStaticArray<ComponentType, 4> Values {};
 			FHGMSIMDLibrary::Store(S0, Index, Values[0]);
@@ -1071,8 +1491,6 @@ struct FHGMSolverLibrary
 			return sResult;
 		};
 
-		TArray<SIMDType> TransposedValues {};
-		TransposedValues.SetNum(Values.Num());
 		for (int32 PackedX = 0; PackedX < SimulationPlane.PackedHorizontalBoneNum; ++PackedX)
 		{
 			for (int32 UnpackedYBase = 0; UnpackedYBase < SimulationPlane.UnpackedVerticalBoneNum; UnpackedYBase += 4)
@@ -1098,14 +1516,12 @@ struct FHGMSolverLibrary
 				const int32 TransposedVPackedIndex2 = TransposedVPackedIndexBase + (SimulationPlane.PackedVerticalBoneNum * (UnpackedY2 % 4)) + (UnpackedY2 / 4);
 				const int32 TransposedVPackedIndex3 = TransposedVPackedIndexBase + (SimulationPlane.PackedVerticalBoneNum * (UnpackedY3 % 4)) + (UnpackedY3 / 4);
 
-				TransposedValues[TransposedVPackedIndex0] = sValue0;
-				TransposedValues[TransposedVPackedIndex1] = sValue1;
-				TransposedValues[TransposedVPackedIndex2] = sValue2;
-				TransposedValues[TransposedVPackedIndex3] = sValue3;
+				OutTransposedValues[TransposedVPackedIndex0] = sValue0;
+				OutTransposedValues[TransposedVPackedIndex1] = sValue1;
+				OutTransposedValues[TransposedVPackedIndex2] = sValue2;
+				OutTransposedValues[TransposedVPackedIndex3] = sValue3;
 			}
 		}
-
-		Values = MoveTemp(TransposedValues);
 	}
 };
 
@@ -1163,6 +1579,6 @@ public:
 
 private:
 	FHGMSimulationPlane* SimulationPlane = nullptr;
-	TArray<TArray<FHGMSIMDReal>*> SIMDRealsArray {};
-	TArray<TArray<FHGMSIMDVector3>*> SIMDVectorsArray {};
+	TArray<TArray<FHGMSIMDReal>*, TInlineAllocator<4>> SIMDRealsArray {};
+	TArray<TArray<FHGMSIMDVector3>*, TInlineAllocator<4>> SIMDVectorsArray {};
 };
@@ -32,6 +32,7 @@ UE_CLOG(Condition, LogHagoromoRuntime, Verbosity, TEXT("[%hs L%d] %s"), (__FUNCT
 
 DECLARE_STATS_GROUP(TEXT("Hagoromo"), STATGROUP_Hagoromo, STATCAT_Advanced);
 
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision Broadphase"), STAT_CollisionBroadphase, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision CalculateBodyColliderContacts"), STAT_CollisionCalculateBodyColliderContacts, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision CalculateBodyColliderContactsForVerticalEdge"), STAT_CollisionCalculateBodyColliderContactsForVerticalEdge, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision CalculateBodyColliderContactsForHorizontalEdge"), STAT_CollisionCalculateBodyColliderContactsForHorizontalEdge, STATGROUP_Hagoromo, HAGOROMO_API);
@@ -39,6 +40,7 @@ DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision CalculateBodyColliderContactsForHorizo
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Constraint VerticalStructuralConstraint"), STAT_ConstraintVerticalStructuralConstraint, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Constraint HorizontalStructuralConstraint"), STAT_ConstraintHorizontalStructuralConstraint, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Constraint ShearConstraint"), STAT_ConstraintShearConstraint, STATGROUP_Hagoromo, HAGOROMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Constraint TetherConstraint"), STAT_ConstraintTetherConstraint, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Constraint VerticalBendConstraint"), STAT_ConstraintVerticalBendConstraint, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Constraint HorizontalBendConstraint"), STAT_ConstraintHorizontalBendConstraint, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Constraint RelativeLimitAngleConstraint"), STAT_ConstraintRelativeLimitAngleConstraint, STATGROUP_Hagoromo, HAGOROMO_API);
@@ -48,12 +50,21 @@ DECLARE_CYCLE_STAT_EXTERN(TEXT("Constraint AnimPosePlanarConstraint"), STAT_Cons
 
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Physics ApplyForces"), STAT_PhysicsApplyForces, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Physics VerletIntegrate"), STAT_PhysicsVerletIntegrate, STATGROUP_Hagoromo, HAGOROMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Physics IntegrateForces"), STAT_PhysicsIntegrateForces, STATGROUP_Hagoromo, HAGOROMO_API);
 
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Solver Initialize"), STAT_SolverInitialize, STATGROUP_Hagoromo, HAGOROMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solver Update Required Bones"), STAT_SolverUpdateRequiredBones, STATGROUP_Hagoromo, HAGOROMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solver Template Initialize"), STAT_SolverTemplateInitialize, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Solver PreSimulate"), STAT_SolverPreSimulate, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Solver Simulate"), STAT_SolverSimulate, STATGROUP_Hagoromo, HAGOROMO_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Solver OutputSimulateResult"), STAT_SolverOutputSimulateResult, STATGROUP_Hagoromo, HAGOROMO_API);
 
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Solver Substeps"), STAT_SolverSubsteps, STATGROUP_Hagoromo, HAGOROMO_API);
+// Average number of executed iterations is Solver Iterations / Solver Iteration Loops.
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Solver Iterations"), STAT_SolverIterations, STATGROUP_Hagoromo, HAGOROMO_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Solver Iteration Loops"), STAT_SolverIterationLoops, STATGROUP_Hagoromo, HAGOROMO_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Solver Scratch Memory High Water Mark"), STAT_SolverScratchMemoryHighWaterMark, STATGROUP_Hagoromo, HAGOROMO_API);
+
 
 // ---------------------------------------------------------------------------------------
 // Module
@@ -65,4 +76,7 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	FDelegateHandle PostGarbageCollectHandle {};
 };
@@ -26,6 +26,7 @@ namespace HagoromoEditorInternal
 		Dist->PhysicsSettings = Src->PhysicsSettings;
 		Dist->PhysicsAssetForBodyCollider = Src->PhysicsAssetForBodyCollider;
 		Dist->AdditionalColliderSettings = Src->AdditionalColliderSettings;
+		Dist->SolverData = Src->SolverData;
 	}
 }
 